@@ -0,0 +1,294 @@
+#include "benchmark.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTextStream>
+
+#include "projectsearch.h"
+#include "pty/ptydisplay.h"
+#include "widgets/outputview.h"
+#include "widgets/reftreemodel.h"
+
+namespace benchmark {
+
+    static QTextStream &out()
+    {
+        static QTextStream stream(stdout);
+        return stream;
+    }
+
+    // Shaped like an AOSP checkout, same projects on every run
+    static ManifestPtr syntheticManifest(int projectCount)
+    {
+        static const char *const tops[] = {"device", "external", "frameworks", "hardware",
+            "packages", "platform", "prebuilts", "system", "tools", "vendor"};
+        static const char *const words[] = {"audio", "base", "bluetooth", "camera", "core",
+            "display", "graphics", "input", "media", "native", "net", "power", "sensors", "storage",
+            "telephony", "test", "ui", "usb", "wifi", "libs", "apps", "common", "services", "hal"};
+        const int topCount = sizeof(tops) / sizeof(tops[0]);
+        const int wordCount = sizeof(words) / sizeof(words[0]);
+
+        QRandomGenerator random(41);
+        auto manifest = QSharedPointer<Manifest>::create();
+        QSet<QString> paths;
+        while (paths.size() < projectCount) {
+            QString path = tops[random.bounded(topCount)];
+            const int depth = 1 + random.bounded(3);
+            for (int i = 0; i < depth; ++i) {
+                path += '/';
+                path += words[random.bounded(wordCount)];
+                if (random.bounded(3) == 0) {
+                    path += random.bounded(2) ? '-' : '_';
+                    path += words[random.bounded(wordCount)];
+                }
+            }
+            paths.insert(path);
+        }
+        QStringList sorted = paths.values();
+        sorted.sort();
+        for (const QString &path : std::as_const(sorted)) {
+            const QString name = "platform/" + path;
+            manifest->projectIndex.insert(path, manifest->projectList.size());
+            manifest->projectList.append(Project{name, path, "/aosp/" + path});
+        }
+        return manifest;
+    }
+
+    // What the project list did before it had an index
+    static int containsScan(const Manifest &manifest, const QString &query)
+    {
+        int count = 0;
+        for (const Project &project : manifest.projectList) {
+            if (project.name.contains(query, Qt::CaseInsensitive) ||
+                project.path.contains(query, Qt::CaseInsensitive)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    static void projectSearch()
+    {
+        const int projectCount = 5000;
+        const int rounds = 20;
+        const QStringList queries = {"frameworks/base", "fwbase", "hwaudio", "sys/core/libs",
+            "vendor/cam", "ptelephony"};
+        const ManifestPtr manifest = syntheticManifest(projectCount);
+        out() << "Project search, " << projectCount << " projects, typed a character at a time, "
+              << rounds << " rounds\n";
+
+        auto type = [&](const char *label, auto keystroke) {
+            QElapsedTimer timer;
+            qint64 worstNs = 0;
+            int keystrokes = 0;
+            int matches = 0;
+            timer.start();
+            for (int round = 0; round < rounds; ++round) {
+                for (const QString &query : queries) {
+                    for (int length = 1; length <= query.size(); ++length) {
+                        QElapsedTimer keyTimer;
+                        keyTimer.start();
+                        matches += keystroke(query.left(length));
+                        worstNs = qMax(worstNs, keyTimer.nsecsElapsed());
+                        ++keystrokes;
+                    }
+                }
+            }
+            out() << QString("  %1 %2 us per keystroke, worst %3 us, %4 matches\n")
+                         .arg(QString::fromLatin1(label), -24)
+                         .arg(timer.nsecsElapsed() / 1000.0 / keystrokes, 8, 'f', 1)
+                         .arg(worstNs / 1000.0, 8, 'f', 1)
+                         .arg(matches / rounds);
+            out().flush();
+        };
+
+        type("contains, unranked", [&](const QString &query) {
+            return containsScan(*manifest, query);
+        });
+        ProjectSearch narrowing(manifest);
+        type("fuzzy, narrowing", [&](const QString &query) {
+            return int(narrowing.search(query).size());
+        });
+        ProjectSearch full(manifest);
+        type("fuzzy, full scan", [&](const QString &query) {
+            return int(full.search(query, false).size());
+        });
+    }
+
+    // Release tags of a big project, e.g. android-14.0.0_r12 and release/2023.11/build-1042
+    static QStringList syntheticTags(int tagCount)
+    {
+        static const char *const prefixes[] = {"android-", "release/", "kernel/", "vendor/"};
+        QRandomGenerator random(43);
+        QSet<QString> tags;
+        while (tags.size() < tagCount) {
+            const int prefix = random.bounded(4);
+            QString tag = prefixes[prefix];
+            if (prefix == 0) {
+                tag += QString("%1.%2.0_r%3")
+                           .arg(random.bounded(8, 15))
+                           .arg(random.bounded(2))
+                           .arg(random.bounded(1, 80));
+            } else {
+                tag += QString("%1.%2/build-%3")
+                           .arg(random.bounded(2015, 2025))
+                           .arg(random.bounded(1, 13), 2, 10, QChar('0'))
+                           .arg(random.bounded(100000));
+            }
+            tags.insert(tag);
+        }
+        QStringList sorted = tags.values();
+        sorted.sort();
+        return sorted;
+    }
+
+    static void refTree()
+    {
+        const int tagCount = 60000;
+        const QStringList tags = syntheticTags(tagCount);
+        out() << "Ref tree, " << tagCount << " tags\n";
+
+        auto time = [&](const char *label, auto function) {
+            QElapsedTimer timer;
+            timer.start();
+            function();
+            out() << QString("  %1 %2 ms\n")
+                         .arg(QString::fromLatin1(label), -32)
+                         .arg(timer.nsecsElapsed() / 1000000.0, 8, 'f', 2);
+            out().flush();
+        };
+
+        RefTreeModel model;
+        time("first load", [&]() {
+            model.setRefs(RefTreeItem::Tag, tags);
+        });
+        time("refresh, unchanged", [&]() {
+            model.setRefs(RefTreeItem::Tag, tags);
+        });
+        QStringList changed = tags.mid(10);
+        for (int i = 0; i < 10; ++i) {
+            changed << QString("release/2026.%1/build-new").arg(i);
+        }
+        time("refresh, 10 added and 10 removed", [&]() {
+            model.setRefs(RefTreeItem::Tag, changed);
+        });
+        const QString query = "release/2023.11/build-4";
+        time("filter, typed a character at a time", [&]() {
+            for (int length = 1; length <= query.size(); ++length) {
+                model.setFilter(query.left(length));
+            }
+        });
+        time("filter, cleared", [&]() {
+            model.setFilter(QString());
+        });
+    }
+
+    // What the pty shows of `repo sync -j32`: progress meters redrawn after \r, the remote's
+    // erased with CSI K, fetch summaries, colored errors and the odd non-ASCII character
+    static QByteArray syntheticSyncLog(int projectCount)
+    {
+        static const char *const stages[] = {"remote: Enumerating objects",
+            "remote: Counting objects", "remote: Compressing objects", "Receiving objects",
+            "Resolving deltas"};
+        const ManifestPtr manifest = syntheticManifest(projectCount);
+        QRandomGenerator random(47);
+        QByteArray log;
+        int fetched = 0;
+        for (const Project &project : std::as_const(manifest->projectList)) {
+            const QByteArray name = project.name.toUtf8();
+            log += QString("\rFetching: %1% (%2/%3) %4\x1b[K")
+                       .arg(fetched * 100 / projectCount, 3)
+                       .arg(fetched)
+                       .arg(projectCount)
+                       .arg(project.name)
+                       .toUtf8();
+            ++fetched;
+            log += "\nFrom https://android.googlesource.com/" + name + "\n";
+            for (const char *stage : stages) {
+                const bool remote = qstrncmp(stage, "remote:", 7) == 0;
+                const int total = random.bounded(100, 200000);
+                for (int percent = 0; percent < 100; percent += random.bounded(1, 6)) {
+                    log += QString("%1: %2% (%3/%4)")
+                               .arg(stage)
+                               .arg(percent, 3)
+                               .arg(qint64(total) * percent / 100)
+                               .arg(total)
+                               .toUtf8();
+                    if (qstrcmp(stage, "Receiving objects") == 0) {
+                        log += QString(", %1 MiB | %2 MiB/s")
+                                   .arg(total * percent / 100 / 4096.0, 0, 'f', 2)
+                                   .arg(random.bounded(1, 40))
+                                   .toUtf8();
+                    }
+                    log += remote ? "\x1b[K\r" : "\r";
+                }
+                log += QString("%1: 100% (%2/%2), done.").arg(stage).arg(total).toUtf8();
+                log += remote ? "\x1b[K\n" : "\n";
+            }
+            for (int i = random.bounded(4); i > 0; --i) {
+                const QByteArray tag = "android-14.0.0_r" + QByteArray::number(random.bounded(80));
+                log += " * [new tag]             " + tag + " -> " + tag + "\n";
+            }
+            if (random.bounded(50) == 0) {
+                log += "\x1b[1;31merror:\x1b[m " + name + ": Übersetzung “fehlgeschlagen” ✗\n";
+            }
+        }
+        return log;
+    }
+
+    static void ptyDisplay()
+    {
+        const int projectCount = 800;
+        const QByteArray log = syntheticSyncLog(projectCount);
+        const double mib = log.size() / (1024.0 * 1024.0);
+        out() << "Pty display, " << QString::number(mib, 'f', 1) << " MiB of sync output of "
+              << projectCount << " projects\n";
+
+        // The pty hands over what it has, a few KiB under load and bytes at a time when not
+        for (const int blockSize : {4096, 64}) {
+            OutputView view;
+            PtyDisplay display(&view);
+            QElapsedTimer timer;
+            timer.start();
+            for (qsizetype pos = 0; pos < log.size(); pos += blockSize) {
+                const qsizetype len = qMin<qsizetype>(blockSize, log.size() - pos);
+                display.onReceiveBlock(log.constData() + pos, int(len));
+            }
+            const double ms = timer.nsecsElapsed() / 1000000.0;
+            out() << QString("  %1 %2 ms %3 MiB/s\n")
+                         .arg(QString("%1 byte blocks").arg(blockSize), -32)
+                         .arg(ms, 8, 'f', 2)
+                         .arg(mib * 1000 / ms, 8, 'f', 1);
+            out().flush();
+            QFile::remove(view.logFilePath());
+        }
+    }
+
+    int run(const QStringList &names)
+    {
+        const QList<std::pair<QString, void (*)()>> benchmarks = {
+            {"projectsearch", projectSearch},
+            {"reftree", refTree},
+            {"ptydisplay", ptyDisplay},
+        };
+        int ran = 0;
+        for (const auto &[name, function] : benchmarks) {
+            if (names.isEmpty() || names.contains(name)) {
+                function();
+                ++ran;
+            }
+        }
+        if (ran == 0) {
+            out() << "Unknown benchmark, one of:";
+            for (const auto &benchmark : benchmarks) {
+                out() << ' ' << benchmark.first;
+            }
+            out() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+}  // namespace benchmark
@@ -0,0 +1,12 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QStringList>
+
+// Timings of hot paths on synthetic data, run with `RepoMan --benchmark [name...]`
+namespace benchmark {
+    // Exit code for main
+    int run(const QStringList &names);
+}  // namespace benchmark
+
+#endif  // BENCHMARK_H
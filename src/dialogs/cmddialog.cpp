@@ -1,5 +1,8 @@
 #include "cmddialog.h"
 
+#include <QSettings>
+#include <QUrl>
+
 #include "pty/kshell.h"
 #include "ui_cmddialog.h"
 
@@ -12,8 +15,17 @@ CmdDialog::CmdDialog(
       m_autoClose(autoClose)
 {
     ui->setupUi(this);
+    // Lines kept in the view, the log file has them all
+    ui->outputView->setScrollback(QSettings().value("outputScrollbackLines", 20000).toInt());
+    ui->logLabel->hide();
+    connect(ui->outputView, &OutputView::logStarted, this, [this](const QString &path) {
+        const QString link = QString("<a href=\"%1\">%2</a>")
+                                 .arg(QUrl::fromLocalFile(path).toString(), path.toHtmlEscaped());
+        ui->logLabel->setText("Older output is dropped from the view, all of it is in " + link);
+        ui->logLabel->show();
+    });
     m_pty = new Konsole::Pty(this);
-    m_display = new PtyDisplay(ui->textEdit, this);
+    m_display = new PtyDisplay(ui->outputView, this);
     connect(m_pty, &Konsole::Pty::receivedData, this, &CmdDialog::onReceiveBlock);
     connect(m_pty, &Konsole::Pty::finished, this, &CmdDialog::onFinished);
     m_pty->setEnv("TERM", "vt100");
@@ -31,7 +43,7 @@ CmdDialog::~CmdDialog()
 void CmdDialog::processNextCmd()
 {
     const QString &cmd = m_cmdList.at(m_nextCmdIndex++);
-    ui->textEdit->appendPlainText(cmd + "\n\n");
+    ui->outputView->appendLine(cmd + "\n");
     const QStringList &args = KShell::splitArgs(cmd);
     m_pty->start(args[0], args, {}, 0, false);
     qDebug() << "CmdDialog:" << cmd;
@@ -50,25 +62,33 @@ int CmdDialog::execute(
     return dialog.exec();
 }
 
+void CmdDialog::addTopWidget(QWidget *widget)
+{
+    ui->verticalLayout->insertWidget(0, widget, 2);
+    resize(width(), height() + 350);
+}
+
 void CmdDialog::onReceiveBlock(const char *buf, int len)
 {
     m_display->onReceiveBlock(buf, len);
+    emit outputReceived(buf, len);
 }
 
 void CmdDialog::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qDebug() << "FINISHED:" << exitCode;
-    m_display->flushContent();
+    m_display->endLine();
     m_exitCode = exitCode;
+    emit commandFinished(exitCode);
 
     bool isLastCmd = m_nextCmdIndex > m_cmdList.size() - 1;
 
     if (exitCode != 0) {
-        ui->textEdit->appendPlainText(QString("FAILED(%1)").arg(exitCode));
+        ui->outputView->appendLine(QString("FAILED(%1)").arg(exitCode));
         if (!isLastCmd) {
-            ui->textEdit->appendPlainText("Remaining commands:");
+            ui->outputView->appendLine("Remaining commands:");
             for (int i = m_nextCmdIndex + 1; i < m_cmdList.size() - 1; ++i) {
-                ui->textEdit->appendPlainText(QString("=> %1").arg(m_cmdList.at(i)));
+                ui->outputView->appendLine(QString("=> %1").arg(m_cmdList.at(i)));
             }
         }
         return;
@@ -79,7 +99,7 @@ void CmdDialog::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
     } else if (m_autoClose) {
         done(exitCode);
     } else {
-        ui->textEdit->appendPlainText(QString("FINISHED(%1)").arg(exitCode));
+        ui->outputView->appendLine(QString("FINISHED(%1)").arg(exitCode));
     }
 }
 
@@ -23,6 +23,13 @@ public:
     static int execute(
         QWidget *parent, const QStringList &cmdList, const QString &cwd, bool autoClose = false);
 
+    // Shown above the output, e.g. a structured view of it
+    void addTopWidget(QWidget *widget);
+
+signals:
+    void outputReceived(const char *buf, int len);
+    void commandFinished(int exitCode);
+
 private:
     Ui::CmdDialog *ui;
     Konsole::Pty *m_pty;
@@ -1,19 +1,30 @@
 #include "deleterefdialog.h"
 
+#include <QPushButton>
+
 #include "dialogs/cmddialog.h"
 #include "ui_deletelocalbranchdialog.h"
 #include "ui_deletetagdialog.h"
 #include "ui_deletremotebranchdialog.h"
 
-DeleteLocalBranchDialog::DeleteLocalBranchDialog(
-    QWidget *parent, const QString &projectPath, const QString &branch)
+DeleteLocalBranchDialog::DeleteLocalBranchDialog(QWidget *parent, const QString &projectPath,
+    const RefSnapshot::Ref &branch, bool checkedOut)
     : QDialog(parent),
       ui(new Ui::DeleteLocalBranchDialog),
       m_projectPath(projectPath),
-      m_branch(branch)
+      m_branch(branch.name)
 {
     ui->setupUi(this);
-    ui->branchLabel->setText(branch);
+    QString text = branch.name + "  " + branch.oid.left(8);
+    if (!branch.upstream.isEmpty()) {
+        text += ", tracks " + branch.upstream;
+    }
+    // git refuses to delete it anyway
+    if (checkedOut) {
+        text += " (checked out)";
+        ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+    }
+    ui->branchLabel->setText(text);
 }
 
 DeleteLocalBranchDialog::~DeleteLocalBranchDialog()
@@ -30,14 +41,14 @@ void DeleteLocalBranchDialog::accept()
 }
 
 DeleteRemoteBranchDialog::DeleteRemoteBranchDialog(
-    QWidget *parent, const QString &projectPath, const QString &branch)
+    QWidget *parent, const QString &projectPath, const RefSnapshot::Ref &branch)
     : QDialog(parent),
       ui(new Ui::DeleteRemoteBranchDialog),
       m_projectPath(projectPath),
       m_branch(branch)
 {
     ui->setupUi(this);
-    ui->branchLabel->setText(branch);
+    ui->branchLabel->setText(branch.name + "  " + branch.oid.left(8));
 }
 
 DeleteRemoteBranchDialog::~DeleteRemoteBranchDialog()
@@ -47,16 +58,18 @@ DeleteRemoteBranchDialog::~DeleteRemoteBranchDialog()
 
 void DeleteRemoteBranchDialog::accept()
 {
-    QString cmd = QString("git push origin :%1").arg(m_branch);
+    // The remote the branch is on, by its name there
+    QString cmd = QString("git push %1 :%2").arg(m_branch.remote, m_branch.remoteBranch());
     int code = CmdDialog::execute(parentWidget(), cmd, m_projectPath, true);
     done(code == 0 ? QDialog::Accepted : QDialog::Rejected);
 }
 
-DeleteTagDialog::DeleteTagDialog(QWidget *parent, const QString &projectPath, const QString &tag)
-    : QDialog(parent), ui(new Ui::DeleteTagDialog), m_projectPath(projectPath), m_tag(tag)
+DeleteTagDialog::DeleteTagDialog(
+    QWidget *parent, const QString &projectPath, const RefSnapshot::Ref &tag)
+    : QDialog(parent), ui(new Ui::DeleteTagDialog), m_projectPath(projectPath), m_tag(tag.name)
 {
     ui->setupUi(this);
-    ui->tagLabel->setText(tag);
+    ui->tagLabel->setText(tag.name + "  " + tag.commit().left(8));
 }
 
 DeleteTagDialog::~DeleteTagDialog()
@@ -3,6 +3,8 @@
 
 #include <QDialog>
 
+#include "git/refsnapshot.h"
+
 namespace Ui {
     class DeleteLocalBranchDialog;
     class DeleteRemoteBranchDialog;
@@ -14,8 +16,8 @@ class DeleteLocalBranchDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit DeleteLocalBranchDialog(
-        QWidget *parent, const QString &projectPath, const QString &branch);
+    explicit DeleteLocalBranchDialog(QWidget *parent, const QString &projectPath,
+        const RefSnapshot::Ref &branch, bool checkedOut);
     ~DeleteLocalBranchDialog();
 
 public slots:
@@ -33,7 +35,7 @@ class DeleteRemoteBranchDialog : public QDialog
 
 public:
     explicit DeleteRemoteBranchDialog(
-        QWidget *parent, const QString &projectPath, const QString &branch);
+        QWidget *parent, const QString &projectPath, const RefSnapshot::Ref &branch);
     ~DeleteRemoteBranchDialog();
 
 public slots:
@@ -42,7 +44,7 @@ public slots:
 private:
     Ui::DeleteRemoteBranchDialog *ui;
     QString m_projectPath;
-    QString m_branch;
+    RefSnapshot::Ref m_branch;
 };
 
 class DeleteTagDialog : public QDialog
@@ -50,7 +52,8 @@ class DeleteTagDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit DeleteTagDialog(QWidget *parent, const QString &projectPath, const QString &tag);
+    explicit DeleteTagDialog(
+        QWidget *parent, const QString &projectPath, const RefSnapshot::Ref &tag);
     ~DeleteTagDialog();
 
 public slots:
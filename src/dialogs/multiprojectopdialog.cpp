@@ -0,0 +1,233 @@
+#include "multiprojectopdialog.h"
+
+#include <QMessageBox>
+#include <QThread>
+#include <functional>
+
+#include "ui_multiprojectopdialog.h"
+
+enum Operation
+{
+    Fetch,
+    Pull,
+    Checkout,
+    CreateBranch,
+    Clean,
+    Custom,
+};
+
+MultiProjectOpDialog::MultiProjectOpDialog(
+    QWidget *parent, const RepoContext &context, const QList<Project> &openedProjects)
+    : QDialog(parent),
+      ui(new Ui::MultiProjectOpDialog),
+      m_context(context),
+      m_scheduler(new ProjectOpScheduler(this))
+{
+    ui->setupUi(this);
+    ui->splitter->setSizes({300, 600});
+    ui->jobsSpin->setValue(QThread::idealThreadCount() * 2);
+    ui->taskTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    ui->taskTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    ui->taskTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+
+    QSet<QString> openedPaths;
+    for (const Project &project : openedProjects) {
+        openedPaths.insert(project.path);
+    }
+    const ManifestPtr manifest = m_context.manifest();
+    for (const Project &project : manifest->projectList) {
+        auto item = new QListWidgetItem(project.path, ui->projectList);
+        item->setData(Qt::UserRole, QVariant::fromValue(project));
+        item->setCheckState(openedPaths.contains(project.path) ? Qt::Checked : Qt::Unchecked);
+    }
+
+    connect(ui->filterEdit, &QLineEdit::textChanged, this, [this](const QString &text) {
+        for (int i = 0; i < ui->projectList->count(); ++i) {
+            QListWidgetItem *item = ui->projectList->item(i);
+            item->setHidden(!item->text().contains(text, Qt::CaseInsensitive));
+        }
+    });
+    // Only the projects passing the filter
+    auto setChecked = [this](const std::function<bool(const QString &)> &checked) {
+        for (int i = 0; i < ui->projectList->count(); ++i) {
+            QListWidgetItem *item = ui->projectList->item(i);
+            if (!item->isHidden()) {
+                item->setCheckState(checked(item->text()) ? Qt::Checked : Qt::Unchecked);
+            }
+        }
+    };
+    connect(ui->selectAllBtn, &QPushButton::clicked, this, [setChecked]() {
+        setChecked([](const QString &) {
+            return true;
+        });
+    });
+    connect(ui->selectNoneBtn, &QPushButton::clicked, this, [setChecked]() {
+        setChecked([](const QString &) {
+            return false;
+        });
+    });
+    connect(ui->selectOpenedBtn, &QPushButton::clicked, this, [setChecked, openedPaths]() {
+        setChecked([&openedPaths](const QString &path) {
+            return openedPaths.contains(path);
+        });
+    });
+
+    connect(ui->operationCombo, &QComboBox::currentIndexChanged, this,
+        &MultiProjectOpDialog::onOperationChanged);
+    connect(ui->jobsSpin, &QSpinBox::valueChanged, m_scheduler,
+        &ProjectOpScheduler::setConcurrency);
+    connect(ui->runBtn, &QPushButton::clicked, this, &MultiProjectOpDialog::onRun);
+    connect(ui->retryBtn, &QPushButton::clicked, this, [this]() {
+        m_scheduler->retryFailed();
+        updateButtons();
+    });
+    connect(ui->stopBtn, &QPushButton::clicked, m_scheduler, &ProjectOpScheduler::cancel);
+    connect(ui->closeBtn, &QPushButton::clicked, this, &MultiProjectOpDialog::reject);
+
+    connect(m_scheduler, &ProjectOpScheduler::taskChanged, this,
+        &MultiProjectOpDialog::onTaskChanged);
+    connect(m_scheduler, &ProjectOpScheduler::logAppended, this, [this](const QString &text) {
+        ui->logEdit->appendPlainText(text.chopped(1));
+    });
+    connect(m_scheduler, &ProjectOpScheduler::finished, this, &MultiProjectOpDialog::updateButtons);
+
+    onOperationChanged();
+    updateButtons();
+}
+
+MultiProjectOpDialog::~MultiProjectOpDialog()
+{
+    delete ui;
+}
+
+void MultiProjectOpDialog::reject()
+{
+    if (m_scheduler->isRunning()) {
+        if (QMessageBox::question(this, "Stop", "Stop the operation in the remaining projects?") !=
+            QMessageBox::Yes) {
+            return;
+        }
+        m_scheduler->cancel();
+    }
+    QDialog::reject();
+}
+
+QStringList MultiProjectOpDialog::operationArguments() const
+{
+    const QString arg = ui->argEdit->text().trimmed();
+    switch (ui->operationCombo->currentIndex()) {
+        case Fetch:
+            return {"fetch", "--prune"};
+        case Pull:
+            return {"pull", "--ff-only"};
+        case Checkout:
+            return {"checkout", arg};
+        case CreateBranch:
+            return {"checkout", "-b", arg};
+        case Clean:
+            return {"clean", "-fd"};
+        case Custom: {
+            QStringList arguments = QProcess::splitCommand(arg);
+            if (!arguments.isEmpty() && arguments.first() == "git") {
+                arguments.removeFirst();
+            }
+            return arguments;
+        }
+    }
+    return {};
+}
+
+void MultiProjectOpDialog::onOperationChanged()
+{
+    switch (ui->operationCombo->currentIndex()) {
+        case Checkout:
+            ui->argEdit->setPlaceholderText("Branch, tag or commit");
+            ui->argEdit->setEnabled(true);
+            break;
+        case CreateBranch:
+            ui->argEdit->setPlaceholderText("New branch name");
+            ui->argEdit->setEnabled(true);
+            break;
+        case Custom:
+            ui->argEdit->setPlaceholderText("git arguments, e.g. stash list");
+            ui->argEdit->setEnabled(true);
+            break;
+        default:
+            ui->argEdit->setPlaceholderText("");
+            ui->argEdit->setEnabled(false);
+            break;
+    }
+}
+
+void MultiProjectOpDialog::onRun()
+{
+    if (ui->argEdit->isEnabled() && ui->argEdit->text().trimmed().isEmpty()) {
+        ui->argEdit->setFocus();
+        return;
+    }
+    QList<Project> projects;
+    for (int i = 0; i < ui->projectList->count(); ++i) {
+        QListWidgetItem *item = ui->projectList->item(i);
+        if (item->checkState() == Qt::Checked) {
+            projects.append(item->data(Qt::UserRole).value<Project>());
+        }
+    }
+    if (projects.isEmpty()) {
+        return;
+    }
+
+    const QString queued = ProjectOpScheduler::stateName(ProjectOpScheduler::Queued);
+    ui->taskTable->setRowCount(projects.size());
+    for (int row = 0; row < projects.size(); ++row) {
+        ui->taskTable->setItem(row, 0, new QTableWidgetItem(projects[row].path));
+        ui->taskTable->setItem(row, 1, new QTableWidgetItem(queued));
+        ui->taskTable->setItem(row, 2, new QTableWidgetItem());
+    }
+    ui->logEdit->clear();
+    const QStringList arguments = operationArguments();
+    ui->logEdit->appendPlainText("$ git " + arguments.join(' ') + "\n");
+    m_scheduler->setConcurrency(ui->jobsSpin->value());
+    m_scheduler->start(projects, arguments);
+    updateButtons();
+}
+
+void MultiProjectOpDialog::onTaskChanged(int index)
+{
+    const ProjectOpScheduler::Task &task = m_scheduler->tasks().at(index);
+    const bool ran =
+        task.state == ProjectOpScheduler::Succeeded || task.state == ProjectOpScheduler::Failed;
+    ui->taskTable->item(index, 1)->setText(ProjectOpScheduler::stateName(task.state));
+    ui->taskTable->item(index, 1)->setToolTip(task.output);
+    ui->taskTable->item(index, 2)->setText(
+        ran ? QString("%1 s").arg(task.elapsedMs / 1000.0, 0, 'f', 1) : QString());
+    if (task.state == ProjectOpScheduler::Running) {
+        ui->taskTable->scrollToItem(ui->taskTable->item(index, 0));
+    }
+    updateButtons();
+}
+
+void MultiProjectOpDialog::updateButtons()
+{
+    const bool running = m_scheduler->isRunning();
+    int done = 0;
+    int failed = 0;
+    int canceled = 0;
+    for (const ProjectOpScheduler::Task &task : m_scheduler->tasks()) {
+        done += task.state == ProjectOpScheduler::Succeeded;
+        failed += task.state == ProjectOpScheduler::Failed;
+        canceled += task.state == ProjectOpScheduler::Canceled;
+    }
+    ui->summaryLabel->setText(
+        m_scheduler->tasks().isEmpty()
+            ? QString()
+            : QString("%1/%2 done, %3 failed, %4 canceled")
+                  .arg(done)
+                  .arg(m_scheduler->tasks().size())
+                  .arg(failed)
+                  .arg(canceled));
+    ui->runBtn->setEnabled(!running);
+    ui->retryBtn->setEnabled(!running && failed + canceled > 0);
+    ui->stopBtn->setEnabled(running);
+    ui->operationCombo->setEnabled(!running);
+    ui->projectList->setEnabled(!running);
+}
@@ -0,0 +1,38 @@
+#ifndef MULTIPROJECTOPDIALOG_H
+#define MULTIPROJECTOPDIALOG_H
+
+#include <QDialog>
+
+#include "git/projectopscheduler.h"
+#include "repocontext.h"
+
+namespace Ui {
+    class MultiProjectOpDialog;
+}
+
+// Runs a git operation over a selection of the manifest projects
+class MultiProjectOpDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MultiProjectOpDialog(
+        QWidget *parent, const RepoContext &context, const QList<Project> &openedProjects);
+    ~MultiProjectOpDialog();
+
+public slots:
+    void reject() override;
+
+private:
+    Ui::MultiProjectOpDialog *ui;
+    RepoContext m_context;
+    ProjectOpScheduler *m_scheduler;
+
+    QStringList operationArguments() const;
+    void onOperationChanged();
+    void onRun();
+    void onTaskChanged(int index);
+    void updateButtons();
+};
+
+#endif  // MULTIPROJECTOPDIALOG_H
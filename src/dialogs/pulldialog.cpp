@@ -2,10 +2,9 @@
 
 #include <QDir>
 #include <QSettings>
-#include <QtConcurrent>
 
 #include "cmddialog.h"
-#include "global.h"
+#include "git/projectdata.h"
 #include "ui_pulldialog.h"
 
 PullDialog::PullDialog(QWidget *parent, const QString &projectPath)
@@ -27,31 +26,13 @@ PullDialog::PullDialog(QWidget *parent, const QString &projectPath)
 
     setEnabled(false);
     m_indicator->startHint();
-    QtConcurrent::run([projectPath]() {
-        InitData data;
-        QStringList lines = global::getCmdResult("git branch -a", projectPath).split('\n');
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.size() > 0) {
-                if (trLine.contains(" -> ")) {
-                    trLine = trLine.split(" -> ").first();
-                }
-                if (trLine.startsWith("*")) {
-                    trLine = trLine.mid(2);
-                    data.head = trLine;
-                }
-                if (trLine.startsWith("remotes/")) {
-                    trLine = trLine.mid(QString("remotes/").size());
-                    int slashIdx = trLine.indexOf("/");
-                    QStringList &branches = data.remoteBranches[trLine.first(slashIdx)];
-                    branches << trLine.mid(slashIdx + 1);
-                }
-            }
+    m_data = ProjectData::get(projectPath);
+    m_data->withRefs(this, [this](const RefSnapshot &refs) {
+        m_remoteBranches.clear();
+        for (const RefSnapshot::Ref &ref : refs.refs[RefSnapshot::Remote]) {
+            m_remoteBranches[ref.remote] << ref.remoteBranch();
         }
-        return data;
-    }).then(this, [this](InitData data) {
-        ui->localLabel->setText(data.head);
-        m_remoteBranches = data.remoteBranches;
+        ui->localLabel->setText(refs.head);
         updateBranchUI();
         setEnabled(true);
         m_indicator->stopHint();
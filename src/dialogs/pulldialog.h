@@ -3,9 +3,12 @@
 
 #include <QDialog>
 #include <QMap>
+#include <QSharedPointer>
 
 #include "widgets/QProgressIndicator.h"
 
+class ProjectData;
+
 namespace Ui {
     class PullDialog;
 }
@@ -21,15 +24,11 @@ public slots:
     void accept() override;
 
 private:
-    struct InitData
-    {
-        QString head;
-        QMap<QString, QStringList> remoteBranches;
-    };
     Ui::PullDialog *ui;
     QProgressIndicator *m_indicator;
 
     QString m_projectPath;
+    QSharedPointer<ProjectData> m_data;
     QMap<QString, QStringList> m_remoteBranches;
 
     void updateBranchUI();
@@ -2,11 +2,9 @@
 
 #include <QAbstractItemView>
 #include <QDir>
-#include <QProcess>
-#include <QtConcurrent>
 
 #include "cmddialog.h"
-#include "global.h"
+#include "git/projectdata.h"
 #include "themes/theme.h"
 #include "ui_pushdialog.h"
 
@@ -51,37 +49,18 @@ PushDialog::PushDialog(QWidget *parent, const RepoContext &context, const QStrin
     updateUrlUI();
     setEnabled(false);
     m_indicator->startHint();
-    QtConcurrent::run([projectPath]() {
-        InitData data;
-        QStringList lines = global::getCmdResult("git branch -a", projectPath).split('\n');
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.size() > 0) {
-                if (trLine.contains(" -> ")) {
-                    trLine = trLine.split(" -> ").first();
-                }
-                if (trLine.startsWith("*")) {
-                    trLine = trLine.mid(2);
-                    data.head = trLine;
-                }
-                if (!trLine.startsWith("remotes/")) {
-                    data.localBranches << trLine;
-                } else {
-                    trLine = trLine.mid(QString("remotes/").size());
-                    int slashIdx = trLine.indexOf("/");
-                    QStringList &branches = data.remoteBranches[trLine.first(slashIdx)];
-                    if (branches.isEmpty()) {
-                        branches << "";
-                    }
-                    branches << trLine.mid(slashIdx + 1);
-                }
+    m_data = ProjectData::get(projectPath);
+    m_data->withRefs(this, [this](const RefSnapshot &refs) {
+        m_remoteBranches.clear();
+        for (const RefSnapshot::Ref &ref : refs.refs[RefSnapshot::Remote]) {
+            QStringList &branches = m_remoteBranches[ref.remote];
+            if (branches.isEmpty()) {
+                branches << "";
             }
+            branches << ref.remoteBranch();
         }
-        return data;
-    }).then(this, [this](InitData data) {
-        ui->localBranchBox->addItems(data.localBranches);
-        ui->localBranchBox->setCurrentText(data.head);
-        m_remoteBranches = data.remoteBranches;
+        ui->localBranchBox->addItems(refs.names(RefSnapshot::Branch));
+        ui->localBranchBox->setCurrentText(refs.head);
         updateTargetBranchUI();
         setEnabled(true);
         m_indicator->stopHint();
@@ -120,7 +99,16 @@ void PushDialog::updateTargetBranchUI()
     ui->targetBranchBox->addItems(m_remoteBranches[ui->remoteBox->currentText()]);
     ui->targetBranchBox->setCurrentText(ui->localBranchBox->currentText());
     if (ui->targetBranchBox->currentText().isEmpty()) {
-        ui->targetBranchBox->setCurrentText(m_context.manifest().revision);
+        // Where repo upload sends it: the project's dest-branch, else its revision
+        const ManifestPtr manifest = m_context.manifest();
+        const Project *project =
+            manifest->findProject(QDir(m_context.repoPath()).relativeFilePath(m_projectPath));
+        QString target = manifest->revision;
+        if (project) {
+            target = project->destBranch.isEmpty() ? project->revision : project->destBranch;
+        }
+        if (target.startsWith("refs/heads/")) target = target.mid(11);
+        ui->targetBranchBox->setCurrentText(target);
     }
 }
 
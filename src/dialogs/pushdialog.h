@@ -3,10 +3,13 @@
 
 #include <QDialog>
 #include <QSettings>
+#include <QSharedPointer>
 
 #include "repocontext.h"
 #include "widgets/QProgressIndicator.h"
 
+class ProjectData;
+
 namespace Ui {
     class PushDialog;
 }
@@ -27,17 +30,11 @@ private slots:
     void updateTargetBranchUI();
 
 private:
-    struct InitData
-    {
-        QString head;
-        QStringList localBranches;
-        QMap<QString, QStringList> remoteBranches;
-    };
-
     Ui::PushDialog *ui;
     RepoContext m_context;
     QProgressIndicator *m_indicator;
     QString m_projectPath;
+    QSharedPointer<ProjectData> m_data;
     QMap<QString, QStringList> m_remoteBranches;
 };
 
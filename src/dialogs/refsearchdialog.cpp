@@ -0,0 +1,108 @@
+#include "refsearchdialog.h"
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+#include "ui_refsearchdialog.h"
+
+// Enough to answer the question, a broad query shows the first ones
+static const int maxMatches = 2000;
+
+RefSearchDialog::RefSearchDialog(QWidget *parent, const RepoContext &context)
+    : QDialog(parent), ui(new Ui::RefSearchDialog), m_context(context)
+{
+    ui->setupUi(this);
+    ui->resultTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Interactive);
+    ui->resultTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    ui->resultTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    ui->resultTable->setColumnWidth(0, 300);
+
+    connect(ui->searchEdit, &QLineEdit::textChanged, this, &RefSearchDialog::search);
+    connect(ui->resultTable, &QTableWidget::cellDoubleClicked, this, [this](int row) {
+        m_selectedMatch = m_matches.at(row);
+        accept();
+    });
+    connect(ui->closeBtn, &QPushButton::clicked, this, &RefSearchDialog::reject);
+
+    // The saved index answers right away, the update catches up with the changed projects
+    QElapsedTimer timer;
+    timer.start();
+    if (m_index.load(indexPath())) {
+        m_updateText = QString("Loaded in %1 ms, updating...").arg(timer.elapsed());
+    } else {
+        m_updateText = "Indexing...";
+    }
+    search();
+    updateIndexAsync();
+}
+
+RefSearchDialog::~RefSearchDialog()
+{
+    delete ui;
+}
+
+QString RefSearchDialog::indexPath() const
+{
+    return QDir::cleanPath(m_context.repoPath() + "/repoman.refs");
+}
+
+void RefSearchDialog::updateIndexAsync()
+{
+    const RefIndex index = m_index;
+    const QList<Project> projects = m_context.manifest()->projectList;
+    const QString filePath = indexPath();
+    m_updateWorker = QtConcurrent::run([index, projects, filePath]() {
+        UpdateResult result{index, 0, 0};
+        QElapsedTimer timer;
+        timer.start();
+        // Mostly waiting on the disk, more than the cores pays off
+        QThreadPool pool;
+        pool.setMaxThreadCount(qBound(4, QThread::idealThreadCount() * 2, 32));
+        result.reread = result.index.update(projects, &pool);
+        if (result.reread > 0 || !QFile::exists(filePath)) {
+            result.index.save(filePath);
+        }
+        result.elapsedMs = timer.elapsed();
+        return result;
+    });
+    QPointer thisPtr(this);
+    m_updateWorker.then(qApp, [thisPtr](const UpdateResult &result) {
+        if (thisPtr.isNull()) return;
+        thisPtr->m_index = result.index;
+        thisPtr->m_updateText = QString("%1 of %2 projects reread in %3 ms")
+                                    .arg(result.reread)
+                                    .arg(result.index.projectCount())
+                                    .arg(result.elapsedMs);
+        thisPtr->search();
+    });
+}
+
+void RefSearchDialog::search()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_matches = m_index.find(ui->searchEdit->text(), maxMatches);
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+    ui->resultTable->setRowCount(m_matches.size());
+    for (int row = 0; row < m_matches.size(); ++row) {
+        const RefIndex::Match &match = m_matches[row];
+        ui->resultTable->setItem(row, 0, new QTableWidgetItem(match.projectPath));
+        ui->resultTable->setItem(row, 1, new QTableWidgetItem(match.refName));
+        auto oidItem = new QTableWidgetItem(QString::fromLatin1(match.oid.left(10)));
+        oidItem->setToolTip(QString::fromLatin1(match.oid));
+        ui->resultTable->setItem(row, 2, oidItem);
+    }
+
+    QString text = QString("%1 refs in %2 projects  |  %3")
+                       .arg(m_index.refCount())
+                       .arg(m_index.projectCount())
+                       .arg(m_updateText);
+    if (!ui->searchEdit->text().trimmed().isEmpty()) {
+        text += QString("  |  %1%2 found in %3 ms")
+                    .arg(m_matches.size())
+                    .arg(m_matches.size() == maxMatches ? "+" : "")
+                    .arg(elapsedUs / 1000.0, 0, 'f', 2);
+    }
+    ui->summaryLabel->setText(text);
+}
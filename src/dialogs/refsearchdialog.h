@@ -0,0 +1,50 @@
+#ifndef REFSEARCHDIALOG_H
+#define REFSEARCHDIALOG_H
+
+#include <QDialog>
+#include <QFuture>
+
+#include "git/refindex.h"
+#include "repocontext.h"
+
+namespace Ui {
+    class RefSearchDialog;
+}
+
+// Finds the projects having a branch, tag or commit, searching the refs of all projects at once
+class RefSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RefSearchDialog(QWidget *parent, const RepoContext &context);
+    ~RefSearchDialog();
+
+    // The double-clicked ref once accepted
+    const RefIndex::Match &selectedMatch() const
+    {
+        return m_selectedMatch;
+    }
+
+private:
+    struct UpdateResult
+    {
+        RefIndex index;
+        int reread;
+        qint64 elapsedMs;
+    };
+
+    Ui::RefSearchDialog *ui;
+    RepoContext m_context;
+    RefIndex m_index;
+    QList<RefIndex::Match> m_matches;
+    RefIndex::Match m_selectedMatch;
+    QFuture<UpdateResult> m_updateWorker;
+    QString m_updateText;
+
+    QString indexPath() const;
+    void updateIndexAsync();
+    void search();
+};
+
+#endif  // REFSEARCHDIALOG_H
@@ -1,9 +1,18 @@
 #include "reposyncdialog.h"
 
+#include <QDir>
+#include <QHeaderView>
+#include <QLabel>
 #include <QSettings>
+#include <QSortFilterProxyModel>
+#include <QTableView>
 #include <QThread>
+#include <QVBoxLayout>
 
 #include "cmddialog.h"
+#include "git/manifestdelta.h"
+#include "pty/kshell.h"
+#include "syncprogress.h"
 #include "ui_reposyncdialog.h"
 
 RepoSyncDialog::RepoSyncDialog(QWidget *parent, const RepoContext &context, int currentIndex,
@@ -26,6 +35,7 @@ RepoSyncDialog::RepoSyncDialog(QWidget *parent, const RepoContext &context, int
     if (projects.size() <= 0) {
         ui->syncForCombo->setItemData(1, Qt::NoItemFlags, Qt::UserRole - 1);
     }
+    showSuggestion();
 }
 
 RepoSyncDialog::~RepoSyncDialog()
@@ -33,6 +43,57 @@ RepoSyncDialog::~RepoSyncDialog()
     delete ui;
 }
 
+void RepoSyncDialog::showSuggestion()
+{
+    SyncHistory history;
+    history.load(SyncHistory::filePath(m_context.repoPath()));
+    ui->useSuggestionBtn->hide();
+    if (history.runs().isEmpty()) {
+        ui->suggestionLabel->setText("Timings show up here after the first sync.");
+        return;
+    }
+
+    QStringList lines;
+    const SyncRun &last = history.runs().last();
+    QStringList phases;
+    if (last.network.tasks > 0) {
+        phases << QString("fetch %1 with %2 jobs")
+                      .arg(SyncProgressModel::formatSeconds(last.network.wall))
+                      .arg(last.network.jobs);
+    }
+    if (last.checkout.tasks > 0) {
+        phases << QString("checkout %1 with %2 jobs")
+                      .arg(SyncProgressModel::formatSeconds(last.checkout.wall))
+                      .arg(last.checkout.jobs);
+    }
+    if (!phases.isEmpty()) {
+        lines << "Last sync: " + phases.join(", ") + ".";
+    }
+
+    const int networkJobs = history.suggestNetworkJobs();
+    const int checkoutJobs = history.suggestCheckoutJobs();
+    if (networkJobs > 0 || checkoutJobs > 0) {
+        QStringList suggested;
+        if (networkJobs > 0) suggested << QString("--jobs-network=%1").arg(networkJobs);
+        if (checkoutJobs > 0) suggested << QString("--jobs-checkout=%1").arg(checkoutJobs);
+        lines << "Suggested: " + suggested.join(" ");
+        ui->useSuggestionBtn->show();
+        connect(ui->useSuggestionBtn, &QPushButton::clicked, this, [=]() {
+            if (networkJobs > 0) ui->networkJobsSpin->setValue(networkJobs);
+            if (checkoutJobs > 0) ui->checkoutJobsSpin->setValue(checkoutJobs);
+        });
+    }
+
+    QStringList slowest;
+    for (const auto &[path, seconds] : history.slowest(5)) {
+        slowest << QString("%1 (%2)").arg(path, SyncProgressModel::formatSeconds(seconds));
+    }
+    if (!slowest.isEmpty()) {
+        lines << "Slowest: " + slowest.join(", ");
+    }
+    ui->suggestionLabel->setText(lines.join("\n"));
+}
+
 void RepoSyncDialog::accept()
 {
     QString projectsArg;
@@ -48,16 +109,75 @@ void RepoSyncDialog::accept()
             }
             break;
     }
+    // What repo measured per project and phase, it appends to the file
+    const QString repoPath = m_context.repoPath();
+    const QString eventLog = QDir::cleanPath(repoPath + "/repoman.syncevents.json");
+    QFile::remove(eventLog);
+
+    // Without the phase flags repo fetches with -j and checks out with at most a job per core
+    const int jobs = ui->jobsSpin->value();
+    const int networkJobs = ui->networkJobsSpin->value();
+    const int checkoutJobs = ui->checkoutJobsSpin->value();
+    QString jobsArgs = QString(" -j%1").arg(jobs);
+    if (networkJobs > 0) jobsArgs += QString(" --jobs-network=%1").arg(networkJobs);
+    if (checkoutJobs > 0) jobsArgs += QString(" --jobs-checkout=%1").arg(checkoutJobs);
+
     QString cmd =
-        QString("repo sync -j%1%2%3%4%5%6%7%8%9")
-            .arg(QString::number(ui->jobsSpin->value()),
-                ui->forceCB->isChecked() ? " --force-sync" : "",
+        "repo --event-log=" + KShell::quoteArg(eventLog) +
+        QString(" sync%1%2%3%4%5%6%7%8%9")
+            .arg(jobsArgs, ui->forceCB->isChecked() ? " --force-sync" : "",
                 ui->detachCB->isChecked() ? " -d" : "", ui->localOnyCB->isChecked() ? " -l" : "",
                 ui->networkOnlyCB->isChecked() ? " -n" : "",
                 ui->pruneCB->isChecked() ? " --prune" : "",
                 ui->currentBranchCB->isChecked() ? " -c" : "",
                 ui->noTagsCB->isChecked() ? " --no-tags" : "", projectsArg);
-    int code = CmdDialog::execute(parentWidget(), cmd, m_context.repoPath());
+
+    // What the sync moved, for Manifest Delta
+    ManifestSnapshot::checkout(*m_context.manifest())
+        .write(ManifestSnapshot::preSyncPath(repoPath));
+
+    CmdDialog dialog(parentWidget(), {cmd}, repoPath);
+    auto model = new SyncProgressModel(&dialog, m_context.manifest());
+    auto proxyModel = new QSortFilterProxyModel(&dialog);
+    proxyModel->setSourceModel(model);
+    proxyModel->setSortRole(Qt::UserRole);
+    auto panel = new QWidget;
+    auto layout = new QVBoxLayout(panel);
+    layout->setContentsMargins(0, 0, 0, 0);
+    auto phaseLabel = new QLabel(panel);
+    auto tableView = new QTableView(panel);
+    tableView->setModel(proxyModel);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->setShowGrid(false);
+    tableView->setWordWrap(false);
+    tableView->verticalHeader()->hide();
+    tableView->verticalHeader()->setDefaultSectionSize(23);
+    tableView->horizontalHeader()->setSectionResizeMode(
+        SyncProgressModel::StatusColumn, QHeaderView::Stretch);
+    tableView->setColumnWidth(SyncProgressModel::PathColumn, 360);
+    layout->addWidget(phaseLabel);
+    layout->addWidget(tableView);
+    dialog.addTopWidget(panel);
+
+    connect(&dialog, &CmdDialog::outputReceived, model, &SyncProgressModel::feed);
+    connect(model, &SyncProgressModel::phaseChanged, phaseLabel, [model, phaseLabel]() {
+        phaseLabel->setText(model->phaseText());
+    });
+    connect(&dialog, &CmdDialog::commandFinished, model, [=]() {
+        const SyncRun run = model->finish(eventLog, networkJobs > 0 ? networkJobs : jobs,
+            checkoutJobs > 0 ? checkoutJobs : qMin(jobs, QThread::idealThreadCount()));
+        if (run.network.tasks > 0 || run.checkout.tasks > 0) {
+            SyncHistory history;
+            history.load(SyncHistory::filePath(repoPath));
+            history.add(run, model->timings());
+            history.save(SyncHistory::filePath(repoPath));
+        }
+        // Slowest first once the timings are in
+        tableView->setSortingEnabled(true);
+        tableView->sortByColumn(SyncProgressModel::FetchColumn, Qt::DescendingOrder);
+    });
+    int code = dialog.exec();
     done(code == 0 ? QDialog::Accepted : QDialog::Rejected);
 }
 
@@ -28,6 +28,9 @@ private:
     RepoContext m_context;
     QList<Project> m_projects;
     int m_currentIndex;
+
+    // Timings of the last syncs and the jobs they suggest
+    void showSuggestion();
 };
 
 #endif  // REPOSYNCDIALOG_H
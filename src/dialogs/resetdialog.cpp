@@ -3,6 +3,7 @@
 #include <QtConcurrent>
 
 #include "cmddialog.h"
+#include "git/refreader.h"
 #include "ui_resetdialog.h"
 
 ResetDialog::ResetDialog(QWidget *parent, const QString &projectPath, const Commit &commit)
@@ -15,24 +16,17 @@ ResetDialog::ResetDialog(QWidget *parent, const QString &projectPath, const Comm
     m_indicator->startHint();
     QtConcurrent::run([projectPath, commit]() {
         QPair<QString, Commit> data;  // branch,commit
-        QStringList lines = global::getCmdResult("git branch", projectPath).split('\n');
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.size() > 0) {
-                if (trLine.contains(" -> ")) {
-                    trLine = trLine.split(" -> ").first();
-                }
-                if (trLine.startsWith("*")) {
-                    data.first = trLine.mid(2);
-                    break;
-                }
-            }
+        QString headRef;
+        RefReader(projectPath).resolve("HEAD", &headRef);
+        if (headRef.startsWith("refs/heads/")) {
+            data.first = headRef.mid(QString("refs/heads/").size());
         }
 
         if (commit.hash.isEmpty()) {
-            lines = global::getCmdResult("git log -n1 --format=%H¿%h¿%s", projectPath)
-                        .trimmed()
-                        .split("¿");
+            const QStringList lines =
+                global::getCmdResult("git log -n1 --format=%H¿%h¿%s", projectPath)
+                    .trimmed()
+                    .split("¿");
             Commit c;
             c.hash = lines.at(0);
             c.shortHash = lines.at(1);
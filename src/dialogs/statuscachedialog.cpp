@@ -0,0 +1,111 @@
+#include "statuscachedialog.h"
+
+#include <QElapsedTimer>
+#include <QPushButton>
+#include <QtConcurrent>
+
+#include "global.h"
+#include "ui_statuscachedialog.h"
+
+static bool isConfigTrue(const QString &projectPath, const QString &key)
+{
+    const QByteArray value =
+        global::getCmdOutput("git", {"config", "--type=bool", "--get", key}, projectPath);
+    return value.trimmed() == "true";
+}
+
+StatusCacheDialog::StatusCacheDialog(QWidget *parent, const QString &projectPath)
+    : QDialog(parent), ui(new Ui::StatusCacheDialog), m_projectPath(projectPath)
+{
+    ui->setupUi(this);
+    m_indicator = new QProgressIndicator(this);
+    // Stays open to show the timing afterwards
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Apply");
+
+    setEnabled(false);
+    m_indicator->startHint();
+    m_worker = QtConcurrent::run([projectPath]() {
+        StatusCacheState state;
+        state.untrackedCache = isConfigTrue(projectPath, "core.untrackedCache");
+        state.fsmonitor = isConfigTrue(projectPath, "core.fsmonitor");
+        // Linux support of the daemon is recent
+        state.fsmonitorSupported =
+            !global::getCmdResult("git fsmonitor--daemon status", projectPath)
+                 .contains("not supported");
+        state.statusMs = timeStatus(projectPath);
+        return state;
+    });
+    m_worker.then(this, [this](const StatusCacheState &state) {
+        setEnabled(true);
+        m_indicator->stopHint();
+        ui->untrackedCacheCheckBox->setChecked(state.untrackedCache);
+        ui->fsmonitorCheckBox->setChecked(state.fsmonitor);
+        ui->fsmonitorCheckBox->setEnabled(state.fsmonitorSupported);
+        if (!state.fsmonitorSupported) {
+            ui->fsmonitorCheckBox->setToolTip("Not supported by this git version");
+        }
+        m_state = state;
+        m_beforeMs = state.statusMs;
+        ui->timingLabel->setText(QString("git status: %1 ms").arg(state.statusMs));
+    });
+}
+
+StatusCacheDialog::~StatusCacheDialog()
+{
+    m_worker.waitForFinished();
+    delete ui;
+}
+
+qint64 StatusCacheDialog::timeStatus(const QString &projectPath)
+{
+    QElapsedTimer timer;
+    timer.start();
+    global::getCmdCode("git --no-optional-locks status --porcelain=v2 -z --untracked-files=all",
+        projectPath);
+    return timer.elapsed();
+}
+
+void StatusCacheDialog::accept()
+{
+    const QString projectPath = m_projectPath;
+    StatusCacheState target = m_state;
+    target.untrackedCache = ui->untrackedCacheCheckBox->isChecked();
+    // Without support the fsmonitor settings aren't touched, e.g. a hook in core.fsmonitor
+    if (m_state.fsmonitorSupported) {
+        target.fsmonitor = ui->fsmonitorCheckBox->isChecked();
+    }
+    const StatusCacheState loaded = m_state;
+    setEnabled(false);
+    m_indicator->startHint();
+    m_worker = QtConcurrent::run([projectPath, loaded, target]() {
+        const QString on = "true";
+        const QString off = "false";
+        if (target.untrackedCache != loaded.untrackedCache) {
+            global::getCmdCode(
+                QString("git config core.untrackedCache %1").arg(target.untrackedCache ? on : off),
+                projectPath);
+        }
+        if (target.fsmonitor != loaded.fsmonitor) {
+            global::getCmdCode(
+                QString("git config core.fsmonitor %1").arg(target.fsmonitor ? on : off),
+                projectPath);
+            global::getCmdCode(target.fsmonitor ? "git fsmonitor--daemon start"
+                                                : "git fsmonitor--daemon stop",
+                projectPath);
+        }
+
+        // A status that may write the index fills the caches, the timed one uses them
+        global::getCmdCode("git status --porcelain --untracked-files=all", projectPath);
+        StatusCacheState state = target;
+        state.statusMs = timeStatus(projectPath);
+        return state;
+    });
+    m_worker.then(this, [this](const StatusCacheState &state) {
+        setEnabled(true);
+        m_indicator->stopHint();
+        ui->timingLabel->setText(
+            QString("git status: %1 ms before, %2 ms after").arg(m_beforeMs).arg(state.statusMs));
+        m_state = state;
+        m_beforeMs = state.statusMs;
+    });
+}
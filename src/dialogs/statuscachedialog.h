@@ -0,0 +1,46 @@
+#ifndef STATUSCACHEDIALOG_H
+#define STATUSCACHEDIALOG_H
+
+#include <QDialog>
+#include <QFuture>
+
+#include "widgets/QProgressIndicator.h"
+
+namespace Ui {
+    class StatusCacheDialog;
+}
+
+// Turns on git's untracked cache and file system monitor for a project, timing git status
+// before and after
+class StatusCacheDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit StatusCacheDialog(QWidget *parent, const QString &projectPath);
+    ~StatusCacheDialog();
+
+private:
+    Ui::StatusCacheDialog *ui;
+    QProgressIndicator *m_indicator;
+
+    QString m_projectPath;
+    qint64 m_beforeMs = -1;
+
+    struct StatusCacheState
+    {
+        bool untrackedCache = false;
+        bool fsmonitor = false;
+        bool fsmonitorSupported = false;
+        qint64 statusMs = 0;
+    };
+    StatusCacheState m_state;  // As loaded or last applied, only changes are written
+    QFuture<StatusCacheState> m_worker;
+
+    static qint64 timeStatus(const QString &projectPath);
+
+public slots:
+    void accept() override;
+};
+
+#endif  // STATUSCACHEDIALOG_H
@@ -146,7 +146,7 @@ void SwitchManifestDialog::updateListUI(const QString &branch)
         m_indicator->stopHint();
         m_model->setRootEntry(rootEntry);
         if (branch == m_currentBranch) {
-            QString manPath = QFileInfo(m_context.manifest().filePath).symLinkTarget();
+            QString manPath = QFileInfo(m_context.manifest()->filePath).symLinkTarget();
             QString manDir = QFileInfo(manPath).absoluteDir().path();
             QString innerManDir =
                 manDir.sliced(QDir::cleanPath(m_context.repoPath() + "/.repo/manifests/").size());
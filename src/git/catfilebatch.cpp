@@ -0,0 +1,132 @@
+#include "catfilebatch.h"
+
+#include <QMutexLocker>
+
+#include <string.h>
+
+CatFileBatch::CatFileBatch(const QString &projectPath) : m_projectPath(projectPath)
+{
+}
+
+CatFileBatch::~CatFileBatch()
+{
+    stop();
+}
+
+CatFileBatch::Result CatFileBatch::readBlob(const QString &name, QByteArray &content)
+{
+    QList<QByteArray> header;
+    const Result result = readObject(name, header, content);
+    if (result != Found) {
+        return result;
+    }
+    return header[1] == "blob" ? Found : Failed;
+}
+
+CatFileBatch::Result CatFileBatch::resolve(const QString &name, QByteArray &oid)
+{
+    QList<QByteArray> header;
+    QByteArray content;
+    const Result result = readObject(name, header, content);
+    if (result == Found) {
+        oid = header[0];
+    }
+    return result;
+}
+
+CatFileBatch::Result CatFileBatch::readObject(
+    const QString &name, QList<QByteArray> &header, QByteArray &content)
+{
+    if (name.contains('\n')) {
+        return Failed;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_git.isRunning() && !start()) {
+        return Failed;
+    }
+
+    QByteArray line;
+    if (!m_git.writeAll(name.toUtf8() + '\n') || !readLine(line)) {
+        stop();
+        return Failed;
+    }
+    if (line.endsWith(" missing")) {
+        return Missing;
+    }
+
+    // <oid> SP <type> SP <size> LF <contents> LF
+    header = line.split(' ');
+    bool ok = false;
+    const qint64 size = header.size() == 3 ? header[2].toLongLong(&ok) : 0;
+    if (!ok) {
+        return Failed;
+    }
+    content.resize(size);
+    char lf;
+    if (!readBytes(content.data(), size) || !readBytes(&lf, 1)) {
+        stop();
+        return Failed;
+    }
+    return Found;
+}
+
+bool CatFileBatch::start()
+{
+    m_buffer.clear();
+    m_bufferPos = 0;
+    return m_git.start(m_projectPath, {"cat-file", "--batch"}, GitPipe::ReadWrite);
+}
+
+void CatFileBatch::stop()
+{
+    // git exits on the end of its input
+    m_git.stop(false);
+    m_buffer.clear();
+    m_bufferPos = 0;
+}
+
+bool CatFileBatch::fillBuffer()
+{
+    if (m_bufferPos == m_buffer.size()) {
+        m_buffer.clear();
+        m_bufferPos = 0;
+    }
+    const qint64 oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + 65536);
+    const qint64 n = m_git.read(m_buffer.data() + oldSize, 65536);
+    m_buffer.resize(oldSize + qMax<qint64>(n, 0));
+    return n > 0;
+}
+
+bool CatFileBatch::readLine(QByteArray &line)
+{
+    qint64 searchFrom = m_bufferPos;
+    for (;;) {
+        const qint64 lf = m_buffer.indexOf('\n', searchFrom);
+        if (lf >= 0) {
+            line = m_buffer.mid(m_bufferPos, lf - m_bufferPos);
+            m_bufferPos = lf + 1;
+            return true;
+        }
+        searchFrom = m_buffer.size() - m_bufferPos;
+        if (!fillBuffer()) return false;
+        searchFrom += m_bufferPos;
+    }
+}
+
+bool CatFileBatch::readBytes(char *data, qint64 size)
+{
+    const qint64 buffered = qMin(size, m_buffer.size() - m_bufferPos);
+    memcpy(data, m_buffer.constData() + m_bufferPos, buffered);
+    m_bufferPos += buffered;
+
+    // Large blobs are read straight into place
+    qint64 done = buffered;
+    while (done < size) {
+        const qint64 n = m_git.read(data + done, size - done);
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
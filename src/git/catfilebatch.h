@@ -0,0 +1,47 @@
+#ifndef CATFILEBATCH_H
+#define CATFILEBATCH_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "git/gitpipe.h"
+
+// A long running `git cat-file --batch` for reading blobs without a process per read.
+// Thread safe, requests are serialized.
+class CatFileBatch
+{
+public:
+    enum Result
+    {
+        Found,
+        Missing,
+        Failed,
+    };
+
+    explicit CatFileBatch(const QString &projectPath);
+    ~CatFileBatch();
+
+    // name is any object name, e.g. ":path" for the index or "HEAD:path"
+    Result readBlob(const QString &name, QByteArray &content);
+    // The oid name stands for, e.g. "<tag>^{commit}" for the commit of an annotated tag
+    Result resolve(const QString &name, QByteArray &oid);
+
+private:
+    // header is split into oid, type and size
+    Result readObject(const QString &name, QList<QByteArray> &header, QByteArray &content);
+    bool start();
+    void stop();
+    bool readLine(QByteArray &line);
+    bool readBytes(char *data, qint64 size);
+    bool fillBuffer();
+
+    QString m_projectPath;
+    QMutex m_mutex;
+    GitPipe m_git;
+    QByteArray m_buffer;
+    qint64 m_bufferPos = 0;
+};
+
+#endif  // CATFILEBATCH_H
@@ -0,0 +1,196 @@
+#include "committimeline.h"
+
+#include <QtConcurrent>
+
+// Enough for the first screen, most projects never need more
+static const int firstBatchSize = 16;
+// Long running processes kept at once, each holds a pipe and a pid
+static const int maxOpenStreams = 128;
+
+QStringList TimelineFilter::arguments() const
+{
+    QStringList args;
+    if (!author.isEmpty()) {
+        args << "--regexp-ignore-case" << "--author=" + author;
+    }
+    if (!since.isEmpty()) {
+        args << "--since=" + since;
+    }
+    if (!until.isEmpty()) {
+        args << "--until=" + until;
+    }
+    return args;
+}
+
+LogStream::LogStream(const Project &project, const QStringList &arguments)
+    : m_project(project), m_arguments(arguments)
+{
+}
+
+LogStream::~LogStream()
+{
+    close();
+}
+
+const TimelineCommit *LogStream::head()
+{
+    if (m_pending.isEmpty() && !m_atEnd) {
+        if (m_parsed == 0) {
+            // Read to the end so that no process is left behind for the project
+            if (start(firstBatchSize)) {
+                while (readMore()) {
+                }
+                parseRecords();
+                close();
+            }
+            m_atEnd = m_parsed < firstBatchSize;
+        } else {
+            if (!m_git.isRunning() && !start(0)) {
+                m_atEnd = true;
+            }
+            while (!m_atEnd && m_pending.isEmpty()) {
+                if (!readMore()) {
+                    close();
+                    m_atEnd = true;
+                }
+                parseRecords();
+            }
+        }
+    }
+    return m_pending.isEmpty() ? nullptr : &m_pending.head();
+}
+
+void LogStream::pop()
+{
+    m_pending.dequeue();
+}
+
+bool LogStream::start(int maxCount)
+{
+    QStringList args = {"log", "--date-order", "-z", "--format=%H%x1f%ct%x1f%an%x1f%ae%x1f%s"};
+    if (maxCount > 0) {
+        args << QString("--max-count=%1").arg(maxCount);
+    }
+    if (m_parsed > 0) {
+        args << QString("--skip=%1").arg(m_parsed);
+    }
+    args << m_arguments;
+    return m_git.start(m_project.absPath, args, GitPipe::ReadOnly);
+}
+
+void LogStream::close()
+{
+    // git may be busy walking history rather than blocked on the pipe
+    m_git.stop(true);
+    // A partial record is read again by the next process
+    m_buffer.clear();
+    m_bufferPos = 0;
+}
+
+bool LogStream::readMore()
+{
+    if (m_bufferPos > 0) {
+        m_buffer.remove(0, m_bufferPos);
+        m_bufferPos = 0;
+    }
+    const qsizetype oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + 65536);
+    const qint64 n = m_git.read(m_buffer.data() + oldSize, 65536);
+    m_buffer.resize(oldSize + qMax<qint64>(n, 0));
+    return n > 0;
+}
+
+void LogStream::parseRecords()
+{
+    // <hash> US <time> US <author> US <email> US <subject> NUL
+    for (;;) {
+        const qsizetype end = m_buffer.indexOf('\0', m_bufferPos);
+        if (end < 0) {
+            break;
+        }
+        const QList<QByteArray> fields =
+            m_buffer.mid(m_bufferPos, end - m_bufferPos).split('\x1f');
+        m_bufferPos = end + 1;
+        ++m_parsed;
+        if (fields.size() != 5) {
+            continue;
+        }
+        TimelineCommit commit;
+        commit.project = m_project;
+        commit.hash = QString::fromLatin1(fields[0]);
+        commit.time = fields[1].toLongLong();
+        commit.author = QString::fromUtf8(fields[2]);
+        commit.authorEmail = QString::fromUtf8(fields[3]);
+        commit.subject = QString::fromUtf8(fields[4]);
+        m_pending.enqueue(commit);
+    }
+}
+
+CommitTimeline::CommitTimeline(const QList<Project> &projects, const TimelineFilter &filter)
+{
+    // Mostly waiting on git and the disk, more than the cores pays off
+    m_pool.setMaxThreadCount(qBound(4, QThread::idealThreadCount() * 2, 32));
+    const QStringList arguments = filter.arguments();
+    m_streams.reserve(projects.size());
+    for (const Project &project : projects) {
+        m_streams.push_back(std::make_unique<LogStream>(project, arguments));
+    }
+}
+
+CommitTimeline::~CommitTimeline()
+{
+}
+
+QList<TimelineCommit> CommitTimeline::take(int count, const std::function<bool()> &isCanceled)
+{
+    if (!m_primed && !prime(isCanceled)) {
+        return {};
+    }
+    QList<TimelineCommit> commits;
+    while (commits.size() < count && !m_heads.empty() && !isCanceled()) {
+        const int index = m_heads.top().second;
+        m_heads.pop();
+        LogStream *stream = m_streams[index].get();
+        commits.append(*stream->head());
+        stream->pop();
+        push(index);
+    }
+    return commits;
+}
+
+bool CommitTimeline::prime(const std::function<bool()> &isCanceled)
+{
+    // The first batches are independent short processes, one per project. Once canceled, the
+    // streams not started yet are skipped.
+    QFuture<void> priming =
+        QtConcurrent::map(&m_pool, m_streams, [&isCanceled](std::unique_ptr<LogStream> &stream) {
+            if (!isCanceled()) {
+                stream->head();
+            }
+        });
+    priming.waitForFinished();
+    if (isCanceled()) {
+        return false;
+    }
+    for (int i = 0; i < int(m_streams.size()); ++i) {
+        push(i);
+    }
+    m_primed = true;
+    return true;
+}
+
+void CommitTimeline::push(int index)
+{
+    LogStream *stream = m_streams[index].get();
+    if (const TimelineCommit *commit = stream->head()) {
+        m_heads.push({commit->time, index});
+    }
+
+    m_openStreams.removeOne(index);
+    if (stream->isOpen()) {
+        m_openStreams.append(index);
+        while (m_openStreams.size() > maxOpenStreams) {
+            m_streams[m_openStreams.takeFirst()]->close();
+        }
+    }
+}
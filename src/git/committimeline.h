@@ -0,0 +1,101 @@
+#ifndef COMMITTIMELINE_H
+#define COMMITTIMELINE_H
+
+#include <QQueue>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "git/gitpipe.h"
+#include "repocontext.h"
+
+struct TimelineCommit
+{
+    Project project;
+    QString hash;
+    QString subject;
+    QString author;
+    QString authorEmail;
+    qint64 time = 0;  // Committer date, seconds since epoch
+};
+
+// Applied by git in every project, not on the merged list
+struct TimelineFilter
+{
+    QString author;
+    QString since;  // Any date git understands, e.g. "2 weeks ago"
+    QString until;
+
+    QStringList arguments() const;
+};
+
+// `git log` of one project read a commit at a time. The first few commits come from a short
+// process that exits, the rest from a long running one started only once they are used up.
+class LogStream
+{
+public:
+    LogStream(const Project &project, const QStringList &arguments);
+    ~LogStream();
+
+    // The newest commit not taken yet, null at the end of the history
+    const TimelineCommit *head();
+    void pop();
+    bool isOpen() const
+    {
+        return m_git.isRunning();
+    }
+    // Stops the process, the next head() starts a new one where this one left off
+    void close();
+
+private:
+    bool start(int maxCount);
+    bool readMore();
+    void parseRecords();
+
+    Project m_project;
+    QStringList m_arguments;
+    QQueue<TimelineCommit> m_pending;
+    int m_parsed = 0;
+    bool m_atEnd = false;
+    GitPipe m_git;
+    QByteArray m_buffer;
+    qsizetype m_bufferPos = 0;
+};
+
+// Merges the log streams of many projects into one list, newest first. Only the commits taken
+// so far and one head per project are read, so the cost follows what is shown.
+class CommitTimeline
+{
+public:
+    CommitTimeline(const QList<Project> &projects, const TimelineFilter &filter);
+    ~CommitTimeline();
+
+    // Not thread safe, but may be called from any one thread at a time. The commits of a canceled
+    // call are lost, so cancel only a timeline that is being dropped.
+    QList<TimelineCommit> take(int count, const std::function<bool()> &isCanceled);
+    bool atEnd() const
+    {
+        return m_primed && m_heads.empty();
+    }
+    int projectCount() const
+    {
+        return m_streams.size();
+    }
+
+private:
+    using Head = std::pair<qint64, int>;  // Commit time, stream index
+
+    // Reads the first commit of every project, false when canceled
+    bool prime(const std::function<bool()> &isCanceled);
+    void push(int index);
+
+    std::vector<std::unique_ptr<LogStream>> m_streams;
+    std::priority_queue<Head> m_heads;
+    bool m_primed = false;
+    QList<int> m_openStreams;  // Least recently used first
+    QThreadPool m_pool;
+};
+
+#endif  // COMMITTIMELINE_H
@@ -0,0 +1,86 @@
+#include "diffcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+
+DiffCache::Key DiffCache::makeKey(
+    const QString &projectPath, const GitFile &file, bool staged, int contextLines)
+{
+    Key key;
+    if (global::isUnmerged(file.mode)) {
+        return key;
+    }
+    if (staged) {
+        if (file.headOid.isEmpty() || file.indexOid.isEmpty()) {
+            return key;
+        }
+        key.oldOid = file.headOid;
+        key.newOid = file.indexOid;
+    } else {
+        if (file.mode != "??" && file.indexOid.isEmpty()) {
+            return key;
+        }
+        key.oldOid = file.indexOid;
+        // Same as git's stat data check, with nanoseconds. A deleted file keeps the defaults.
+        const global::FileStat st =
+            global::statFile(QDir::cleanPath(projectPath + "/" + file.path), false);
+        key.mtime = st.mtime;
+        key.size = st.size;
+        key.inode = st.inode;
+    }
+    key.staged = staged;
+    key.contextLines = contextLines;
+    return key;
+}
+
+bool DiffCache::find(const QString &path, const Key &key, QList<DiffHunk> &hunks) const
+{
+    if (!key.isValid()) {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    const QHash<QString, Entry> &entries = key.staged ? m_stagedEntries : m_unstagedEntries;
+    auto it = entries.constFind(path);
+    if (it == entries.cend() || !(it->key == key)) {
+        return false;
+    }
+    hunks = it->hunks;
+    return true;
+}
+
+void DiffCache::insert(const QString &path, const Key &key, const QList<DiffHunk> &hunks)
+{
+    if (!key.isValid()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    (key.staged ? m_stagedEntries : m_unstagedEntries).insert(path, {key, hunks});
+}
+
+void DiffCache::invalidate(const QStringList &paths)
+{
+    QMutexLocker locker(&m_mutex);
+    for (QHash<QString, Entry> *entries : {&m_stagedEntries, &m_unstagedEntries}) {
+        entries->removeIf([&paths](const QHash<QString, Entry>::iterator &it) {
+            return global::isInPaths(it.key(), paths);
+        });
+    }
+}
+
+void DiffCache::retain(const QSet<QString> &paths)
+{
+    QMutexLocker locker(&m_mutex);
+    for (QHash<QString, Entry> *entries : {&m_stagedEntries, &m_unstagedEntries}) {
+        entries->removeIf([&paths](const QHash<QString, Entry>::iterator &it) {
+            return !paths.contains(it.key());
+        });
+    }
+}
+
+void DiffCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stagedEntries.clear();
+    m_unstagedEntries.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef DIFFCACHE_H
+#define DIFFCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include "global.h"
+#include "widgets/diffutils.h"
+
+// Diffs of status entries, valid as long as the blobs and the work tree file they were
+// computed from are the same. Thread safe.
+class DiffCache
+{
+public:
+    struct Key
+    {
+        bool staged = false;
+        int contextLines = -1;
+        QString oldOid;
+        QString newOid;
+        // Work tree file, unused for staged diffs
+        qint64 mtime = 0;
+        qint64 size = -1;
+        quint64 inode = 0;
+
+        bool isValid() const
+        {
+            return contextLines >= 0;
+        }
+        friend bool operator==(const Key &k1, const Key &k2) noexcept
+        {
+            return k1.staged == k2.staged && k1.contextLines == k2.contextLines &&
+                   k1.oldOid == k2.oldOid && k1.newOid == k2.newOid && k1.mtime == k2.mtime &&
+                   k1.size == k2.size && k1.inode == k2.inode;
+        }
+    };
+
+    // Invalid when the entry carries no blob ids, e.g. patched in after staging
+    static Key makeKey(
+        const QString &projectPath, const GitFile &file, bool staged, int contextLines);
+
+    bool find(const QString &path, const Key &key, QList<DiffHunk> &hunks) const;
+    void insert(const QString &path, const Key &key, const QList<DiffHunk> &hunks);
+    // Drops the entries of the paths and of files below them
+    void invalidate(const QStringList &paths);
+    // Drops the entries of files that are no longer changed
+    void retain(const QSet<QString> &paths);
+    void clear();
+
+private:
+    struct Entry
+    {
+        Key key;
+        QList<DiffHunk> hunks;
+    };
+
+    mutable QMutex m_mutex;
+    // By path, on each side of the index
+    QHash<QString, Entry> m_stagedEntries;
+    QHash<QString, Entry> m_unstagedEntries;
+};
+
+#endif  // DIFFCACHE_H
@@ -0,0 +1,186 @@
+#include "diffengine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+
+namespace git {
+
+    static bool parseBool(const QString &value)
+    {
+        // A key without value is true
+        const QString v = value.toLower();
+        return v.isEmpty() || v == "true" || v == "yes" || v == "on" || v == "1";
+    }
+
+    static qint64 parseSize(const QString &value)
+    {
+        QString v = value.toLower();
+        qint64 factor = 1;
+        if (v.endsWith('k')) {
+            factor = 1024;
+        } else if (v.endsWith('m')) {
+            factor = 1024 * 1024;
+        } else if (v.endsWith('g')) {
+            factor = 1024 * 1024 * 1024;
+        }
+        if (factor > 1) v.chop(1);
+        return v.toLongLong() * factor;
+    }
+
+    DiffConfig readDiffConfig(const QString &projectPath)
+    {
+        DiffConfig config;
+        const QString cmdResult = global::getCmdResult(
+            R"(git config --get-regexp "^(diff\.(algorithm|indentheuristic)|core\.(autocrlf|attributesfile|bigfilethreshold))$")",
+            projectPath);
+        for (const QString &line : cmdResult.split('\n', Qt::SkipEmptyParts)) {
+            const QString key = line.section(' ', 0, 0);
+            const QString value = line.section(' ', 1);
+            if (key == "diff.algorithm") {
+                if (value == "minimal") {
+                    config.options.algorithm = xdiff::Minimal;
+                } else if (value == "patience") {
+                    config.options.algorithm = xdiff::Patience;
+                } else if (value == "histogram") {
+                    config.options.algorithm = xdiff::Histogram;
+                } else {
+                    config.options.algorithm = xdiff::Myers;
+                }
+            } else if (key == "diff.indentheuristic") {
+                config.options.indentHeuristic = parseBool(value);
+            } else if (key == "core.autocrlf") {
+                config.convertsContent |= value == "input" || parseBool(value);
+            } else if (key == "core.attributesfile") {
+                config.convertsContent = true;
+            } else if (key == "core.bigfilethreshold") {
+                config.bigFileThreshold = parseSize(value);
+            }
+        }
+
+        QString xdgConfig = QProcessEnvironment::systemEnvironment().value("XDG_CONFIG_HOME");
+        if (xdgConfig.isEmpty()) {
+            xdgConfig = QDir::homePath() + "/.config";
+        }
+        if (QFileInfo::exists(xdgConfig + "/git/attributes")) {
+            config.convertsContent = true;
+        }
+        return config;
+    }
+
+    static bool hasAttributes(const QString &projectPath, const QString &path)
+    {
+        if (QFileInfo::exists(projectPath + "/.git/info/attributes")) {
+            return true;
+        }
+        QString dir = projectPath;
+        const QStringList segments = path.split('/');
+        for (int i = 0; i < segments.size(); ++i) {
+            if (QFileInfo::exists(dir + "/.gitattributes")) {
+                return true;
+            }
+            dir += "/" + segments[i];
+        }
+        return false;
+    }
+
+    static bool readObject(CatFileBatch &catFile, const QString &name, QByteArray &data)
+    {
+        switch (catFile.readBlob(name, data)) {
+            case CatFileBatch::Found:
+                return true;
+            case CatFileBatch::Missing:
+                data.clear();
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // The blob of the status entry, which is what the diff cache keys on, rather than what HEAD
+    // or the index hold by now. A null id reads as missing.
+    static QString blobName(const QString &oid, const QString &fallback)
+    {
+        return oid.isEmpty() ? fallback : oid;
+    }
+
+    QList<DiffHunk> diffHunks(const QByteArray &oldData, const QByteArray &newData,
+        const DiffConfig &config, int contextLines, bool &ok)
+    {
+        ok = true;
+        const std::string_view a(oldData.constData(), oldData.size());
+        const std::string_view b(newData.constData(), newData.size());
+        if (oldData.size() > config.bigFileThreshold || newData.size() > config.bigFileThreshold ||
+            xdiff::isBinary(a) || xdiff::isBinary(b)) {
+            return {};
+        }
+
+        xdiff::Options options = config.options;
+        options.contextLines = contextLines;
+        std::vector<xdiff::Hunk> hunks;
+        if (!xdiff::diff(a, b, options, hunks)) {
+            ok = false;
+            return {};
+        }
+
+        DiffHunkBuilder builder;
+        for (const xdiff::Hunk &hunk : hunks) {
+            builder.addLine(QString::fromUtf8(hunk.header.data(), hunk.header.size()));
+            for (const xdiff::Line &line : hunk.lines) {
+                std::string_view text = line.text;
+                const bool incomplete = text.empty() || text.back() != '\n';
+                if (!incomplete) text.remove_suffix(1);
+                if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+                builder.addLine(QChar(line.origin) + QString::fromUtf8(text.data(), text.size()));
+                if (incomplete) {
+                    builder.addLine("\\ No newline at end of file");
+                }
+            }
+        }
+        return builder.hunks();
+    }
+
+    bool diffFile(CatFileBatch &catFile, const DiffConfig &config, const QString &projectPath,
+        const GitFile &file, bool staged, int contextLines, QList<DiffHunk> &hunks)
+    {
+        // Unmerged
+        if (global::isUnmerged(file.mode)) {
+            return false;
+        }
+        if (config.convertsContent || hasAttributes(projectPath, file.path)) {
+            return false;
+        }
+        // Symlinks and submodules are not diffed by content
+        const QFileInfo info(QDir::cleanPath(projectPath + "/" + file.path));
+        if (info.isSymLink() || info.isDir()) {
+            return false;
+        }
+
+        QByteArray oldData;
+        QByteArray newData;
+        if (staged) {
+            if (!readObject(catFile, blobName(file.headOid, "HEAD:" + file.path), oldData) ||
+                !readObject(catFile, blobName(file.indexOid, ":" + file.path), newData)) {
+                return false;
+            }
+        } else {
+            if (file.mode != "??" &&
+                !readObject(catFile, blobName(file.indexOid, ":" + file.path), oldData)) {
+                return false;
+            }
+            // Deleted files read as empty. Copied, not mapped: an editor truncating the file
+            // while it is diffed would fault a mapping.
+            if (info.exists()) {
+                QFile workFile(info.filePath());
+                if (!workFile.open(QIODevice::ReadOnly)) return false;
+                newData = workFile.readAll();
+            }
+        }
+
+        bool ok;
+        hunks = diffHunks(oldData, newData, config, contextLines, ok);
+        return ok;
+    }
+
+}  // namespace git
@@ -0,0 +1,43 @@
+#ifndef DIFFENGINE_H
+#define DIFFENGINE_H
+
+#include <QString>
+
+#include "git/catfilebatch.h"
+#include "git/xdiff.h"
+#include "global.h"
+#include "widgets/diffutils.h"
+
+namespace git {
+
+    // The parts of git config that change what `git diff` prints
+    struct DiffConfig
+    {
+        xdiff::Options options;
+        bool convertsContent = false;  // core.autocrlf or a global attributes file
+        qint64 bigFileThreshold = 512 * 1024 * 1024;
+
+        friend bool operator==(const DiffConfig &c1, const DiffConfig &c2) noexcept
+        {
+            return c1.options.algorithm == c2.options.algorithm &&
+                   c1.options.indentHeuristic == c2.options.indentHeuristic &&
+                   c1.convertsContent == c2.convertsContent &&
+                   c1.bigFileThreshold == c2.bigFileThreshold;
+        }
+    };
+
+    DiffConfig readDiffConfig(const QString &projectPath);
+
+    // Diffs two blobs, binary ones give no hunks like `git diff` prints none
+    QList<DiffHunk> diffHunks(const QByteArray &oldData, const QByteArray &newData,
+        const DiffConfig &config, int contextLines, bool &ok);
+
+    // Diffs a `git status` entry in process, HEAD against the index when staged, otherwise the
+    // index (or nothing when untracked) against the work tree. Returns false when it has to be
+    // left to `git diff`, e.g. unmerged files, symlinks or content conversion by attributes.
+    bool diffFile(CatFileBatch &catFile, const DiffConfig &config, const QString &projectPath,
+        const GitFile &file, bool staged, int contextLines, QList<DiffHunk> &hunks);
+
+}  // namespace git
+
+#endif  // DIFFENGINE_H
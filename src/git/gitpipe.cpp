@@ -0,0 +1,108 @@
+#include "gitpipe.h"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Resolved in the parent, a PATH search after fork isn't async-signal-safe
+static const QByteArray &gitPath()
+{
+    static const QByteArray path = QFile::encodeName(QStandardPaths::findExecutable("git"));
+    return path;
+}
+
+GitPipe::~GitPipe()
+{
+    stop(true);
+}
+
+bool GitPipe::start(const QString &workingDirectory, const QStringList &arguments, Mode mode)
+{
+    stop(true);
+    const QByteArray &program = gitPath();
+    if (program.isEmpty()) {
+        return false;
+    }
+    QList<QByteArray> argData = {"git"};
+    for (const QString &arg : arguments) {
+        argData.append(arg.toUtf8());
+    }
+    std::vector<char *> argv;
+    for (QByteArray &arg : argData) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+    const QByteArray dir = QFile::encodeName(workingDirectory);
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        const int devNull = open("/dev/null", O_RDWR);
+        const int input = mode == ReadWrite ? fds[1] : devNull;
+        if (devNull < 0 || chdir(dir.constData()) != 0 || dup2(input, STDIN_FILENO) < 0 ||
+            dup2(fds[1], STDOUT_FILENO) < 0 || dup2(devNull, STDERR_FILENO) < 0) {
+            _exit(127);
+        }
+        execv(program.constData(), argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    m_fd = fds[0];
+    m_pid = pid;
+    return true;
+}
+
+void GitPipe::stop(bool kill)
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (m_pid > 0) {
+        if (kill) {
+            ::kill(m_pid, SIGKILL);
+        }
+        while (waitpid(m_pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+        m_pid = -1;
+    }
+}
+
+qint64 GitPipe::read(char *data, qint64 maxSize)
+{
+    ssize_t n;
+    do {
+        n = ::read(m_fd, data, maxSize);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+bool GitPipe::writeAll(const QByteArray &data)
+{
+    qint64 written = 0;
+    while (written < data.size()) {
+        // No SIGPIPE when git is gone
+        const ssize_t n =
+            send(m_fd, data.constData() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += n;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef GITPIPE_H
+#define GITPIPE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// A git process read from and written to through a socket. Unlike a QProcess it isn't bound to
+// the thread that started it, so readers shared by worker threads can own one. Everything the
+// child needs is prepared before fork, only async-signal-safe calls run in it.
+class GitPipe
+{
+public:
+    enum Mode
+    {
+        ReadOnly,   // stdin is /dev/null
+        ReadWrite,  // stdin and stdout are the socket
+    };
+
+    GitPipe() = default;
+    ~GitPipe();
+    GitPipe(const GitPipe &) = delete;
+    GitPipe &operator=(const GitPipe &) = delete;
+
+    bool start(const QString &workingDirectory, const QStringList &arguments, Mode mode);
+    // Closes the socket and reaps git. kill is for a git that wouldn't stop on the end of its
+    // input, e.g. one walking history.
+    void stop(bool kill);
+    bool isRunning() const
+    {
+        return m_fd >= 0;
+    }
+
+    // Retried when interrupted, 0 at the end of the output
+    qint64 read(char *data, qint64 maxSize);
+    bool writeAll(const QByteArray &data);
+
+private:
+    int m_pid = -1;
+    int m_fd = -1;
+};
+
+#endif  // GITPIPE_H
@@ -0,0 +1,209 @@
+#include "manifestdelta.h"
+
+#include <QDir>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QSaveFile>
+#include <QXmlStreamWriter>
+
+#include "git/refindex.h"
+#include "git/refreader.h"
+#include "manifestparser.h"
+
+static bool runGit(const QString &dir, const QStringList &arguments, QByteArray &output)
+{
+    QProcess process;
+    process.setWorkingDirectory(dir);
+    process.start("git", arguments, QIODeviceBase::ReadOnly);
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit ||
+        process.exitCode() != 0) {
+        return false;
+    }
+    output = process.readAllStandardOutput();
+    return true;
+}
+
+// Revisions by path, from a manifest resolved by parser
+static ManifestSnapshot snapshotOf(const Manifest &manifest, const ManifestParser &parser)
+{
+    ManifestSnapshot snapshot;
+    snapshot.error = parser.error();
+    for (const Project &project : manifest.projectList) {
+        snapshot.projects.insert(project.path, {project.name, project.revision, project.remote});
+    }
+    return snapshot;
+}
+
+ManifestSnapshot ManifestSnapshot::checkout(const Manifest &manifest)
+{
+    ManifestSnapshot snapshot;
+    for (const Project &project : manifest.projectList) {
+        const QByteArray head = RefIndex::readHead(project.absPath);
+        if (!head.isEmpty()) {
+            snapshot.projects.insert(project.path, {project.name, QString::fromLatin1(head), {}});
+        }
+    }
+    return snapshot;
+}
+
+ManifestSnapshot ManifestSnapshot::readFile(const QString &repoPath, const QString &filePath)
+{
+    ManifestParser parser(repoPath);
+    const Manifest manifest = parser.parseManifestFile(filePath);
+    return snapshotOf(manifest, parser);
+}
+
+ManifestSnapshot ManifestSnapshot::readManifestBranch(
+    const QString &repoPath, const QString &branch)
+{
+    ManifestParser parser(repoPath);
+    const Manifest manifest = parser.parseManifestBranch(branch);
+    return snapshotOf(manifest, parser);
+}
+
+bool ManifestSnapshot::write(const QString &filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QXmlStreamWriter xml(&file);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("manifest");
+    for (auto it = projects.cbegin(); it != projects.cend(); ++it) {
+        xml.writeEmptyElement("project");
+        xml.writeAttribute("name", it->name);
+        xml.writeAttribute("path", it.key());
+        xml.writeAttribute("revision", it->revision);
+        if (!it->remote.isEmpty()) {
+            xml.writeAttribute("remote", it->remote);
+        }
+    }
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    return file.commit();
+}
+
+QString ManifestSnapshot::preSyncPath(const QString &repoPath)
+{
+    return QDir::cleanPath(repoPath + "/repoman.presync.xml");
+}
+
+// The commit of a revision. Branch names are looked up among the remote branches first, a
+// local branch of the same name is most likely a topic branch.
+static QString resolveRevision(const QString &projectPath, const ManifestSnapshot::Entry &entry)
+{
+    QStringList candidates;
+    QString branch = entry.revision;
+    if (branch.startsWith("refs/heads/")) branch = branch.mid(11);
+    if (!RefReader::isOid(branch.toLatin1()) && !branch.startsWith("refs/") &&
+        !entry.remote.isEmpty()) {
+        candidates << "refs/remotes/" + entry.remote + "/" + branch;
+    }
+    candidates << entry.revision;
+    for (const QString &candidate : candidates) {
+        QByteArray output;
+        if (runGit(projectPath, {"rev-parse", "--verify", "-q", candidate + "^{commit}"},
+                output)) {
+            const QByteArray oid = output.trimmed();
+            if (RefReader::isOid(oid)) {
+                return QString::fromLatin1(oid);
+            }
+        }
+    }
+    return {};
+}
+
+static QList<DeltaCommit> readCommits(
+    const QString &projectPath, const QString &range, int maxCount)
+{
+    QList<DeltaCommit> commits;
+    QByteArray output;
+    if (!runGit(projectPath,
+            {"log", "-z", "--max-count=" + QString::number(maxCount),
+                "--format=%H%x1f%an%x1f%ct%x1f%s", range},
+            output)) {
+        return commits;
+    }
+    for (const QByteArray &record : output.split('\0')) {
+        const QList<QByteArray> fields = record.split('\x1f');
+        if (fields.size() < 4) {
+            continue;
+        }
+        commits.append({QString::fromLatin1(fields[0]), QString::fromUtf8(fields[1]),
+            QString::fromUtf8(fields[3]), fields[2].toLongLong()});
+    }
+    return commits;
+}
+
+ManifestDelta::ManifestDelta()
+{
+    m_cache.setMaxCost(200000);
+}
+
+ManifestDelta &ManifestDelta::instance()
+{
+    static ManifestDelta delta;
+    return delta;
+}
+
+ProjectDelta ManifestDelta::compute(const QString &projectPath, const QString &path,
+    const ManifestSnapshot::Entry *oldEntry, const ManifestSnapshot::Entry *newEntry)
+{
+    ProjectDelta delta;
+    delta.path = path;
+    if (oldEntry) delta.oldRevision = oldEntry->revision;
+    if (newEntry) delta.newRevision = newEntry->revision;
+    if (!oldEntry || !newEntry) {
+        delta.kind = oldEntry ? ProjectDelta::Removed : ProjectDelta::Added;
+        return delta;
+    }
+    // Pinned on both sides, e.g. two checkouts, most projects are the same
+    if (oldEntry->revision == newEntry->revision &&
+        RefReader::isOid(oldEntry->revision.toLatin1())) {
+        delta.oldOid = delta.newOid = oldEntry->revision;
+        return delta;
+    }
+
+    delta.oldOid = resolveRevision(projectPath, *oldEntry);
+    delta.newOid = resolveRevision(projectPath, *newEntry);
+    if (delta.oldOid.isEmpty() || delta.newOid.isEmpty()) {
+        delta.kind = ProjectDelta::Unresolved;
+        return delta;
+    }
+    if (delta.oldOid == delta.newOid) {
+        return delta;
+    }
+    delta.kind = ProjectDelta::Changed;
+
+    const QPair<QString, QString> key(delta.oldOid, delta.newOid);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const Commits *commits = m_cache.object(key)) {
+            delta.added = commits->added;
+            delta.dropped = commits->dropped;
+            delta.truncated = commits->truncated;
+            return delta;
+        }
+    }
+
+    // One more than shown, to know whether there are more
+    auto commits = new Commits;
+    const int maxCount = maxCommits + 1;
+    commits->added = readCommits(projectPath, delta.oldOid + ".." + delta.newOid, maxCount);
+    commits->dropped = readCommits(projectPath, delta.newOid + ".." + delta.oldOid, maxCount);
+    for (QList<DeltaCommit> *list : {&commits->added, &commits->dropped}) {
+        if (list->size() > maxCommits) {
+            list->resize(maxCommits);
+            commits->truncated = true;
+        }
+    }
+    delta.added = commits->added;
+    delta.dropped = commits->dropped;
+    delta.truncated = commits->truncated;
+
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(key, commits, commits->added.size() + commits->dropped.size() + 1);
+    return delta;
+}
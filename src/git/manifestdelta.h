@@ -0,0 +1,99 @@
+#ifndef MANIFESTDELTA_H
+#define MANIFESTDELTA_H
+
+#include <QCache>
+#include <QMap>
+#include <QMutex>
+
+#include "repocontext.h"
+
+// The revision of every project at one point: a manifest, pinned or not, or what is checked out
+struct ManifestSnapshot
+{
+    struct Entry
+    {
+        QString name;
+        QString revision;  // Commit, branch or tag
+        QString remote;
+    };
+
+    QMap<QString, Entry> projects;  // By path
+    QString error;
+
+    bool isValid() const
+    {
+        return error.isEmpty();
+    }
+
+    // HEAD of every project of the manifest
+    static ManifestSnapshot checkout(const Manifest &manifest);
+    // A manifest file, with the includes next to it, e.g. one written by `repo manifest -r`
+    static ManifestSnapshot readFile(const QString &repoPath, const QString &filePath);
+    // The manifest on a branch of .repo/manifests, without the local manifests
+    static ManifestSnapshot readManifestBranch(const QString &repoPath, const QString &branch);
+    // Pinned, so it can be read back after the projects moved on
+    bool write(const QString &filePath) const;
+
+    // Taken right before `repo sync` runs
+    static QString preSyncPath(const QString &repoPath);
+};
+
+struct DeltaCommit
+{
+    QString hash;
+    QString author;
+    QString subject;
+    qint64 time = 0;  // Committer date, seconds since epoch
+};
+
+// What changed in one project between two snapshots
+struct ProjectDelta
+{
+    enum Kind
+    {
+        Unchanged,
+        Changed,
+        Added,
+        Removed,
+        Unresolved,  // A revision is not in the project, most likely not fetched yet
+    };
+
+    QString path;
+    Kind kind = Unchanged;
+    QString oldRevision;
+    QString newRevision;
+    QString oldOid;
+    QString newOid;
+    QList<DeltaCommit> added;    // Reachable from the new revision only, newest first
+    QList<DeltaCommit> dropped;  // Reachable from the old revision only, e.g. after a rewind
+    bool truncated = false;      // More than maxCommits on a side
+};
+
+// Computes project deltas with git, remembering the commit lists of each pair of commits.
+// Thread safe.
+class ManifestDelta
+{
+public:
+    static const int maxCommits = 1000;
+
+    static ManifestDelta &instance();
+
+    // Either entry may be null, for a project only in one of the snapshots
+    ProjectDelta compute(const QString &projectPath, const QString &path,
+        const ManifestSnapshot::Entry *oldEntry, const ManifestSnapshot::Entry *newEntry);
+
+private:
+    struct Commits
+    {
+        QList<DeltaCommit> added;
+        QList<DeltaCommit> dropped;
+        bool truncated = false;
+    };
+
+    QMutex m_mutex;
+    QCache<QPair<QString, QString>, Commits> m_cache;  // By old and new commit, cost is commits
+
+    ManifestDelta();
+};
+
+#endif  // MANIFESTDELTA_H
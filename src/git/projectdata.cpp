@@ -0,0 +1,773 @@
+#include "projectdata.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QProcess>
+#include <QtConcurrent>
+
+#include "git/refreader.h"
+#include "git/refwatcher.h"
+#include "git/statusparser.h"
+#include "git/worktreewatcher.h"
+
+QSharedPointer<ProjectData> ProjectData::get(const QString &projectPath)
+{
+    // Only touched from the UI thread
+    static QHash<QString, QWeakPointer<ProjectData>> instances;
+    QSharedPointer<ProjectData> data = instances.value(projectPath).toStrongRef();
+    if (data.isNull()) {
+        for (auto it = instances.begin(); it != instances.end();) {
+            it = it->isNull() ? instances.erase(it) : std::next(it);
+        }
+        data = QSharedPointer<ProjectData>(new ProjectData(projectPath), &QObject::deleteLater);
+        instances.insert(projectPath, data);
+    }
+    return data;
+}
+
+ProjectData::ProjectData(const QString &projectPath)
+    : QObject(nullptr),
+      m_projectPath(projectPath),
+      m_catFile(new CatFileBatch(projectPath)),
+      m_diffCache(new DiffCache),
+      m_refs(new RefSnapshot)
+{
+    m_fileOpPool.setMaxThreadCount(1);
+    m_precomputePool.setMaxThreadCount(1);
+    m_precomputePool.setThreadPriority(QThread::LowestPriority);
+    m_divergencePool.setMaxThreadCount(1);
+    m_divergencePool.setThreadPriority(QThread::LowestPriority);
+
+    m_watcher = new WorkTreeWatcher(projectPath, this);
+    connect(m_watcher, &WorkTreeWatcher::changed, this, &ProjectData::onWorkTreeChanged);
+    m_refWatcher = new RefWatcher(projectPath, this);
+    connect(m_refWatcher, &RefWatcher::changed, this, &ProjectData::onRefsMoved);
+    connect(this, &ProjectData::refsChanged, this, &ProjectData::countDivergences);
+}
+
+ProjectData::~ProjectData()
+{
+    m_statusWorker.cancel();
+    m_precomputeWorker.cancel();
+    // Each reload starts a reader, older ones may still run
+    m_refsPool.waitForDone();
+    // File operations stop before their next git command
+    m_closing = true;
+    m_fileOpPool.waitForDone();
+}
+
+bool ProjectData::isWatching() const
+{
+    return m_watcher->watching();
+}
+
+void ProjectData::refresh()
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        ++m_logGeneration;
+    }
+    refreshStatus();
+    refreshRefs();
+    emit historyChanged();
+}
+
+void ProjectData::ensureStatus()
+{
+    if (!m_statusLoaded && !m_statusWorker.isRunning()) {
+        loadStatus();
+    }
+    m_watcher->start();
+}
+
+void ProjectData::refreshStatus()
+{
+    // The lists stay while reloading, the new status is applied as a diff
+    m_statusWorker.cancel();
+    loadStatus();
+    m_watcher->start();
+}
+
+bool ProjectData::isStagedFile(const QString &mode)
+{
+    // Untracked
+    if (mode == "??") {
+        return false;
+    }
+    // Unmerged
+    if (global::isUnmerged(mode)) {
+        return false;
+    }
+    if (mode[0] != ' ') {
+        return true;
+    }
+    if (mode[1] != ' ') {
+        return false;
+    }
+    Q_UNREACHABLE();
+}
+
+void ProjectData::loadStatus(const QStringList &paths)
+{
+    if (m_projectPath.isEmpty()) {
+        return;
+    }
+    m_pendingPaths.clear();
+    m_pendingFullRefresh = false;
+    if (paths.isEmpty()) {
+        emit statusLoading();
+    }
+
+    const QString projectPath = m_projectPath;
+    m_statusWorker = QtConcurrent::run([projectPath, paths](QPromise<StatusResult> &promise) {
+        // No optional locks, so the index isn't rewritten and picked up by the watcher
+        QStringList args = {"--no-optional-locks", "--literal-pathspecs", "status",
+            "--porcelain=v2", "-z", "--untracked-files=all"};
+        if (!paths.isEmpty()) {
+            args << "--" << paths;
+        }
+        StatusResult result;
+        result.paths = paths;
+
+        // Parse while git is still walking the tree
+        QProcess process;
+        process.setWorkingDirectory(projectPath);
+        process.start("git", args, QIODeviceBase::ReadOnly);
+        StatusParser parser;
+        while (process.waitForReadyRead(-1) || process.bytesAvailable()) {
+            parser.feed(process.readAllStandardOutput());
+            if (promise.isCanceled()) {
+                process.kill();
+                process.waitForFinished(-1);
+                return;
+            }
+            for (const GitFile &file : parser.takeFiles()) {
+                if (isStagedFile(file.mode)) {
+                    result.stagedList.append(file);
+                } else {
+                    result.unstagedList.append(file);
+                }
+            }
+        }
+        process.waitForFinished(-1);
+        if (process.error() == QProcess::FailedToStart ||
+            process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+            result.error = QString::fromLocal8Bit(process.readAllStandardError()).trimmed();
+            if (result.error.isEmpty()) {
+                result.error = "git status failed: " + process.errorString();
+            }
+            promise.addResult(result);
+            return;
+        }
+
+        if (paths.isEmpty()) {
+            result.diffConfig = git::readDiffConfig(projectPath);
+        }
+        promise.addResult(result);
+    });
+    m_statusWorker.then(this, [this](const StatusResult &result) {
+        onStatusResult(result);
+    });
+}
+
+void ProjectData::onStatusResult(const StatusResult &result)
+{
+    if (!result.error.isEmpty()) {
+        // What was listed stays, a failed status is not a clean tree
+        qWarning() << "Status of" << m_projectPath << "failed:" << result.error;
+        emit statusFailed(result.error);
+        return;
+    }
+    ++m_statusGeneration;
+    if (result.paths.isEmpty()) {
+        m_status.unstagedList = result.unstagedList;
+        m_status.stagedList = result.stagedList;
+        if (!(m_status.diffConfig == result.diffConfig)) {
+            m_diffCache->clear();
+        }
+        m_status.diffConfig = result.diffConfig;
+        m_statusLoaded = true;
+        QSet<QString> changedPaths;
+        for (const GitFile &file : m_status.stagedList + m_status.unstagedList) {
+            changedPaths.insert(file.path);
+        }
+        m_diffCache->retain(changedPaths);
+        emit statusChanged({});
+    } else {
+        mergeStatus(result);
+    }
+    // Changes seen while this status ran
+    if (m_fileOpsRunning == 0) {
+        applyPendingChanges();
+    }
+}
+
+void ProjectData::mergeStatus(const StatusResult &result)
+{
+    auto merge = [&result](QList<GitFile> &list, const QList<GitFile> &updates) {
+        list.removeIf([&result](const GitFile &f) {
+            return global::isInPaths(f.path, result.paths);
+        });
+        list.append(updates);
+        // Same order as git status, untracked files last
+        std::sort(list.begin(), list.end(), [](const GitFile &f1, const GitFile &f2) {
+            const bool untracked1 = f1.mode == "??";
+            const bool untracked2 = f2.mode == "??";
+            return untracked1 != untracked2 ? untracked2 : f1.path < f2.path;
+        });
+    };
+    merge(m_status.stagedList, result.stagedList);
+    merge(m_status.unstagedList, result.unstagedList);
+    emit statusChanged(result.paths);
+}
+
+void ProjectData::onWorkTreeChanged(const QStringList &paths, bool fullRefresh)
+{
+    // Changes of the index show up as new blob ids in the next status
+    m_diffCache->invalidate(paths);
+    if (fullRefresh) {
+        // HEAD or the index moved, e.g. a commit from a terminal
+        {
+            QMutexLocker locker(&m_cacheMutex);
+            ++m_logGeneration;
+        }
+        refreshRefs();
+    }
+    m_pendingPaths += paths;
+    m_pendingFullRefresh |= fullRefresh;
+    // Statuses wait for file operations, which patch the lists themselves
+    if (!m_statusWorker.isRunning() && m_fileOpsRunning == 0) {
+        applyPendingChanges();
+    }
+}
+
+void ProjectData::applyPendingChanges()
+{
+    // Beyond this a pathspec status costs about as much as a full one
+    static const int maxPathspecs = 256;
+    if (m_pendingFullRefresh || m_pendingPaths.size() > maxPathspecs) {
+        refreshStatus();
+    } else if (!m_pendingPaths.isEmpty()) {
+        loadStatus(m_pendingPaths);
+    }
+}
+
+void ProjectData::precomputeDiffs(int contextLines)
+{
+    // Bigger files are slower to diff and rarely looked at one after another
+    static const qint64 maxFileSize = 1024 * 1024;
+    static const int maxFiles = 2000;
+
+    // Every page showing the project asks after each status
+    const QPair<int, int> precomputed(m_statusGeneration, contextLines);
+    if (precomputed == m_precomputed) {
+        return;
+    }
+    m_precomputed = precomputed;
+
+    m_precomputeWorker.cancel();
+    QList<QPair<GitFile, bool>> files;
+    for (const GitFile &file : m_status.stagedList) {
+        files.append({file, true});
+    }
+    for (const GitFile &file : m_status.unstagedList) {
+        files.append({file, false});
+    }
+    const QString projectPath = m_projectPath;
+    m_precomputeWorker = QtConcurrent::run(&m_precomputePool,
+        [projectPath, files, contextLines, catFile = m_catFile, config = m_status.diffConfig,
+            diffCache = m_diffCache](QPromise<void> &promise) {
+            struct Job
+            {
+                const GitFile *file;
+                bool staged;
+                qint64 size;
+            };
+            QList<Job> jobs;
+            for (const auto &[file, staged] : files) {
+                const qint64 size = QFileInfo(projectPath + "/" + file.path).size();
+                if (size <= maxFileSize) {
+                    jobs.append({&file, staged, size});
+                }
+            }
+            std::stable_sort(jobs.begin(), jobs.end(), [](const Job &j1, const Job &j2) {
+                return j1.size < j2.size;
+            });
+            if (jobs.size() > maxFiles) {
+                jobs.resize(maxFiles);
+            }
+
+            QList<DiffHunk> hunks;
+            for (const Job &job : jobs) {
+                if (promise.isCanceled()) {
+                    return;
+                }
+                const DiffCache::Key key =
+                    DiffCache::makeKey(projectPath, *job.file, job.staged, contextLines);
+                if (!key.isValid() || diffCache->find(job.file->path, key, hunks)) {
+                    continue;
+                }
+                // Only in process, files left to `git diff` are diffed when selected
+                if (git::diffFile(*catFile, config, projectPath, *job.file, job.staged,
+                        contextLines, hunks)) {
+                    diffCache->insert(job.file->path, key, hunks);
+                }
+            }
+        });
+}
+
+QFuture<git::FileOpResult> ProjectData::applyFileOp(
+    git::FileOp op, const QList<GitFile> &files, bool staged)
+{
+    ++m_fileOpsRunning;
+    // One operation at a time on the single-threaded pool, they'd fight over index.lock
+    const QString projectPath = m_projectPath;
+    return QtConcurrent::run(&m_fileOpPool,
+        [this, projectPath, op, files, staged]() {
+            return git::applyFileOp(projectPath, op, files, staged, [this]() {
+                return m_closing.load();
+            });
+        })
+        .then(this, [this](const git::FileOpResult &result) {
+            --m_fileOpsRunning;
+            // Patched in place, the status triggered by the index change only confirms it
+            if (!result.paths.isEmpty()) {
+                StatusResult changes;
+                changes.paths = result.paths;
+                changes.stagedList = result.stagedList;
+                changes.unstagedList = result.unstagedList;
+                ++m_statusGeneration;
+                mergeStatus(changes);
+            }
+            if (m_fileOpsRunning == 0 && !m_statusWorker.isRunning()) {
+                applyPendingChanges();
+            }
+            return result;
+        });
+}
+
+void ProjectData::ensureRefs()
+{
+    if (!m_refsLoaded && !m_refsWorker.isRunning()) {
+        loadRefs();
+    }
+    m_refWatcher->start();
+}
+
+bool ProjectData::isWatchingRefs() const
+{
+    return m_refWatcher->watching();
+}
+
+void ProjectData::refreshRefs()
+{
+    if (m_refsLoaded || m_refsWorker.isRunning()) {
+        loadRefs();
+    }
+}
+
+void ProjectData::withRefs(
+    QObject *context, const std::function<void(const RefSnapshot &)> &callback)
+{
+    if (m_refsLoaded) {
+        callback(*m_refs);
+        return;
+    }
+    connect(
+        this, &ProjectData::refsChanged, context,
+        [this, callback]() {
+            callback(*m_refs);
+        },
+        Qt::SingleShotConnection);
+    ensureRefs();
+}
+
+void ProjectData::loadRefs()
+{
+    if (!m_refsWorker.isRunning()) {
+        emit refsLoading(true);
+    }
+    // Rereads only when the ref files changed, the same snapshot comes back otherwise
+    m_refsWorker = QtConcurrent::run(&m_refsPool, [this]() {
+        return readRefs();
+    });
+    m_refsWorker.then(this, [this](const QSharedPointer<const RefSnapshot> &refs) {
+        if (m_refsWorker.isRunning()) {
+            return;  // A newer one is on its way
+        }
+        emit refsLoading(false);
+        const bool moved = m_refsMoved && m_refsLoaded;
+        m_refsMoved = false;
+        if (refs != m_refs) {
+            m_refs = refs;
+            m_refsLoaded = true;
+            emit refsChanged();
+            if (moved) {
+                {
+                    QMutexLocker locker(&m_cacheMutex);
+                    ++m_logGeneration;
+                }
+                emit historyChanged();
+            }
+        }
+    });
+}
+
+void ProjectData::onRefsMoved()
+{
+    m_refsMoved = true;
+    refreshRefs();
+}
+
+void ProjectData::ensureDivergences(const QString &revision)
+{
+    if (m_divergencesWanted && revision == m_divergenceRevision) {
+        return;
+    }
+    m_divergencesWanted = true;
+    m_divergenceRevision = revision;
+    ensureRefs();
+    countDivergences();
+}
+
+// Commit of what an upstream or a revision names, a commit names itself
+static QString tipOf(const RefSnapshot &refs, const QString &name)
+{
+    if (const RefSnapshot::Ref *ref = refs.find(RefSnapshot::Remote, name)) {
+        return ref->oid;
+    }
+    if (const RefSnapshot::Ref *ref = refs.find(RefSnapshot::Branch, name)) {
+        return ref->oid;
+    }
+    return RefReader::isOid(name.toLatin1()) ? name : QString();
+}
+
+void ProjectData::countDivergences()
+{
+    // A chunk at a time, the counts show up as they come
+    static const int chunkSize = 32;
+    if (!m_divergencesWanted || !m_refsLoaded || m_divergenceWorker.isRunning()) {
+        return;
+    }
+
+    const RefSnapshot &refs = *m_refs;
+    const QString revisionTip = tipOf(refs, m_divergenceRevision);
+    QHash<QString, BranchDivergence> divergences;
+    QSet<TipPair> livePairs;
+    QList<DivergenceJob> jobs;
+    auto lookUp = [&](const RefSnapshot::Ref &branch, const QString &tip, Divergence &divergence) {
+        if (tip.isEmpty()) {
+            return;
+        }
+        const TipPair pair(branch.oid, tip);
+        livePairs.insert(pair);
+        auto it = m_divergenceCache.constFind(pair);
+        if (it != m_divergenceCache.cend()) {
+            divergence = *it;
+        } else if (jobs.size() < chunkSize) {
+            jobs.append({branch.name, pair});
+        }
+    };
+    for (const RefSnapshot::Ref &branch : refs.refs[RefSnapshot::Branch]) {
+        BranchDivergence &divergence = divergences[branch.name];
+        const QString upstreamTip = tipOf(refs, branch.upstream);
+        divergence.upstream = branch.upstream;
+        divergence.atRevision = !upstreamTip.isEmpty() && upstreamTip == revisionTip;
+        lookUp(branch, upstreamTip, divergence.toUpstream);
+        if (divergence.atRevision) {
+            divergence.toRevision = divergence.toUpstream;
+        } else {
+            lookUp(branch, revisionTip, divergence.toRevision);
+        }
+    }
+    // Drops the counts of tips no branch is at any more
+    if (m_divergenceCache.size() > 2 * livePairs.size() + 64) {
+        for (auto it = m_divergenceCache.begin(); it != m_divergenceCache.end();) {
+            it = livePairs.contains(it.key()) ? std::next(it) : m_divergenceCache.erase(it);
+        }
+    }
+    m_divergences = divergences;
+    emit divergencesChanged();
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    m_divergenceWorker =
+        QtConcurrent::run(&m_divergencePool, &ProjectData::readDivergences, m_projectPath, jobs);
+    m_divergenceWorker.then(this, [this](const QList<QPair<TipPair, Divergence>> &counts) {
+        for (const auto &[pair, divergence] : counts) {
+            m_divergenceCache.insert(pair, divergence);
+        }
+        countDivergences();
+    });
+}
+
+QList<QPair<ProjectData::TipPair, ProjectData::Divergence>> ProjectData::readDivergences(
+    const QString &projectPath, const QList<DivergenceJob> &jobs)
+{
+    auto runGit = [&projectPath](const QStringList &args, QByteArray &output) {
+        QProcess process;
+        process.setWorkingDirectory(projectPath);
+        process.start("git", args, QIODeviceBase::ReadOnly);
+        if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit ||
+            process.exitCode() != 0) {
+            return false;
+        }
+        output = process.readAllStandardOutput();
+        return true;
+    };
+    auto toDivergence = [](const QByteArray &ahead, const QByteArray &behind) {
+        bool aheadOk = false;
+        bool behindOk = false;
+        Divergence divergence{ahead.toInt(&aheadOk), behind.toInt(&behindOk)};
+        return aheadOk && behindOk ? divergence : Divergence();
+    };
+
+    // The branches compared with the same tip are counted by one for-each-ref, with git 2.41
+    // and later
+    QList<Divergence> results(jobs.size());
+    QHash<QString, QList<int>> jobsByTip;
+    for (int i = 0; i < jobs.size(); ++i) {
+        jobsByTip[jobs[i].pair.second] << i;
+    }
+    for (auto it = jobsByTip.cbegin(); it != jobsByTip.cend(); ++it) {
+        QStringList args = {
+            "for-each-ref", "--format=%(objectname) %(ahead-behind:" + it.key() + ") %(refname)"};
+        for (int i : *it) {
+            args << "refs/heads/" + jobs[i].branch;
+        }
+        QByteArray output;
+        if (!runGit(args, output)) {
+            continue;
+        }
+        QHash<QString, QList<QByteArray>> fieldsByRef;
+        for (const QByteArray &line : output.split('\n')) {
+            const QList<QByteArray> fields = line.split(' ');
+            if (fields.size() == 4) {
+                fieldsByRef.insert(QString::fromUtf8(fields[3]), fields);
+            }
+        }
+        for (int i : *it) {
+            const QList<QByteArray> fields = fieldsByRef.value("refs/heads/" + jobs[i].branch);
+            // Not if the branch moved since the job was made
+            if (fields.size() == 4 && fields[0] == jobs[i].pair.first.toLatin1()) {
+                results[i] = toDivergence(fields[1], fields[2]);
+            }
+        }
+    }
+
+    QList<QPair<TipPair, Divergence>> counts;
+    for (int i = 0; i < jobs.size(); ++i) {
+        const TipPair &pair = jobs[i].pair;
+        QByteArray output;
+        if (!results[i].isValid() &&
+            runGit({"rev-list", "--left-right", "--count", pair.first + "..." + pair.second},
+                output)) {
+            const QList<QByteArray> fields = output.trimmed().split('\t');
+            if (fields.size() == 2) {
+                results[i] = toDivergence(fields[0], fields[1]);
+            }
+        }
+        counts.append({pair, results[i]});
+    }
+    return counts;
+}
+
+QSharedPointer<const RefSnapshot> ProjectData::readRefs()
+{
+    const RefIndex::Stamp stamp = RefIndex::readStamp(m_projectPath);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (m_latestRefs && m_latestRefs->isValid() && m_latestRefs->stamp == stamp) {
+            return m_latestRefs;
+        }
+    }
+    return m_refsFlight.run(0, [this]() {
+        QSharedPointer<const RefSnapshot> previous;
+        {
+            QMutexLocker locker(&m_cacheMutex);
+            previous = m_latestRefs;
+        }
+        QSharedPointer<const RefSnapshot> refs(new RefSnapshot(
+            RefSnapshot::read(m_projectPath, m_catFile.data(), previous.data())));
+        QMutexLocker locker(&m_cacheMutex);
+        m_latestRefs = refs;
+        return refs;
+    });
+}
+
+QList<Commit> ProjectData::readLog(const LogKey &key)
+{
+    // Decorated when read, so the cached log doesn't go stale with the refs
+    const QSharedPointer<const RefSnapshot> refs = readRefs();
+    auto decorate = [&refs](QList<Commit> commits) {
+        for (Commit &commit : commits) {
+            refs->decorate(commit);
+        }
+        return commits;
+    };
+
+    int generation;
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        generation = m_logGeneration;
+        if (const LogEntry *entry = m_logCache.object(key)) {
+            if (entry->generation == generation) {
+                return decorate(entry->commits);
+            }
+        }
+    }
+
+    return decorate(m_logFlight.run({key, generation}, [this, &key, generation]() {
+        QList<Commit> commits;
+        QString cmdResult = global::getCmdResult(
+            QString("git log --skip=%1 --max-count=%2%3%4%5 --branches --tags "
+                    "--full-history --format=%H¿%h¿%P¿%ci¿%cn¿%ce¿%ai¿%an¿%ae¿%s HEAD")
+                .arg(QString::number(key.skip), QString::number(key.maxCount),
+                    key.orderType ? " --topo-order" : " --date-order",
+                    key.branchType ? " --branches" : "", key.showRemotes ? " --remotes" : ""),
+            m_projectPath);
+        QStringList lines = cmdResult.split('\n');
+        for (const QString &line : std::as_const(lines)) {
+            if (line.startsWith("fatal:") || line.startsWith("error:")) {
+                qDebug() << "readLog()" << line;
+                return QList<Commit>();
+            }
+            if (line.isEmpty()) {
+                continue;
+            }
+            QStringList parts = line.split("¿");
+            Commit &c = commits.emplaceBack();
+            c.hash = parts.at(0);
+            c.shortHash = parts.at(1);
+            c.parents = parts.at(2).isEmpty() ? QStringList() : parts.at(2).split(" ");
+            c.commitDate = parts.at(3);
+            c.committer = parts.at(4);
+            c.committerEmail = parts.at(5);
+            c.authorDate = parts.at(6);
+            c.author = parts.at(7);
+            c.authorEmail = parts.at(8);
+            c.isHEAD = false;
+            c.subject = parts.at(9);
+        }
+
+        QMutexLocker locker(&m_cacheMutex);
+        m_logCache.insert(key, new LogEntry{generation, commits});
+        return commits;
+    }));
+}
+
+ProjectData::CommitDetail ProjectData::readCommitDetail(const Commit &commit)
+{
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const CommitDetail *detail = m_detailCache.object(commit.hash)) {
+            return *detail;
+        }
+    }
+
+    return m_detailFlight.run(commit.hash, [this, &commit]() {
+        CommitDetail result;
+        result.rawBody =
+            global::getCmdResult("git log --format=%B -n1 " + commit.hash, m_projectPath);
+        QString cmdResult;
+        if (commit.parents.size() > 1) {
+            cmdResult = global::getCmdResult(
+                QString("git diff --name-status -M %1 %2").arg(commit.parents.first(), commit.hash),
+                m_projectPath);
+        } else {
+            cmdResult = global::getCmdResult(
+                QString("git diff-tree --name-status --no-commit-id -M -r --root %1")
+                    .arg(commit.hash),
+                m_projectPath);
+        }
+        QStringList lines = cmdResult.split('\n');
+        for (int i = 0; i < lines.size(); ++i) {
+            QString line = lines[i];
+            if (line.isEmpty()) {
+                continue;
+            }
+            QStringList parts = line.split('\t');
+            if (parts[0].startsWith("R")) {
+                result.fileList.emplaceBack(parts[2], "R");
+            } else {
+                result.fileList.emplaceBack(parts[1], parts[0]);
+            }
+        }
+
+        QMutexLocker locker(&m_cacheMutex);
+        m_detailCache.insert(commit.hash, new CommitDetail(result));
+        return result;
+    });
+}
+
+QList<DiffHunk> ProjectData::readCommitDiff(
+    const Commit &commit, const QString &path, int contextLines)
+{
+    const QString cacheKey =
+        QString("%1\n%2\n%3").arg(commit.hash, QString::number(contextLines), path);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (const QList<DiffHunk> *hunks = m_commitDiffCache.object(cacheKey)) {
+            return *hunks;
+        }
+    }
+
+    return m_commitDiffFlight.run(cacheKey, [&]() {
+        QString cmd;
+        if (commit.parents.size() > 1) {
+            cmd = QString("git diff -U%1 -M %2 %3 -- %4")
+                      .arg(QString::number(contextLines), commit.parents.first(), commit.hash,
+                          path);
+        } else {
+            cmd = QString("git diff-tree -M -p -U%1 --root %2 -- %3")
+                      .arg(QString::number(contextLines), commit.hash, path);
+        }
+        const QList<DiffHunk> hunks = parseDiffHunks(global::getCmdResult(cmd, m_projectPath));
+
+        QMutexLocker locker(&m_cacheMutex);
+        m_commitDiffCache.insert(cacheKey, new QList<DiffHunk>(hunks));
+        return hunks;
+    });
+}
+
+QList<DiffHunk> ProjectData::readWorkTreeDiff(
+    const GitFile &file, bool staged, int contextLines, const git::DiffConfig &config)
+{
+    QList<DiffHunk> hunks;
+    const DiffCache::Key key = DiffCache::makeKey(m_projectPath, file, staged, contextLines);
+    if (m_diffCache->find(file.path, key, hunks)) {
+        return hunks;
+    }
+
+    // Pages showing the same file ask for the same diff, the work tree file is in the key
+    const QString flightKey = QStringList({file.path, file.mode, QString::number(staged),
+                                              QString::number(contextLines), key.oldOid,
+                                              key.newOid, QString::number(key.mtime),
+                                              QString::number(key.size),
+                                              QString::number(key.inode)})
+                                  .join('\n');
+    return m_workTreeDiffFlight.run(flightKey, [&]() {
+        QList<DiffHunk> hunks;
+        if (git::diffFile(
+                *m_catFile, config, m_projectPath, file, staged, contextLines, hunks)) {
+            m_diffCache->insert(file.path, key, hunks);
+            return hunks;
+        }
+
+        QString cmd;
+        if (file.mode == "??") {
+            cmd = QString(R"(git diff -U%1 -- /dev/null "%2")")
+                      .arg(QString::number(contextLines), file.path);
+        } else if (staged) {
+            cmd = QString(R"(git diff -U%1 -M --cached -- "%2")")
+                      .arg(QString::number(contextLines), file.path);
+        } else {
+            cmd = QString(R"(git diff -U%1 -M -- "%2")")
+                      .arg(QString::number(contextLines), file.path);
+        }
+        hunks = parseDiffHunks(global::getCmdResult(cmd, m_projectPath));
+        m_diffCache->insert(file.path, key, hunks);
+        return hunks;
+    });
+}
@@ -0,0 +1,305 @@
+#ifndef PROJECTDATA_H
+#define PROJECTDATA_H
+
+#include <QCache>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPromise>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+
+#include "git/catfilebatch.h"
+#include "git/diffcache.h"
+#include "git/diffengine.h"
+#include "git/refsnapshot.h"
+#include "git/stagingengine.h"
+#include "global.h"
+#include "widgets/diffutils.h"
+
+class RefWatcher;
+class WorkTreeWatcher;
+
+// Runs a computation once for concurrent callers with the same key, the others wait for its
+// result. For worker threads, callers block.
+template <typename Key, typename T>
+class SingleFlight
+{
+public:
+    template <typename Compute>
+    T run(const Key &key, Compute compute)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_inFlight.constFind(key);
+        if (it != m_inFlight.cend()) {
+            QFuture<T> future = *it;
+            locker.unlock();
+            return future.result();
+        }
+        QPromise<T> promise;
+        promise.start();
+        m_inFlight.insert(key, promise.future());
+        locker.unlock();
+
+        T value = compute();
+        promise.addResult(value);
+        promise.finish();
+        locker.relock();
+        m_inFlight.remove(key);
+        return value;
+    }
+
+private:
+    QMutex m_mutex;
+    QHash<Key, QFuture<T>> m_inFlight;
+};
+
+// What the pages of a project read from git, one per project per process and shared by every
+// page showing the project, in any window. Loads are shared by whoever asks while they run, and
+// their results are pushed to every page through the signals.
+class ProjectData : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Status
+    {
+        QList<GitFile> stagedList;
+        QList<GitFile> unstagedList;
+        git::DiffConfig diffConfig;
+    };
+
+    // A page of `git log` as the history shows it
+    struct LogKey
+    {
+        int skip = 0;
+        int maxCount = 0;
+        int orderType = 0;
+        int branchType = 0;
+        bool showRemotes = false;
+
+        friend bool operator==(const LogKey &k1, const LogKey &k2) noexcept
+        {
+            return k1.skip == k2.skip && k1.maxCount == k2.maxCount &&
+                   k1.orderType == k2.orderType && k1.branchType == k2.branchType &&
+                   k1.showRemotes == k2.showRemotes;
+        }
+        friend size_t qHash(const LogKey &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(
+                seed, key.skip, key.maxCount, key.orderType, key.branchType, key.showRemotes);
+        }
+    };
+
+    struct CommitDetail
+    {
+        QString rawBody;
+        QList<GitFile> fileList;
+    };
+
+    // Commits a branch has that another one hasn't, and the other way around. -1 when unknown.
+    struct Divergence
+    {
+        int ahead = -1;
+        int behind = -1;
+
+        bool isValid() const
+        {
+            return ahead >= 0 && behind >= 0;
+        }
+    };
+
+    struct BranchDivergence
+    {
+        QString upstream;
+        Divergence toUpstream;
+        Divergence toRevision;    // The manifest revision
+        bool atRevision = false;  // The upstream is at the revision
+    };
+
+    // Alive while someone holds it
+    static QSharedPointer<ProjectData> get(const QString &projectPath);
+    ~ProjectData();
+
+    const QString &projectPath() const
+    {
+        return m_projectPath;
+    }
+    const QSharedPointer<CatFileBatch> &catFile() const
+    {
+        return m_catFile;
+    }
+    const QSharedPointer<DiffCache> &diffCache() const
+    {
+        return m_diffCache;
+    }
+
+    // Reloads the status, the refs if they changed and drops the cached history, for when git ran
+    // outside of the watched paths, e.g. a commit or a checkout
+    void refresh();
+
+    // Kept up to date by watching the work tree once loaded
+    const Status &status() const
+    {
+        return m_status;
+    }
+    bool hasStatus() const
+    {
+        return m_statusLoaded;
+    }
+    bool isStatusLoading() const
+    {
+        return m_statusWorker.isRunning();
+    }
+    bool isWatching() const;
+    // Loads the status unless it is loaded or loading
+    void ensureStatus();
+    void refreshStatus();
+    // Diffs the changed files ahead in the background, with the context of the last caller
+    void precomputeDiffs(int contextLines);
+    // One at a time, the status is patched with the result before the future finishes
+    QFuture<git::FileOpResult> applyFileOp(
+        git::FileOp op, const QList<GitFile> &files, bool staged);
+
+    static bool isStagedFile(const QString &mode);
+
+    // Empty until loaded
+    const RefSnapshot &refs() const
+    {
+        return *m_refs;
+    }
+    bool hasRefs() const
+    {
+        return m_refsLoaded;
+    }
+    bool isRefsLoading() const
+    {
+        return m_refsWorker.isRunning();
+    }
+    // Loads the refs unless they are loaded or loading, then keeps them up to date by watching
+    // the ref files
+    void ensureRefs();
+    // Rereads them when the ref files changed
+    void refreshRefs();
+    // False when the ref files can't be watched, whoever shows the refs then calls refreshRefs
+    bool isWatchingRefs() const;
+    // Calls back with the refs, right away when they are loaded
+    void withRefs(QObject *context, const std::function<void(const RefSnapshot &)> &callback);
+
+    // key:local branch, filled in as they are counted
+    const QHash<QString, BranchDivergence> &divergences() const
+    {
+        return m_divergences;
+    }
+    // Counts how far each local branch is from its upstream and from revision, e.g. origin/main,
+    // in the background, and again for the branches that moved whenever the refs change
+    void ensureDivergences(const QString &revision);
+
+    // Thread safe and blocking, for the workers of the pages. Commits are cached, the log only
+    // until the next refresh.
+    QSharedPointer<const RefSnapshot> readRefs();
+    QList<Commit> readLog(const LogKey &key);
+    CommitDetail readCommitDetail(const Commit &commit);
+    QList<DiffHunk> readCommitDiff(const Commit &commit, const QString &path, int contextLines);
+    QList<DiffHunk> readWorkTreeDiff(
+        const GitFile &file, bool staged, int contextLines, const git::DiffConfig &config);
+
+signals:
+    // A full load started, only the path updates after that follow without one
+    void statusLoading();
+    // paths are the ones updated, all of them when empty
+    void statusChanged(const QStringList &paths);
+    // git status failed, the status stays as it was
+    void statusFailed(const QString &error);
+    void refsLoading(bool loading);
+    // Only when they are different
+    void refsChanged();
+    void divergencesChanged();
+    // After refresh() or when the refs moved outside of it, e.g. a commit from a terminal. Pages
+    // showing the log reload it.
+    void historyChanged();
+
+private:
+    explicit ProjectData(const QString &projectPath);
+
+    struct StatusResult
+    {
+        QList<GitFile> unstagedList;
+        QList<GitFile> stagedList;
+        git::DiffConfig diffConfig;
+        QStringList paths;  // What the status was limited to, empty for the whole work tree
+        QString error;      // Set when git failed, the lists are empty then
+    };
+
+    struct LogEntry
+    {
+        int generation;
+        QList<Commit> commits;
+    };
+
+    QString m_projectPath;
+    QSharedPointer<CatFileBatch> m_catFile;
+    QSharedPointer<DiffCache> m_diffCache;
+    WorkTreeWatcher *m_watcher;
+
+    Status m_status;
+    bool m_statusLoaded = false;
+    QFuture<StatusResult> m_statusWorker;
+    QStringList m_pendingPaths;
+    bool m_pendingFullRefresh = false;
+    int m_fileOpsRunning = 0;
+    std::atomic<bool> m_closing = false;  // Set by the destructor, cancels the file operations
+    QThreadPool m_fileOpPool;
+    QFuture<void> m_precomputeWorker;
+    QThreadPool m_precomputePool;
+    int m_statusGeneration = 0;
+    QPair<int, int> m_precomputed{-1, -1};  // Status generation and context lines
+
+    QSharedPointer<const RefSnapshot> m_refs;  // The one the pages show
+    bool m_refsLoaded = false;
+    RefWatcher *m_refWatcher;
+    bool m_refsMoved = false;  // Reported by the watcher, the log moves with them
+    QFuture<QSharedPointer<const RefSnapshot>> m_refsWorker;  // The latest of them
+    QThreadPool m_refsPool;  // Readers read through this, the destructor waits for all of them
+
+    using TipPair = QPair<QString, QString>;  // Tip of a branch and what it is compared with
+    struct DivergenceJob
+    {
+        QString branch;
+        TipPair pair;
+    };
+    bool m_divergencesWanted = false;
+    QString m_divergenceRevision;
+    QHash<QString, BranchDivergence> m_divergences;
+    QHash<TipPair, Divergence> m_divergenceCache;  // Tips never change, neither do the counts
+    QFuture<QList<QPair<TipPair, Divergence>>> m_divergenceWorker;
+    QThreadPool m_divergencePool;
+
+    QMutex m_cacheMutex;
+    QSharedPointer<const RefSnapshot> m_latestRefs;  // Read last, by any thread
+    int m_logGeneration = 0;
+    QCache<LogKey, LogEntry> m_logCache{64};
+    QCache<QString, CommitDetail> m_detailCache{256};
+    QCache<QString, QList<DiffHunk>> m_commitDiffCache{256};
+    SingleFlight<int, QSharedPointer<const RefSnapshot>> m_refsFlight;
+    SingleFlight<QPair<LogKey, int>, QList<Commit>> m_logFlight;
+    SingleFlight<QString, CommitDetail> m_detailFlight;
+    SingleFlight<QString, QList<DiffHunk>> m_commitDiffFlight;
+    SingleFlight<QString, QList<DiffHunk>> m_workTreeDiffFlight;
+
+    void loadStatus(const QStringList &paths = QStringList());
+    void onStatusResult(const StatusResult &result);
+    void mergeStatus(const StatusResult &result);
+    void onWorkTreeChanged(const QStringList &paths, bool fullRefresh);
+    void applyPendingChanges();
+    void loadRefs();
+    void onRefsMoved();
+    void countDivergences();
+    static QList<QPair<TipPair, Divergence>> readDivergences(
+        const QString &projectPath, const QList<DivergenceJob> &jobs);
+};
+
+#endif  // PROJECTDATA_H
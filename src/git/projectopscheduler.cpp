@@ -0,0 +1,172 @@
+#include "projectopscheduler.h"
+
+#include <QProcessEnvironment>
+
+ProjectOpScheduler::ProjectOpScheduler(QObject *parent) : QObject(parent)
+{
+}
+
+ProjectOpScheduler::~ProjectOpScheduler()
+{
+    for (QProcess *process : m_processes.keys()) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished(-1);
+        delete process;
+    }
+}
+
+void ProjectOpScheduler::setConcurrency(int concurrency)
+{
+    m_concurrency = qMax(1, concurrency);
+    startQueued();
+}
+
+void ProjectOpScheduler::start(const QList<Project> &projects, const QStringList &arguments)
+{
+    if (isRunning()) {
+        return;
+    }
+    m_arguments = arguments;
+    m_tasks.clear();
+    m_log.clear();
+    for (int i = 0; i < projects.size(); ++i) {
+        Task task;
+        task.project = projects[i];
+        m_tasks.append(task);
+        m_queue.enqueue(i);
+    }
+    startQueued();
+    if (!isRunning()) {
+        emit finished();
+    }
+}
+
+void ProjectOpScheduler::retryFailed()
+{
+    if (isRunning()) {
+        return;
+    }
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        Task &task = m_tasks[i];
+        if (task.state == Failed || task.state == Canceled) {
+            task.state = Queued;
+            task.output.clear();
+            m_queue.enqueue(i);
+            emit taskChanged(i);
+        }
+    }
+    startQueued();
+}
+
+void ProjectOpScheduler::cancel()
+{
+    while (!m_queue.isEmpty()) {
+        const int index = m_queue.dequeue();
+        m_tasks[index].state = Canceled;
+        emit taskChanged(index);
+    }
+    for (auto it = m_processes.cbegin(); it != m_processes.cend(); ++it) {
+        m_tasks[it->index].state = Canceled;
+        it.key()->kill();
+    }
+}
+
+QString ProjectOpScheduler::stateName(State state)
+{
+    switch (state) {
+        case Queued:
+            return "Queued";
+        case Running:
+            return "Running";
+        case Succeeded:
+            return "Done";
+        case Failed:
+            return "Failed";
+        case Canceled:
+            return "Canceled";
+    }
+    return QString();
+}
+
+void ProjectOpScheduler::startQueued()
+{
+    // Nobody can answer a credential prompt without a terminal
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("GIT_TERMINAL_PROMPT", "0");
+
+    while (m_processes.size() < m_concurrency && !m_queue.isEmpty()) {
+        const int index = m_queue.dequeue();
+        Task &task = m_tasks[index];
+        task.state = Running;
+
+        auto process = new QProcess(this);
+        process->setWorkingDirectory(task.project.absPath);
+        process->setProcessEnvironment(env);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        connect(process, &QProcess::readyRead, this, [this, process]() {
+            auto it = m_processes.constFind(process);
+            if (it != m_processes.cend()) {
+                m_tasks[it->index].output.append(QString::fromLocal8Bit(process->readAll()));
+            }
+        });
+        connect(process, &QProcess::finished, this, [this, process]() {
+            onProcessFinished(process);
+        });
+        connect(process, &QProcess::errorOccurred, this,
+            [this, process](QProcess::ProcessError error) {
+                if (error == QProcess::FailedToStart) {
+                    onProcessFinished(process);
+                }
+            });
+        m_processes.insert(process, {index, QElapsedTimer()});
+        m_processes[process].timer.start();
+        process->start("git", m_arguments, QIODeviceBase::ReadOnly);
+        emit taskChanged(index);
+    }
+}
+
+void ProjectOpScheduler::onProcessFinished(QProcess *process)
+{
+    auto it = m_processes.find(process);
+    if (it == m_processes.end()) {
+        return;
+    }
+    const int index = it->index;
+    Task &task = m_tasks[index];
+    task.elapsedMs = it->timer.elapsed();
+    task.output.append(QString::fromLocal8Bit(process->readAll()));
+    m_processes.erase(it);
+    process->deleteLater();
+
+    if (task.state == Canceled) {
+        task.exitCode = -1;
+    } else if (process->error() == QProcess::FailedToStart) {
+        task.state = Failed;
+        task.exitCode = -2;
+        task.output.append(process->errorString());
+    } else if (process->exitStatus() != QProcess::NormalExit) {
+        task.state = Failed;
+        task.exitCode = -1;
+    } else {
+        task.exitCode = process->exitCode();
+        task.state = task.exitCode == 0 ? Succeeded : Failed;
+    }
+    emit taskChanged(index);
+
+    QString block = QString("== %1: %2").arg(task.project.path, stateName(task.state));
+    if (task.state == Failed) {
+        block += QString(" (%1)").arg(task.exitCode);
+    }
+    block += QString(", %1 s\n").arg(task.elapsedMs / 1000.0, 0, 'f', 1);
+    if (!task.output.isEmpty()) {
+        block += task.output.endsWith('\n') ? task.output : task.output + "\n";
+    }
+    m_log += block;
+    emit logAppended(block);
+
+    startQueued();
+    if (!isRunning()) {
+        emit finished();
+    }
+}
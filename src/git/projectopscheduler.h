@@ -0,0 +1,81 @@
+#ifndef PROJECTOPSCHEDULER_H
+#define PROJECTOPSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+
+#include "repocontext.h"
+
+// Runs the same git command in many projects, a limited number at a time. Output is collected
+// per project and appended to the log as a block once the project is done.
+class ProjectOpScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State
+    {
+        Queued,
+        Running,
+        Succeeded,
+        Failed,
+        Canceled,
+    };
+
+    struct Task
+    {
+        Project project;
+        State state = Queued;
+        int exitCode = 0;
+        qint64 elapsedMs = 0;
+        QString output;
+    };
+
+    explicit ProjectOpScheduler(QObject *parent = nullptr);
+    ~ProjectOpScheduler();
+
+    void setConcurrency(int concurrency);
+    // Replaces the tasks, arguments are passed to git in each project
+    void start(const QList<Project> &projects, const QStringList &arguments);
+    void retryFailed();
+    void cancel();
+    bool isRunning() const
+    {
+        return !m_processes.isEmpty() || !m_queue.isEmpty();
+    }
+    const QList<Task> &tasks() const
+    {
+        return m_tasks;
+    }
+    QString log() const
+    {
+        return m_log;
+    }
+
+    static QString stateName(State state);
+
+signals:
+    void taskChanged(int index);
+    void logAppended(const QString &text);
+    void finished();
+
+private:
+    void startQueued();
+    void onProcessFinished(QProcess *process);
+
+    QList<Task> m_tasks;
+    QStringList m_arguments;
+    int m_concurrency = 1;
+    QQueue<int> m_queue;
+    struct RunningTask
+    {
+        int index;
+        QElapsedTimer timer;
+    };
+    QHash<QProcess *, RunningTask> m_processes;
+    QString m_log;
+};
+
+#endif  // PROJECTOPSCHEDULER_H
@@ -0,0 +1,97 @@
+#include "projectstatus.h"
+
+#include <QFile>
+
+#include "git/refreader.h"
+#include "git/statusparser.h"
+#include "global.h"
+
+ProjectStatus::Stamp ProjectStatus::readStamp(const QString &projectPath)
+{
+    // .git is a file pointing elsewhere in projects checked out by newer repo versions
+    const QString gitDir = RefReader(projectPath).gitDir();
+    Stamp stamp;
+    stamp.index = global::statFile(gitDir + "/index").mtime;
+    stamp.head = global::statFile(gitDir + "/HEAD").mtime;
+    return stamp;
+}
+
+QString ProjectStatus::revisionRef(const QString &remote, const QString &revision)
+{
+    QString revisionName = revision;
+    if (revisionName.startsWith("refs/heads/")) {
+        revisionName.remove(0, 11);
+    }
+    // Commits, tags and other full refs such as refs/changes/... are no remote branches
+    if (revisionName.isEmpty() || revisionName.startsWith("refs/") ||
+        RefReader::isOid(revisionName.toLatin1())) {
+        return revisionName;
+    }
+    return remote + "/" + revisionName;
+}
+
+ProjectStatus ProjectStatus::read(
+    const QString &projectPath, const QString &remote, const QString &revision)
+{
+    ProjectStatus status;
+    status.stamp = readStamp(projectPath);
+    if (!status.stamp.isValid()) {
+        return status;
+    }
+
+    // Untracked directories count once, walking into them is what makes status slow
+    const QByteArray output = global::getCmdOutput("git",
+        {"--no-optional-locks", "status", "--porcelain=v2", "--branch", "-z",
+            "--untracked-files=normal"},
+        projectPath);
+    bool hasAheadBehind = false;
+    for (const QByteArray &record : output.split('\0')) {
+        if (record.startsWith("# branch.oid ")) {
+            status.valid = true;
+        } else if (record.startsWith("# branch.head ")) {
+            const QString head = QString::fromUtf8(record.mid(14));
+            status.branch = head == "(detached)" ? QString() : head;
+        } else if (record.startsWith("# branch.upstream ")) {
+            status.upstream = QString::fromUtf8(record.mid(18));
+        } else if (record.startsWith("# branch.ab ")) {
+            // # branch.ab +<ahead> -<behind>
+            const QList<QByteArray> counts = record.mid(12).split(' ');
+            if (counts.size() == 2) {
+                status.ahead = counts[0].mid(1).toInt();
+                status.behind = counts[1].mid(1).toInt();
+                hasAheadBehind = true;
+            }
+        }
+    }
+    if (!status.valid) {
+        return status;
+    }
+    StatusParser parser;
+    parser.feed(output);
+    status.changes = parser.takeFiles().size();
+
+    // A branch should track the remote branch the manifest names, a pinned project's revision
+    // is no branch to track
+    const QString target = revisionRef(remote, revision);
+    if (!status.upstream.isEmpty() && target.startsWith(remote + "/")) {
+        status.offRevision = status.upstream != target;
+    }
+
+    // Detached, as left by repo sync, or a branch without upstream
+    if (!hasAheadBehind && !target.isEmpty()) {
+        const QByteArray revList = global::getCmdOutput(
+            "git", {"rev-list", "--left-right", "--count", "HEAD..." + target}, projectPath);
+        const QList<QByteArray> counts = revList.trimmed().split('\t');
+        bool aheadOk = false;
+        bool behindOk = false;
+        if (counts.size() == 2) {
+            status.ahead = counts[0].toInt(&aheadOk);
+            status.behind = counts[1].toInt(&behindOk);
+        }
+        if (!aheadOk || !behindOk) {
+            status.ahead = -1;
+            status.behind = -1;
+        }
+    }
+    return status;
+}
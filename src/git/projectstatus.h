@@ -0,0 +1,43 @@
+#ifndef PROJECTSTATUS_H
+#define PROJECTSTATUS_H
+
+#include <QString>
+
+// Summary of a project's work tree and branch, for listing many projects at once
+struct ProjectStatus
+{
+    // Modification times of .git/index and .git/HEAD, the status is kept while they are the same
+    struct Stamp
+    {
+        qint64 index = 0;
+        qint64 head = 0;
+
+        bool isValid() const
+        {
+            return head != 0;
+        }
+        friend bool operator==(const Stamp &s1, const Stamp &s2) noexcept
+        {
+            return s1.index == s2.index && s1.head == s2.head;
+        }
+    };
+
+    Stamp stamp;
+    bool valid = false;  // False when the project is not checked out
+    QString branch;      // Empty when detached
+    QString upstream;
+    int changes = -1;
+    // Against the upstream, or the manifest revision when there is none. -1 when unknown.
+    int ahead = -1;
+    int behind = -1;
+    bool offRevision = false;  // The branch tracks something else than the manifest revision
+
+    static Stamp readStamp(const QString &projectPath);
+    // What a manifest revision is in the remote's branches, e.g. origin/main, or the revision
+    // itself when it is a commit or a full ref like refs/tags/v1
+    static QString revisionRef(const QString &remote, const QString &revision);
+    static ProjectStatus read(
+        const QString &projectPath, const QString &remote, const QString &revision);
+};
+
+#endif  // PROJECTSTATUS_H
@@ -0,0 +1,324 @@
+#include "refindex.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "git/refreader.h"
+#include "global.h"
+
+static const quint32 indexMagic = 0x524d5249;  // "RMRI"
+static const quint32 indexVersion = 1;
+
+namespace {
+    struct NamedRef
+    {
+        QString name;
+        QByteArray oid;
+        QByteArray peeled;
+    };
+}
+
+static bool isHex(const QByteArray &data)
+{
+    return std::all_of(data.cbegin(), data.cend(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+static QList<NamedRef> readRefs(const QString &projectPath)
+{
+    const RefReader reader(projectPath);
+    QList<NamedRef> refs;
+    for (const RefReader::Ref &ref : reader.readAll()) {
+        // Symbolic refs like refs/remotes/origin/HEAD
+        if (ref.symref.isEmpty()) {
+            refs.append({ref.name, ref.oid, ref.peeled});
+        }
+    }
+    const QByteArray head = reader.resolve("HEAD");
+    if (!head.isEmpty()) {
+        refs.append({"HEAD", head, {}});
+    }
+    return refs;
+}
+
+QByteArray RefIndex::readHead(const QString &projectPath)
+{
+    return RefReader(projectPath).resolve("HEAD");
+}
+
+RefIndex::Stamp RefIndex::readStamp(const QString &projectPath)
+{
+    const RefReader reader(projectPath);
+    const QString &git = reader.gitDir();
+    const QString &common = reader.commonDir();
+    // Refs are replaced by renaming a lock file, which touches the directory
+    Stamp stamp;
+    stamp.mtime = qMax(
+        global::statFile(git + "/HEAD").mtime, global::statFile(common + "/packed-refs").mtime);
+    stamp.mtime = qMax(stamp.mtime, global::statFile(common + "/refs").mtime);
+    QDirIterator it(common + "/refs", QDir::Dirs | QDir::NoDotAndDotDot,
+        QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        stamp.mtime = qMax(stamp.mtime, global::statFile(it.next()).mtime);
+        ++stamp.dirs;
+    }
+    return stamp;
+}
+
+int RefIndex::update(const QList<Project> &projects, QThreadPool *pool)
+{
+    struct Job
+    {
+        QString absPath;
+        bool indexed;
+        Stamp stamp;  // Of the indexed refs
+    };
+    struct Result
+    {
+        bool reread;
+        Stamp stamp;
+        QList<NamedRef> refs;
+    };
+
+    QHash<QString, int> oldProjects;
+    for (int i = 0; i < m_projects.size(); ++i) {
+        oldProjects.insert(m_projects[i].path, i);
+    }
+    QList<Job> jobs;
+    jobs.reserve(projects.size());
+    for (const Project &project : projects) {
+        const int old = oldProjects.value(project.path, -1);
+        jobs.append({project.absPath, old >= 0, old < 0 ? Stamp() : m_projects[old].stamp});
+    }
+
+    const QList<Result> results =
+        QtConcurrent::blockingMapped<QList<Result>>(pool, jobs, [](const Job &job) {
+            const Stamp stamp = readStamp(job.absPath);
+            if (job.indexed && stamp == job.stamp) {
+                return Result{false, stamp, {}};
+            }
+            if (!stamp.isValid()) {
+                return Result{true, stamp, {}};  // Not checked out
+            }
+            return Result{true, stamp, readRefs(job.absPath)};
+        });
+
+    // Names are collected again so that the ones no project has any more are dropped
+    QStringList names;
+    QHash<QString, quint32> nameIds;
+    auto nameId = [&names, &nameIds](const QString &name) {
+        auto it = nameIds.constFind(name);
+        if (it != nameIds.cend()) {
+            return *it;
+        }
+        names.append(name);
+        return *nameIds.insert(name, names.size() - 1);
+    };
+
+    int reread = 0;
+    QList<ProjectRefs> newProjects;
+    newProjects.reserve(projects.size());
+    for (int i = 0; i < projects.size(); ++i) {
+        const Result &result = results[i];
+        ProjectRefs entry;
+        entry.path = projects[i].path;
+        entry.stamp = result.stamp;
+        if (result.reread) {
+            ++reread;
+            for (const NamedRef &ref : result.refs) {
+                entry.refs.append({nameId(ref.name), ref.oid, ref.peeled});
+            }
+        } else {
+            entry.refs = m_projects[oldProjects.value(entry.path)].refs;
+            for (Ref &ref : entry.refs) {
+                ref.name = nameId(m_names[ref.name]);
+            }
+        }
+        newProjects.append(entry);
+    }
+    m_names = names;
+    m_projects = newProjects;
+    buildIndex();
+    return reread;
+}
+
+void RefIndex::buildIndex()
+{
+    m_shortNames.clear();
+    m_branchNames.clear();
+    for (const QString &name : std::as_const(m_names)) {
+        QString shortName = name;
+        QString branchName;
+        if (name.startsWith("refs/heads/") || name.startsWith("refs/tags/")) {
+            shortName = name.section('/', 2);
+        } else if (name.startsWith("refs/remotes/")) {
+            shortName = name.section('/', 2);
+            branchName = name.section('/', 3);
+        }
+        m_shortNames.append(shortName);
+        m_branchNames.append(branchName);
+    }
+
+    m_nameIndex = QList<QList<Posting>>(m_names.size());
+    m_oidIndex.clear();
+    m_refCount = 0;
+    for (int p = 0; p < m_projects.size(); ++p) {
+        const QList<Ref> &refs = m_projects[p].refs;
+        for (int r = 0; r < refs.size(); ++r) {
+            m_nameIndex[refs[r].name].append({p, r});
+            m_oidIndex.push_back({refs[r].oid, {p, r}});
+            if (!refs[r].peeled.isEmpty()) {
+                m_oidIndex.push_back({refs[r].peeled, {p, r}});
+            }
+        }
+        m_refCount += refs.size();
+    }
+    std::sort(m_oidIndex.begin(), m_oidIndex.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+    });
+}
+
+void RefIndex::addMatch(QList<Match> &matches, const Posting &posting) const
+{
+    const ProjectRefs &project = m_projects[posting.project];
+    const Ref &ref = project.refs[posting.ref];
+    matches.append(
+        {project.path, m_names[ref.name], ref.peeled.isEmpty() ? ref.oid : ref.peeled});
+}
+
+QList<RefIndex::Match> RefIndex::find(const QString &query, int limit) const
+{
+    QList<Match> matches;
+    const QString text = query.trimmed();
+    if (text.isEmpty()) {
+        return matches;
+    }
+
+    QSet<quint64> found;
+    auto add = [this, &matches, &found, limit](const Posting &posting) {
+        if (matches.size() < limit &&
+            !found.contains(quint64(posting.project) << 32 | quint32(posting.ref))) {
+            found.insert(quint64(posting.project) << 32 | quint32(posting.ref));
+            addMatch(matches, posting);
+        }
+    };
+
+    QList<int> partial;
+    for (int i = 0; i < m_names.size(); ++i) {
+        if (m_names[i] == text || m_shortNames[i] == text || m_branchNames[i] == text) {
+            for (const Posting &posting : m_nameIndex[i]) {
+                add(posting);
+            }
+        } else if (m_shortNames[i].contains(text, Qt::CaseInsensitive)) {
+            partial.append(i);
+        }
+    }
+
+    const QByteArray prefix = text.toLatin1().toLower();
+    if (prefix.size() >= 4 && isHex(prefix)) {
+        auto it = std::lower_bound(m_oidIndex.cbegin(), m_oidIndex.cend(), prefix,
+            [](const auto &entry, const QByteArray &value) {
+                return entry.first < value;
+            });
+        for (; it != m_oidIndex.cend() && it->first.startsWith(prefix); ++it) {
+            add(it->second);
+        }
+    }
+
+    for (int i : std::as_const(partial)) {
+        for (const Posting &posting : m_nameIndex[i]) {
+            add(posting);
+        }
+    }
+    return matches;
+}
+
+static void writeOid(QDataStream &out, const QByteArray &oid)
+{
+    const QByteArray raw = QByteArray::fromHex(oid);
+    out << quint8(raw.size());
+    out.writeRawData(raw.constData(), raw.size());
+}
+
+static QByteArray readOid(QDataStream &in)
+{
+    quint8 size = 0;
+    in >> size;
+    QByteArray raw(size, Qt::Uninitialized);
+    in.readRawData(raw.data(), size);
+    return raw.toHex();
+}
+
+bool RefIndex::save(const QString &filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    // Names once, oids as raw bytes
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << indexMagic << indexVersion << m_names << quint32(m_projects.size());
+    for (const ProjectRefs &project : m_projects) {
+        out << project.path << project.stamp.mtime << qint32(project.stamp.dirs)
+            << quint32(project.refs.size());
+        for (const Ref &ref : project.refs) {
+            out << ref.name;
+            writeOid(out, ref.oid);
+            writeOid(out, ref.peeled);
+        }
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool RefIndex::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != indexMagic || version != indexVersion) {
+        return false;
+    }
+
+    QStringList names;
+    quint32 projectCount = 0;
+    in >> names >> projectCount;
+    QList<ProjectRefs> projects;
+    for (quint32 i = 0; i < projectCount && in.status() == QDataStream::Ok; ++i) {
+        ProjectRefs project;
+        qint32 dirs = 0;
+        quint32 refCount = 0;
+        in >> project.path >> project.stamp.mtime >> dirs >> refCount;
+        project.stamp.dirs = dirs;
+        for (quint32 j = 0; j < refCount && in.status() == QDataStream::Ok; ++j) {
+            Ref ref;
+            in >> ref.name;
+            ref.oid = readOid(in);
+            ref.peeled = readOid(in);
+            if (ref.name >= quint32(names.size())) {
+                return false;
+            }
+            project.refs.append(ref);
+        }
+        projects.append(project);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    m_names = names;
+    m_projects = projects;
+    buildIndex();
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef REFINDEX_H
+#define REFINDEX_H
+
+#include <QHash>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+#include <vector>
+
+#include "repocontext.h"
+
+// Branches, tags and HEAD of every project, read from the ref files without running git. Kept in
+// a file between runs and only reread for projects whose ref files changed.
+class RefIndex
+{
+public:
+    struct Stamp
+    {
+        qint64 mtime = 0;  // Newest of HEAD, packed-refs and the directories under refs/
+        int dirs = 0;
+
+        bool isValid() const
+        {
+            return mtime > 0;
+        }
+        bool operator==(const Stamp &other) const
+        {
+            return mtime == other.mtime && dirs == other.dirs;
+        }
+    };
+
+    struct Ref
+    {
+        quint32 name;       // Into names()
+        QByteArray oid;     // Hex
+        QByteArray peeled;  // Commit of an annotated tag, hex
+    };
+
+    struct ProjectRefs
+    {
+        QString path;
+        Stamp stamp;
+        QList<Ref> refs;
+    };
+
+    struct Match
+    {
+        QString projectPath;
+        QString refName;
+        QByteArray oid;  // The commit, peeled for annotated tags
+    };
+
+    bool load(const QString &filePath);
+    bool save(const QString &filePath) const;
+
+    // Rereads the projects whose refs changed and drops the ones no longer in the list.
+    // Returns the number of projects reread.
+    int update(const QList<Project> &projects, QThreadPool *pool);
+
+    // Refs whose name or short name is the query, then refs whose commit starts with it, then
+    // refs whose name contains it
+    QList<Match> find(const QString &query, int limit) const;
+
+    int projectCount() const
+    {
+        return m_projects.size();
+    }
+    int refCount() const
+    {
+        return m_refCount;
+    }
+
+    static Stamp readStamp(const QString &projectPath);
+    // The commit checked out, empty when the project has none
+    static QByteArray readHead(const QString &projectPath);
+
+private:
+    struct Posting
+    {
+        int project;
+        int ref;
+    };
+
+    QStringList m_names;
+    QList<ProjectRefs> m_projects;
+
+    // Rebuilt after load and update
+    QStringList m_shortNames;   // Without refs/heads/, refs/tags/ or refs/remotes/
+    QStringList m_branchNames;  // Of remote branches, without the remote
+    QList<QList<Posting>> m_nameIndex;                        // By name
+    std::vector<std::pair<QByteArray, Posting>> m_oidIndex;  // Sorted by oid
+    int m_refCount = 0;
+
+    void buildIndex();
+    void addMatch(QList<Match> &matches, const Posting &posting) const;
+};
+
+#endif  // REFINDEX_H
@@ -0,0 +1,298 @@
+#include "refreader.h"
+
+#include <QByteArrayMatcher>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <algorithm>
+
+#include <string.h>
+
+// Like git, which gives up on deeper chains of symbolic refs
+static const int maxSymrefDepth = 5;
+
+namespace {
+    // packed-refs mapped into memory instead of read, it can be megabytes of tags
+    class PackedRefs
+    {
+    public:
+        explicit PackedRefs(const QString &path) : m_file(path)
+        {
+            if (m_file.open(QIODevice::ReadOnly) && m_file.size() > 0) {
+                m_data = reinterpret_cast<const char *>(m_file.map(0, m_file.size()));
+                m_size = m_data ? m_file.size() : 0;
+            }
+        }
+
+        const char *data() const
+        {
+            return m_data;
+        }
+        qint64 size() const
+        {
+            return m_size;
+        }
+
+        // Calls visit with every line but the trailing newline
+        template <typename Visit>
+        void forEachLine(Visit visit) const
+        {
+            const char *p = m_data;
+            const char *end = m_data + m_size;
+            while (p < end) {
+                const char *newline = static_cast<const char *>(memchr(p, '\n', end - p));
+                const char *lineEnd = newline ? newline : end;
+                visit(QByteArrayView(p, lineEnd - p));
+                p = lineEnd + 1;
+            }
+        }
+
+    private:
+        QFile m_file;
+        const char *m_data = nullptr;
+        qint64 m_size = 0;
+    };
+
+    bool startsWith(QByteArrayView data, QByteArrayView prefix)
+    {
+        return data.size() >= prefix.size() &&
+               memcmp(data.data(), prefix.data(), prefix.size()) == 0;
+    }
+
+    // Content of a loose ref or HEAD, an oid or "ref: <name>"
+    QByteArray readRefFile(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+        return file.read(1024).trimmed();
+    }
+}  // namespace
+
+RefReader::RefReader(const QString &projectPath)
+{
+    // Projects checked out by newer repo versions have a .git file pointing to the real directory
+    m_gitDir = projectPath + "/.git";
+    QFile file(m_gitDir);
+    if (QFileInfo(m_gitDir).isFile() && file.open(QIODevice::ReadOnly)) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.startsWith("gitdir: ")) {
+            const QString dir = QString::fromUtf8(line.mid(8));
+            m_gitDir = QDir::cleanPath(QDir(projectPath).absoluteFilePath(dir));
+        }
+    }
+
+    m_commonDir = m_gitDir;
+    QFile commonDirFile(m_gitDir + "/commondir");
+    if (commonDirFile.open(QIODevice::ReadOnly)) {
+        const QString dir = QString::fromUtf8(commonDirFile.readAll().trimmed());
+        m_commonDir = QDir::cleanPath(QDir(m_gitDir).absoluteFilePath(dir));
+    }
+}
+
+bool RefReader::isReadable() const
+{
+    return !QFileInfo::exists(m_commonDir + "/reftable");
+}
+
+bool RefReader::isOid(QByteArrayView data)
+{
+    return (data.size() == 40 || data.size() == 64) &&
+           std::all_of(data.begin(), data.end(), [](char c) {
+               return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+           });
+}
+
+QList<RefReader::Ref> RefReader::readAll() const
+{
+    QMap<QString, Ref> refs;
+
+    // <oid> SP <name>, optionally followed by ^<peeled oid>. The header tells which refs without
+    // a peeled line are known not to be annotated tags.
+    PackedRefs packed(m_commonDir + "/packed-refs");
+    bool peeledTags = false;
+    bool fullyPeeled = false;
+    Ref *last = nullptr;
+    packed.forEachLine([&](QByteArrayView line) {
+        if (startsWith(line, "#")) {
+            if (startsWith(line, "# pack-refs with:")) {
+                const QByteArray traits = line.toByteArray() + ' ';
+                peeledTags = traits.contains(" peeled ");
+                fullyPeeled = traits.contains(" fully-peeled ");
+            }
+            return;
+        }
+        if (startsWith(line, "^")) {
+            if (last) {
+                last->peeled = line.sliced(1).toByteArray();
+                last->peelKnown = true;
+            }
+            return;
+        }
+        last = nullptr;
+        const char *space = static_cast<const char *>(memchr(line.data(), ' ', line.size()));
+        if (!space || !isOid(QByteArrayView(line.data(), space))) {
+            return;
+        }
+        Ref ref;
+        ref.oid = QByteArray(line.data(), space - line.data());
+        ref.name = QString::fromUtf8(space + 1, line.end() - space - 1);
+        ref.peelKnown = fullyPeeled || (peeledTags && ref.name.startsWith("refs/tags/"));
+        last = &refs.insert(ref.name, ref).value();
+    });
+
+    // Loose refs win over packed ones
+    const QString refsDir = m_commonDir + "/refs";
+    QDirIterator it(refsDir, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (path.endsWith(".lock")) {
+            continue;
+        }
+        const QByteArray content = readRefFile(path);
+        Ref ref;
+        ref.name = "refs/" + path.mid(refsDir.size() + 1);
+        if (content.startsWith("ref: ")) {
+            ref.symref = QString::fromUtf8(content.mid(5));
+        } else if (isOid(content)) {
+            ref.oid = content;
+        } else {
+            continue;  // Being written
+        }
+        ref.peelKnown = !ref.name.startsWith("refs/tags/");
+        Ref &old = refs[ref.name];
+        if (old.oid != ref.oid || old.symref != ref.symref) {
+            old = ref;
+        }
+    }
+
+    for (Ref &ref : refs) {
+        QString target = ref.symref;
+        for (int depth = 0; !target.isEmpty() && depth < maxSymrefDepth; ++depth) {
+            auto it = refs.constFind(target);
+            if (it == refs.cend()) {
+                break;
+            }
+            if (it->symref.isEmpty()) {
+                ref.oid = it->oid;
+                ref.peeled = it->peeled;
+                ref.peelKnown = it->peelKnown;
+                break;
+            }
+            target = it->symref;
+        }
+    }
+    return refs.values();
+}
+
+QByteArray RefReader::resolve(const QString &name, QString *target) const
+{
+    QString current = name;
+    for (int depth = 0; depth <= maxSymrefDepth; ++depth) {
+        // HEAD is per worktree, the refs are shared
+        const QByteArray content = current == "HEAD" ? readRefFile(m_gitDir + "/HEAD")
+                                                     : readLoose(current);
+        if (content.startsWith("ref: ")) {
+            current = QString::fromUtf8(content.mid(5));
+            continue;
+        }
+        if (target) {
+            *target = current;
+        }
+        if (isOid(content)) {
+            return content;
+        }
+        return current == "HEAD" ? QByteArray() : readPacked(current);
+    }
+    return {};
+}
+
+QByteArray RefReader::readLoose(const QString &name) const
+{
+    return readRefFile(m_commonDir + "/" + name);
+}
+
+QByteArray RefReader::readPacked(const QString &name) const
+{
+    PackedRefs packed(m_commonDir + "/packed-refs");
+    const QByteArray pattern = ' ' + name.toUtf8();
+    const QByteArrayMatcher matcher(pattern);
+    const char *data = packed.data();
+    const qint64 size = packed.size();
+    if (!data) {
+        return {};
+    }
+
+    // " <name>" at the end of a line, preceded by the oid at its start
+    for (qsizetype pos = matcher.indexIn(data, size); pos >= 0;
+         pos = matcher.indexIn(data, size, pos + 1)) {
+        const qint64 end = pos + pattern.size();
+        if (end < size && data[end] != '\n') {
+            continue;
+        }
+        qsizetype lineStart = pos;
+        while (lineStart > 0 && data[lineStart - 1] != '\n' && pos - lineStart <= 64) {
+            --lineStart;
+        }
+        const QByteArrayView oid(data + lineStart, pos - lineStart);
+        if (isOid(oid)) {
+            return oid.toByteArray();
+        }
+    }
+    return {};
+}
+
+QHash<QString, QString> RefReader::readUpstreams() const
+{
+    // branch.<name>.remote and branch.<name>.merge from [branch "<name>"] sections
+    QHash<QString, QString> remotes;
+    QHash<QString, QString> merges;
+    QFile config(m_commonDir + "/config");
+    if (!config.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QString branch;
+    while (!config.atEnd()) {
+        const QString line = QString::fromUtf8(config.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith(';')) {
+            continue;
+        }
+        if (line.startsWith('[')) {
+            const qsizetype quote = line.indexOf('"');
+            const bool isBranch = quote > 0 && line.endsWith("\"]") &&
+                                  line.mid(1, quote - 1).trimmed().toLower() == "branch";
+            branch = isBranch ? line.mid(quote + 1, line.size() - quote - 3) : QString();
+            continue;
+        }
+        const qsizetype equals = line.indexOf('=');
+        if (branch.isEmpty() || equals < 0) {
+            continue;
+        }
+        const QString key = line.left(equals).trimmed().toLower();
+        QString value = line.mid(equals + 1).trimmed();
+        if (value.size() >= 2 && value.startsWith('"') && value.endsWith('"')) {
+            value = value.mid(1, value.size() - 2);
+        }
+        if (key == "remote") {
+            remotes.insert(branch, value);
+        } else if (key == "merge") {
+            merges.insert(branch, value);
+        }
+    }
+
+    QHash<QString, QString> upstreams;
+    for (auto it = merges.cbegin(); it != merges.cend(); ++it) {
+        const QString remote = remotes.value(it.key());
+        if (remote.isEmpty()) {
+            continue;
+        }
+        const QString merge =
+            it->startsWith("refs/heads/") ? it->mid(QString("refs/heads/").size()) : *it;
+        // "." is the repository itself
+        upstreams.insert(it.key(), remote == "." ? merge : remote + "/" + merge);
+    }
+    return upstreams;
+}
@@ -0,0 +1,57 @@
+#ifndef REFREADER_H
+#define REFREADER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// Reads the refs of a project from the files git keeps them in, packed-refs and the loose files
+// under refs/, without running git. Follows the .git file and symlinks repo checks projects out
+// with to the directories in .repo/projects.
+class RefReader
+{
+public:
+    struct Ref
+    {
+        QString name;            // Full, e.g. refs/heads/main
+        QByteArray oid;          // Hex, empty for a symbolic ref to a missing ref
+        QByteArray peeled;       // Commit of an annotated tag, hex
+        QString symref;          // What a symbolic ref points at, e.g. refs/remotes/origin/main
+        bool peelKnown = false;  // Whether an empty peeled means it is no annotated tag
+    };
+
+    explicit RefReader(const QString &projectPath);
+
+    // Where HEAD is
+    const QString &gitDir() const
+    {
+        return m_gitDir;
+    }
+    // Where refs/ and packed-refs are, shared by the worktrees of a repository
+    const QString &commonDir() const
+    {
+        return m_commonDir;
+    }
+    // False for repositories that keep refs in a reftable, only git reads them
+    bool isReadable() const;
+
+    // Sorted by name, symbolic refs resolved
+    QList<Ref> readAll() const;
+    // name is HEAD or a full ref name, symbolic refs are followed. target is set to the last ref
+    // followed, e.g. refs/heads/main for HEAD. Empty when name doesn't resolve.
+    QByteArray resolve(const QString &name, QString *target = nullptr) const;
+    // key:branch, value:what it tracks, short like `git for-each-ref --format=%(upstream:short)`
+    QHash<QString, QString> readUpstreams() const;
+
+    static bool isOid(QByteArrayView data);
+
+private:
+    QString m_gitDir;
+    QString m_commonDir;
+
+    QByteArray readLoose(const QString &name) const;
+    QByteArray readPacked(const QString &name) const;
+};
+
+#endif  // REFREADER_H
@@ -0,0 +1,190 @@
+#include "refsnapshot.h"
+
+#include <QProcess>
+
+#include "git/catfilebatch.h"
+#include "git/refreader.h"
+
+// Fields are NUL-separated and refs end with a newline, neither can be in a ref name
+const char *const RefSnapshot::formatArgument =
+    "--format=%(refname)%00%(objectname)%00%(*objectname)%00%(upstream:short)%00%(symref)"
+    "%00%(HEAD)";
+
+enum Field
+{
+    RefNameField,
+    ObjectNameField,
+    PeeledField,
+    UpstreamField,
+    SymRefField,
+    HeadField,
+    FieldCount,
+};
+
+static const QString prefixes[RefSnapshot::KindCount] = {
+    "refs/heads/", "refs/remotes/", "refs/tags/"};
+
+RefSnapshot RefSnapshot::read(
+    const QString &projectPath, CatFileBatch *catFile, const RefSnapshot *previous)
+{
+    const RefReader reader(projectPath);
+    if (!reader.isReadable()) {
+        return readWithGit(projectPath);
+    }
+
+    RefSnapshot snapshot;
+    snapshot.stamp = RefIndex::readStamp(projectPath);
+    QString headRef;
+    snapshot.headOid = QString::fromLatin1(reader.resolve("HEAD", &headRef));
+    const QHash<QString, QString> upstreams = reader.readUpstreams();
+
+    for (const RefReader::Ref &readRef : reader.readAll()) {
+        const int kind = kindOf(readRef.name);
+        // Like origin/HEAD, it is shown through what it points at
+        if (kind == KindCount || !readRef.symref.isEmpty()) {
+            continue;
+        }
+        Ref ref;
+        ref.name = readRef.name.mid(prefixes[kind].size());
+        ref.oid = QString::fromLatin1(readRef.oid);
+        ref.peeled = QString::fromLatin1(readRef.peeled);
+        if (!readRef.peelKnown) {
+            // Tag objects never change, only new ones are asked for
+            const Ref *old = previous ? previous->find(Kind(kind), ref.name) : nullptr;
+            QByteArray commit;
+            if (old && old->oid == ref.oid) {
+                ref.peeled = old->peeled;
+            } else if (catFile &&
+                       catFile->resolve(ref.oid + "^{commit}", commit) == CatFileBatch::Found &&
+                       commit != readRef.oid) {
+                ref.peeled = QString::fromLatin1(commit);
+            }
+        }
+        if (kind == Branch) {
+            ref.upstream = upstreams.value(ref.name);
+            if (readRef.name == headRef) {
+                snapshot.head = ref.name;
+            }
+        } else if (kind == Remote) {
+            ref.remote = ref.name.section('/', 0, 0);
+        }
+        snapshot.append(Kind(kind), ref);
+    }
+    return snapshot;
+}
+
+RefSnapshot RefSnapshot::readWithGit(const QString &projectPath)
+{
+    RefSnapshot snapshot;
+    const RefIndex::Stamp stamp = RefIndex::readStamp(projectPath);
+
+    QProcess process;
+    process.setWorkingDirectory(projectPath);
+    process.start("git",
+        {"for-each-ref", formatArgument, "refs/heads", "refs/remotes", "refs/tags"},
+        QIODeviceBase::ReadOnly);
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit ||
+        process.exitCode() != 0) {
+        snapshot.error = QString::fromUtf8(process.readAllStandardError()).trimmed();
+        if (snapshot.error.isEmpty()) {
+            snapshot.error = "git for-each-ref failed";
+        }
+        return snapshot;
+    }
+    snapshot = parse(process.readAllStandardOutput());
+    snapshot.stamp = stamp;
+    snapshot.headOid = QString::fromLatin1(RefIndex::readHead(projectPath));
+    return snapshot;
+}
+
+RefSnapshot RefSnapshot::parse(const QByteArray &output)
+{
+    RefSnapshot snapshot;
+    for (const QByteArray &line : output.split('\n')) {
+        const QList<QByteArray> fields = line.split('\0');
+        if (fields.size() != FieldCount) {
+            continue;
+        }
+        const QString refName = QString::fromUtf8(fields[RefNameField]);
+        const int kind = kindOf(refName);
+        // Like origin/HEAD, it is shown through what it points at
+        if (kind == KindCount || !fields[SymRefField].isEmpty()) {
+            continue;
+        }
+
+        Ref ref;
+        ref.name = refName.mid(prefixes[kind].size());
+        ref.oid = QString::fromLatin1(fields[ObjectNameField]);
+        ref.peeled = QString::fromLatin1(fields[PeeledField]);
+        ref.upstream = QString::fromUtf8(fields[UpstreamField]);
+        if (kind == Remote) {
+            ref.remote = ref.name.section('/', 0, 0);
+        }
+        if (kind == Branch && fields[HeadField] == "*") {
+            snapshot.head = ref.name;
+        }
+        snapshot.append(Kind(kind), ref);
+    }
+    return snapshot;
+}
+
+int RefSnapshot::kindOf(const QString &refName)
+{
+    int kind = 0;
+    while (kind < KindCount && !refName.startsWith(prefixes[kind])) {
+        ++kind;
+    }
+    return kind;
+}
+
+void RefSnapshot::append(Kind kind, const Ref &ref)
+{
+    refIndex[kind].insert(ref.name, refs[kind].size());
+    commitIndex[ref.commit()].append({kind, int(refs[kind].size())});
+    refs[kind].append(ref);
+}
+
+const RefSnapshot::Ref *RefSnapshot::find(Kind kind, const QString &name) const
+{
+    auto it = refIndex[kind].constFind(name);
+    return it == refIndex[kind].cend() ? nullptr : &refs[kind][*it];
+}
+
+QStringList RefSnapshot::names(Kind kind) const
+{
+    QStringList names;
+    names.reserve(refs[kind].size());
+    for (const Ref &ref : refs[kind]) {
+        names << ref.name;
+    }
+    return names;
+}
+
+void RefSnapshot::decorate(Commit &commit) const
+{
+    commit.isHEAD = !headOid.isEmpty() && commit.hash == headOid;
+    commit.heads.clear();
+    commit.remotes.clear();
+    commit.tags.clear();
+    for (const auto &[kind, index] : commitIndex.value(commit.hash)) {
+        const QString &name = refs[kind][index].name;
+        switch (kind) {
+            case Branch:
+                // The checked out branch first, like git shows it
+                if (name == head) {
+                    commit.heads.prepend(name);
+                } else {
+                    commit.heads << name;
+                }
+                break;
+            case Remote:
+                commit.remotes << name;
+                break;
+            case Tag:
+                commit.tags << name;
+                break;
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef REFSNAPSHOT_H
+#define REFSNAPSHOT_H
+
+#include <QHash>
+#include <QStringList>
+
+#include "git/refindex.h"
+#include "global.h"
+
+class CatFileBatch;
+
+// Every branch, remote branch and tag of a project, read at once
+struct RefSnapshot
+{
+    // Same order as RefTreeItem::Type
+    enum Kind
+    {
+        Branch,
+        Remote,
+        Tag,
+        KindCount,
+    };
+
+    struct Ref
+    {
+        QString name;      // Short, e.g. main, origin/main or v1.0
+        QString oid;       // What the ref points at, the tag object of an annotated tag
+        QString peeled;    // Commit of an annotated tag
+        QString upstream;  // What a branch tracks, short
+        QString remote;    // Of a remote branch
+
+        QString commit() const
+        {
+            return peeled.isEmpty() ? oid : peeled;
+        }
+        // Name of a remote branch on its remote
+        QString remoteBranch() const
+        {
+            return name.mid(remote.size() + 1);
+        }
+    };
+
+    QList<Ref> refs[KindCount];  // Sorted by name
+    QHash<QString, int> refIndex[KindCount];  // key:name, value:index into refs
+    QHash<QString, QList<QPair<Kind, int>>> commitIndex;  // key:commit, value:kind and index
+    QString head;  // Current branch, empty when detached
+    QString headOid;
+    RefIndex::Stamp stamp;  // Of the ref files before they were read
+    QString error;
+
+    bool isValid() const
+    {
+        return error.isEmpty();
+    }
+
+    const Ref *find(Kind kind, const QString &name) const;
+    QStringList names(Kind kind) const;
+    // Fills in the refs of the commit like `git log --decorate` does
+    void decorate(Commit &commit) const;
+
+    // From the ref files without running git, but for repositories only git can read. Annotated
+    // tags packed-refs doesn't peel are peeled through catFile, unless previous has them with the
+    // same oid.
+    static RefSnapshot read(const QString &projectPath, CatFileBatch *catFile = nullptr,
+        const RefSnapshot *previous = nullptr);
+    // With `git for-each-ref`
+    static RefSnapshot readWithGit(const QString &projectPath);
+    // Of `git for-each-ref --format=` formatArgument
+    static RefSnapshot parse(const QByteArray &output);
+    static const char *const formatArgument;
+
+private:
+    // Kind of a full ref name, KindCount for the other refs
+    static int kindOf(const QString &refName);
+    void append(Kind kind, const Ref &ref);
+};
+
+#endif  // REFSNAPSHOT_H
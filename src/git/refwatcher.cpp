@@ -0,0 +1,189 @@
+#include "refwatcher.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+#include "git/refreader.h"
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Refs are written to a lock file which is then renamed over the ref
+static const uint32_t refsMask =
+    IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+RefWatcher::RefWatcher(const QString &projectPath, QObject *parent)
+    : QObject(parent), m_projectPath(projectPath)
+{
+    // A fetch or a checkout moves many refs at once
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(100);
+    connect(&m_flushTimer, &QTimer::timeout, this, &RefWatcher::changed);
+}
+
+RefWatcher::~RefWatcher()
+{
+    if (m_startWorker.isRunning()) {
+        m_startWorker.waitForFinished();
+    }
+    if (m_startWorker.isFinished() && m_startWorker.resultCount() && m_fd < 0) {
+        int fd = m_startWorker.result().fd;
+        if (fd >= 0) close(fd);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void RefWatcher::start()
+{
+    if (m_fd >= 0 || m_startWorker.isRunning() || m_outOfWatches) {
+        return;
+    }
+    QString projectPath = m_projectPath;
+    m_startWorker = QtConcurrent::run([projectPath]() {
+        Watches watches;
+        watches.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watches.fd < 0) {
+            return watches;
+        }
+
+        // inotify watches what the symlinks into .repo/projects point to, so the directories the
+        // files are renamed in are the ones of their resolved paths
+        const RefReader reader(projectPath);
+        auto watchFile = [&watches](const QString &path) {
+            const QString resolved = QFileInfo(path).canonicalFilePath();
+            const QFileInfo file(resolved.isEmpty() ? path : resolved);
+            int wd = inotify_add_watch(watches.fd, QFile::encodeName(file.absolutePath()),
+                IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_ONLYDIR);
+            if (wd >= 0) {
+                watches.files[wd] << file.fileName();
+            } else if (isOutOfWatches()) {
+                watches.outOfWatches = true;
+            }
+        };
+        watchFile(reader.gitDir() + "/HEAD");
+        watchFile(reader.commonDir() + "/packed-refs");
+        if (!addRefsWatches(QFileInfo(reader.commonDir() + "/refs").canonicalFilePath(),
+                watches.refsDirs, watches.fd)) {
+            watches.outOfWatches = true;
+        }
+
+        if (watches.outOfWatches || watches.files.isEmpty() || watches.refsDirs.isEmpty()) {
+            // Not a repository, or out of watches (fs.inotify.max_user_watches). Missed moves
+            // are worse than no watching, the owner rereads by itself then.
+            close(watches.fd);
+            watches.fd = -1;
+        }
+        return watches;
+    });
+    m_startWorker.then(this, [this](const Watches &watches) {
+        if (watches.fd < 0) {
+            if (watches.outOfWatches) {
+                qWarning() << "Out of inotify watches, not watching the refs of" << m_projectPath;
+                m_outOfWatches = true;
+            }
+            return;
+        }
+        m_fd = watches.fd;
+        m_fileWatches = watches.files;
+        m_refsDirs = watches.refsDirs;
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &RefWatcher::onEvents);
+    });
+}
+
+bool RefWatcher::addRefsWatches(const QString &dir, QHash<int, QString> &refsDirs, int fd)
+{
+    if (dir.isEmpty()) {
+        return true;
+    }
+    int wd = inotify_add_watch(fd, QFile::encodeName(dir), refsMask);
+    if (wd < 0) {
+        return !isOutOfWatches();
+    }
+    refsDirs.insert(wd, dir);
+    const QStringList children = QDir(dir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &child : children) {
+        if (!addRefsWatches(dir + "/" + child, refsDirs, fd)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Of the last inotify_add_watch. A directory removed meanwhile is fine, running out of watches
+// is not.
+bool RefWatcher::isOutOfWatches()
+{
+    return errno == ENOSPC || errno == ENOMEM;
+}
+
+void RefWatcher::onEvents()
+{
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t len = read(m_fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        for (char *p = buffer; p < buffer + len;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changed = true;
+                continue;
+            }
+            const QString name = event->len ? QFile::decodeName(event->name) : QString();
+            auto files = m_fileWatches.constFind(event->wd);
+            if (files != m_fileWatches.cend() && files->contains(name)) {
+                changed = true;
+            }
+
+            auto it = m_refsDirs.find(event->wd);
+            if (it == m_refsDirs.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_refsDirs.erase(it);
+                continue;
+            }
+            if (name.isEmpty() || name.endsWith(".lock")) {
+                continue;
+            }
+            changed = true;
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                // e.g. refs/remotes/<new remote>, its refs may be in before the watch is
+                if (!addRefsWatches(*it + "/" + name, m_refsDirs, m_fd)) {
+                    // What moved up to here is still reported
+                    stopWatching();
+                    m_flushTimer.start();
+                    return;
+                }
+            }
+        }
+    }
+
+    if (changed && !m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void RefWatcher::stopWatching()
+{
+    qWarning() << "Out of inotify watches, no longer watching the refs of" << m_projectPath;
+    m_outOfWatches = true;
+    m_notifier->setEnabled(false);
+    m_notifier->deleteLater();
+    m_notifier = nullptr;
+    close(m_fd);
+    m_fd = -1;
+    m_startWorker = QFuture<Watches>();  // Its fd is closed, the destructor leaves it
+    m_fileWatches.clear();
+    m_refsDirs.clear();
+}
@@ -0,0 +1,57 @@
+#ifndef REFWATCHER_H
+#define REFWATCHER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+// Watches the ref files of a project with inotify: HEAD, packed-refs and everything under refs/,
+// where repo's symlinks point to. Tells when a commit, checkout, fetch or anything else moved a
+// ref, from this process or another.
+class RefWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RefWatcher(const QString &projectPath, QObject *parent = nullptr);
+    ~RefWatcher();
+
+    // Watches are set up in the background. watching() stays false when not every ref directory
+    // could be watched, e.g. out of inotify watches, and the owner then rereads by itself.
+    void start();
+    bool watching() const
+    {
+        return m_notifier != nullptr;
+    }
+
+signals:
+    void changed();
+
+private:
+    struct Watches
+    {
+        int fd = -1;
+        QHash<int, QStringList> files;  // Watch descriptor to the names of HEAD or packed-refs
+        QHash<int, QString> refsDirs;   // Watch descriptor to a directory under refs/
+        bool outOfWatches = false;
+    };
+    // False when a directory couldn't be watched for lack of watches
+    static bool addRefsWatches(const QString &dir, QHash<int, QString> &refsDirs, int fd);
+    static bool isOutOfWatches();
+
+    void onEvents();
+    void stopWatching();
+
+    QString m_projectPath;
+    int m_fd = -1;
+    QHash<int, QStringList> m_fileWatches;
+    QHash<int, QString> m_refsDirs;
+    QSocketNotifier *m_notifier = nullptr;
+    QFuture<Watches> m_startWorker;
+    bool m_outOfWatches = false;
+    QTimer m_flushTimer;
+};
+
+#endif  // REFWATCHER_H
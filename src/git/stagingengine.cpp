@@ -0,0 +1,171 @@
+#include "stagingengine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+
+namespace git {
+
+    // Small enough to cancel quickly, large enough that process startup doesn't matter
+    static const int chunkSize = 1000;
+
+    static bool isAdded(const QString &mode)
+    {
+        return mode[0] == 'A' || mode[0] == 'R' || mode[0] == 'C';
+    }
+
+    static bool runGit(const QString &projectPath, const QStringList &arguments,
+        const QList<GitFile> &files, QString &error)
+    {
+        // An empty pathspec would mean the whole tree
+        if (files.isEmpty()) {
+            return true;
+        }
+        QProcess process;
+        process.setWorkingDirectory(projectPath);
+        process.setProcessChannelMode(QProcess::MergedChannels);
+        process.start("git",
+            QStringList{"--literal-pathspecs"} + arguments +
+                QStringList{"--pathspec-from-file=-", "--pathspec-file-nul"});
+        if (!process.waitForStarted(-1)) {
+            error = "Failed to start git";
+            return false;
+        }
+        for (const GitFile &file : files) {
+            process.write(QFile::encodeName(file.path));
+            process.write("\0", 1);
+        }
+        process.closeWriteChannel();
+        if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit ||
+            process.exitCode() != 0) {
+            error = QString::fromLocal8Bit(process.readAll()).trimmed();
+            if (error.isEmpty()) {
+                error = QString("git %1 failed").arg(arguments.first());
+            }
+            return false;
+        }
+        return true;
+    }
+
+    static bool removeFiles(
+        const QString &projectPath, const QList<GitFile> &files, QString &error)
+    {
+        for (const GitFile &file : files) {
+            const QString absPath = QDir::cleanPath(projectPath + "/" + file.path);
+            if (QFileInfo(absPath).isSymLink() || QFileInfo::exists(absPath)) {
+                if (!QFile::remove(absPath)) {
+                    error = QString("Failed to remove %1").arg(file.path);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static bool runChunk(const QString &projectPath, FileOp op, const QList<GitFile> &files,
+        bool staged, QString &error)
+    {
+        if (op == FileOp::Stage) {
+            return runGit(projectPath, {"add"}, files, error);
+        }
+        if (op == FileOp::Unstage) {
+            return runGit(projectPath, {"reset", "-q"}, files, error);
+        }
+
+        // Staged files are unstaged first, like `git reset -- f && git checkout -- f` did
+        if (staged && !runGit(projectPath, {"reset", "-q"}, files, error)) {
+            return false;
+        }
+        if (op == FileOp::Remove) {
+            return removeFiles(projectPath, files, error);
+        }
+        QList<GitFile> tracked;
+        QList<GitFile> untracked;
+        for (const GitFile &file : files) {
+            // Added files are untracked once unstaged, discarding leaves them in place
+            if (staged && isAdded(file.mode)) {
+                continue;
+            }
+            (file.mode == "??" ? untracked : tracked).append(file);
+        }
+        return runGit(projectPath, {"checkout"}, tracked, error) &&
+               removeFiles(projectPath, untracked, error);
+    }
+
+    // Status entry of a file once the operation went through, following what
+    // `git status` would print. Unknown states are left to the next status.
+    static void patchFile(const QString &projectPath, FileOp op, const GitFile &file,
+        bool staged, FileOpResult &result)
+    {
+        const QString &mode = file.mode;
+        const bool exists = QFileInfo::exists(QDir::cleanPath(projectPath + "/" + file.path));
+        QList<GitFile> *list = nullptr;
+        QString newMode;
+
+        if (global::isUnmerged(mode)) {
+            if (op != FileOp::Stage) return;
+            list = &result.stagedList;
+            newMode = exists ? "M " : "D ";
+        } else if (op == FileOp::Stage) {
+            list = &result.stagedList;
+            if (mode == "??") {
+                newMode = "A ";
+            } else if (!staged) {
+                newMode = QString(mode[1]) + " ";
+            } else if (mode[1] == ' ') {
+                newMode = mode;
+            } else if (mode[1] == 'D') {
+                newMode = isAdded(mode) ? "" : "D ";
+            } else {
+                newMode = QString(mode[0]) + " ";
+            }
+        } else if (op == FileOp::Unstage) {
+            list = &result.unstagedList;
+            if (!staged) {
+                newMode = mode;
+            } else if (isAdded(mode)) {
+                newMode = exists ? "??" : "";
+            } else if (mode[0] == 'D') {
+                newMode = " D";
+            } else {
+                newMode = QString(" ") + (mode[1] != ' ' ? mode[1] : mode[0]);
+            }
+        } else if (op == FileOp::Discard) {
+            list = &result.unstagedList;
+            if (staged && isAdded(mode) && exists) {
+                newMode = "??";
+            }
+        } else if (op == FileOp::Remove) {
+            list = &result.unstagedList;
+            if (mode != "??" && !(staged && isAdded(mode))) {
+                newMode = " D";
+            }
+        }
+
+        result.paths << file.path;
+        if (!newMode.isEmpty()) {
+            list->append(GitFile(file.path, newMode));
+        }
+    }
+
+    FileOpResult applyFileOp(const QString &projectPath, FileOp op, const QList<GitFile> &files,
+        bool staged, const std::function<bool()> &isCanceled)
+    {
+        FileOpResult result;
+        for (qsizetype i = 0; i < files.size(); i += chunkSize) {
+            if (isCanceled()) {
+                break;
+            }
+            const QList<GitFile> chunk = files.mid(i, chunkSize);
+            if (!runChunk(projectPath, op, chunk, staged, result.error)) {
+                break;
+            }
+            for (const GitFile &file : chunk) {
+                patchFile(projectPath, op, file, staged, result);
+            }
+        }
+        return result;
+    }
+
+}  // namespace git
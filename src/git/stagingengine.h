@@ -0,0 +1,36 @@
+#ifndef STAGINGENGINE_H
+#define STAGINGENGINE_H
+
+#include <QString>
+#include <functional>
+
+#include "global.h"
+
+namespace git {
+
+    enum class FileOp
+    {
+        Stage,
+        Unstage,
+        Discard,
+        Remove,
+    };
+
+    // Status entries of the files an operation went through, to patch the lists with
+    struct FileOpResult
+    {
+        QStringList paths;
+        QList<GitFile> stagedList;
+        QList<GitFile> unstagedList;
+        QString error;  // Output of the git command that failed, files after it were left alone
+    };
+
+    // Runs an operation on files of the staged or the unstaged list. Paths are fed to git
+    // through stdin in chunks, so there is no limit on their number and it can be canceled
+    // between chunks. The new status of the files is derived from the operation.
+    FileOpResult applyFileOp(const QString &projectPath, FileOp op, const QList<GitFile> &files,
+        bool staged, const std::function<bool()> &isCanceled);
+
+}  // namespace git
+
+#endif  // STAGINGENGINE_H
@@ -0,0 +1,77 @@
+#include "statusparser.h"
+
+#include <string.h>
+#include <utility>
+
+void StatusParser::feed(const QByteArray &data)
+{
+    m_pending.append(data);
+    const char *begin = m_pending.constData();
+    const char *end = begin + m_pending.size();
+    const char *record = begin;
+    while (const char *nul = static_cast<const char *>(memchr(record, 0, end - record))) {
+        parseRecord(record, nul - record);
+        record = nul + 1;
+    }
+    m_pending.remove(0, record - begin);
+}
+
+QList<GitFile> StatusParser::takeFiles()
+{
+    return std::exchange(m_files, {});
+}
+
+void StatusParser::parseRecord(const char *record, qsizetype size)
+{
+    // The source path of a rename or copy comes as a record of its own
+    if (m_skipOrigPath) {
+        m_skipOrigPath = false;
+        return;
+    }
+    if (size < 3) {
+        return;
+    }
+
+    // Number of space separated fields before the path
+    int fields;
+    switch (record[0]) {
+        case '1':  // 1 XY sub mH mI mW hH hI path
+            fields = 8;
+            break;
+        case '2':  // 2 XY sub mH mI mW hH hI Xscore path
+            fields = 9;
+            m_skipOrigPath = true;
+            break;
+        case 'u':  // u XY sub m1 m2 m3 mW h1 h2 h3 path
+            fields = 10;
+            break;
+        case '?':  // ? path
+            m_files.emplace_back(QString::fromUtf8(record + 2, size - 2), "??");
+            return;
+        default:  // Headers and ignored files
+            return;
+    }
+
+    const char *fieldStarts[10];
+    const char *path = record;
+    const char *end = record + size;
+    for (int i = 0; i < fields && path < end; ++i) {
+        fieldStarts[i] = path;
+        path = static_cast<const char *>(memchr(path, ' ', end - path));
+        if (!path) return;
+        ++path;
+    }
+    if (size < 4 || path >= end) {
+        return;
+    }
+
+    // '.' is unmodified in v2, a space in v1
+    QString mode = QString::fromLatin1(record + 2, 2);
+    mode.replace('.', ' ');
+    GitFile &file = m_files.emplace_back(QString::fromUtf8(path, end - path), mode);
+    if (record[0] != 'u') {
+        const char *indexOidEnd = (fields > 8 ? fieldStarts[8] : path) - 1;
+        file.headOid = QString::fromLatin1(fieldStarts[6], fieldStarts[7] - fieldStarts[6] - 1);
+        file.indexOid = QString::fromLatin1(fieldStarts[7], indexOidEnd - fieldStarts[7]);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef STATUSPARSER_H
+#define STATUSPARSER_H
+
+#include <QByteArray>
+#include <QList>
+
+#include "global.h"
+
+// Streaming parser for `git status --porcelain=v2 -z`, fed with output as it arrives.
+// Files get porcelain v1 modes, e.g. "M " or "??".
+class StatusParser
+{
+public:
+    void feed(const QByteArray &data);
+    // Files of the complete records so far
+    QList<GitFile> takeFiles();
+
+private:
+    void parseRecord(const char *record, qsizetype size);
+
+    QByteArray m_pending;
+    QList<GitFile> m_files;
+    bool m_skipOrigPath = false;
+};
+
+#endif  // STATUSPARSER_H
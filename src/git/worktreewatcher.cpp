@@ -0,0 +1,201 @@
+#include "worktreewatcher.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QtConcurrent>
+
+#include "git/refreader.h"
+#include "global.h"
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+static const uint32_t workTreeMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE |
+                                     IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_EXCL_UNLINK |
+                                     IN_ONLYDIR;
+static const uint32_t gitDirMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_ONLYDIR;
+
+WorkTreeWatcher::WorkTreeWatcher(const QString &workTree, QObject *parent)
+    : QObject(parent), m_workTree(workTree)
+{
+    // Coalesce bursts like builds or checkouts, without waiting for them to end
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(200);
+    connect(&m_flushTimer, &QTimer::timeout, this, &WorkTreeWatcher::flush);
+}
+
+WorkTreeWatcher::~WorkTreeWatcher()
+{
+    if (m_startWorker.isRunning()) {
+        m_startWorker.waitForFinished();
+    }
+    if (m_startWorker.isFinished() && m_startWorker.resultCount() && m_fd < 0) {
+        int fd = m_startWorker.result().fd;
+        if (fd >= 0) close(fd);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void WorkTreeWatcher::start()
+{
+    if (m_fd >= 0 || m_startWorker.isRunning() || m_outOfWatches) {
+        return;
+    }
+    QString workTree = m_workTree;
+    m_startWorker = QtConcurrent::run([workTree]() {
+        Watches watches;
+        watches.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watches.fd < 0) {
+            return watches;
+        }
+
+        // Ignored directories as collapsed by git, e.g. "out/"
+        QSet<QString> ignoredDirs;
+        const QByteArray output = global::getCmdOutput(
+            "git", {"ls-files", "-z", "--others", "--ignored", "--exclude-standard", "--directory"},
+            workTree);
+        for (const QByteArray &path : output.split('\0')) {
+            if (path.endsWith('/')) {
+                ignoredDirs.insert(QString::fromUtf8(path.chopped(1)));
+            }
+        }
+
+        // Not always the .git directory, see RefReader
+        watches.gitDir = inotify_add_watch(
+            watches.fd, QFile::encodeName(RefReader(workTree).gitDir()), gitDirMask);
+        const bool complete = addWatches(workTree, "", ignoredDirs, watches.dirs, watches.fd);
+        if (watches.gitDir < 0 || !complete || watches.dirs.isEmpty()) {
+            // Mostly out of watches (fs.inotify.max_user_watches). Missed changes are worse than
+            // no watching, the owner refreshes by itself then.
+            close(watches.fd);
+            watches.fd = -1;
+            watches.outOfWatches = true;
+        }
+        return watches;
+    });
+    m_startWorker.then(this, [this](const Watches &watches) {
+        if (watches.fd < 0) {
+            if (watches.outOfWatches) {
+                qWarning() << "Out of inotify watches, not watching" << m_workTree;
+                m_outOfWatches = true;
+            }
+            return;
+        }
+        m_fd = watches.fd;
+        m_watchDirs = watches.dirs;
+        m_gitDirWatch = watches.gitDir;
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &WorkTreeWatcher::onEvents);
+        emit started();
+    });
+}
+
+bool WorkTreeWatcher::addWatches(const QString &workTree, const QString &dir,
+    const QSet<QString> &ignoredDirs, QHash<int, QString> &dirs, int fd)
+{
+    const QString absDir = dir.isEmpty() ? workTree : workTree + "/" + dir;
+    int wd = inotify_add_watch(fd, QFile::encodeName(absDir), workTreeMask);
+    if (wd < 0) {
+        // A directory removed meanwhile is fine, running out of watches is not
+        return errno != ENOSPC && errno != ENOMEM;
+    }
+    dirs.insert(wd, dir);
+
+    const QStringList children =
+        QDir(absDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+    for (const QString &child : children) {
+        const QString childDir = dir.isEmpty() ? child : dir + "/" + child;
+        // .git and nested repositories (repo projects checked out inside this one)
+        if (child == ".git" || child == ".repo" || ignoredDirs.contains(childDir) ||
+            QFileInfo::exists(workTree + "/" + childDir + "/.git")) {
+            continue;
+        }
+        if (!addWatches(workTree, childDir, ignoredDirs, dirs, fd)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WorkTreeWatcher::onEvents()
+{
+    alignas(inotify_event) char buffer[16384];
+    for (;;) {
+        ssize_t len = read(m_fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        for (char *p = buffer; p < buffer + len;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                m_fullRefresh = true;
+                continue;
+            }
+            const QString name = event->len ? QFile::decodeName(event->name) : QString();
+            if (event->wd == m_gitDirWatch) {
+                if (name == "index" || name == "HEAD") {
+                    m_fullRefresh = true;
+                }
+                continue;
+            }
+
+            auto it = m_watchDirs.find(event->wd);
+            if (it == m_watchDirs.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                m_watchDirs.erase(it);
+                continue;
+            }
+            if (name.isEmpty()) {
+                continue;
+            }
+            const QString path = it->isEmpty() ? name : *it + "/" + name;
+            m_dirtyPaths.insert(path);
+
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                name != ".git") {
+                // New directories are not checked against .gitignore, git status filters them
+                if (!addWatches(m_workTree, path, {}, m_watchDirs, m_fd)) {
+                    stopWatching();
+                    return;
+                }
+            }
+        }
+    }
+
+    if ((m_fullRefresh || !m_dirtyPaths.isEmpty()) && !m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void WorkTreeWatcher::stopWatching()
+{
+    qWarning() << "Out of inotify watches, no longer watching" << m_workTree;
+    m_outOfWatches = true;
+    m_notifier->setEnabled(false);
+    m_notifier->deleteLater();
+    m_notifier = nullptr;
+    close(m_fd);
+    m_fd = -1;
+    m_startWorker = QFuture<Watches>();  // Its fd is closed, the destructor leaves it
+    m_watchDirs.clear();
+    m_gitDirWatch = -1;
+    // What changed up to here is still reported
+    m_fullRefresh = true;
+    m_flushTimer.start();
+}
+
+void WorkTreeWatcher::flush()
+{
+    const QStringList paths(m_dirtyPaths.begin(), m_dirtyPaths.end());
+    const bool fullRefresh = m_fullRefresh;
+    m_dirtyPaths.clear();
+    m_fullRefresh = false;
+    emit changed(paths, fullRefresh);
+}
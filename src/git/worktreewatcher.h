@@ -0,0 +1,65 @@
+#ifndef WORKTREEWATCHER_H
+#define WORKTREEWATCHER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QTimer>
+
+// Watches a work tree and its .git with inotify, and reports the paths that changed.
+// Directories ignored by git and nested repositories are not watched.
+class WorkTreeWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorkTreeWatcher(const QString &workTree, QObject *parent = nullptr);
+    ~WorkTreeWatcher();
+
+    // Watches are set up in the background, watching() turns true once they are in place. It
+    // stays false when not every directory could be watched, e.g. out of inotify watches, and
+    // the owner then refreshes by itself.
+    void start();
+    bool watching() const
+    {
+        return m_notifier != nullptr;
+    }
+
+signals:
+    void started();
+    // Paths are relative to the work tree. fullRefresh is set when the index or HEAD changed,
+    // or when events were lost, so the paths alone don't tell what changed.
+    void changed(const QStringList &paths, bool fullRefresh);
+
+private:
+    struct Watches
+    {
+        int fd = -1;
+        QHash<int, QString> dirs;  // Watch descriptor to directory relative to the work tree
+        int gitDir = -1;
+        bool outOfWatches = false;
+    };
+    // False when a directory couldn't be watched for lack of watches
+    static bool addWatches(const QString &workTree, const QString &dir,
+        const QSet<QString> &ignoredDirs, QHash<int, QString> &dirs, int fd);
+
+    void onEvents();
+    void stopWatching();
+    void flush();
+
+    QString m_workTree;
+    int m_fd = -1;
+    int m_gitDirWatch = -1;
+    QHash<int, QString> m_watchDirs;
+    QSocketNotifier *m_notifier = nullptr;
+    QFuture<Watches> m_startWorker;
+    bool m_outOfWatches = false;  // Not retried, every try would walk the whole tree
+
+    QTimer m_flushTimer;
+    QSet<QString> m_dirtyPaths;
+    bool m_fullRefresh = false;
+};
+
+#endif  // WORKTREEWATCHER_H
@@ -0,0 +1,1101 @@
+// Copyright (C) 2003-2016 Davide Libenzi, Johannes E. Schindelin, Git contributors
+// SPDX-License-Identifier: LGPL-2.1-or-later
+
+#include "xdiff.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+
+namespace xdiff {
+
+    namespace {
+
+        const long MaxEqLimit = 1024;
+        const long SimScanWindow = 100;
+        const long KpDisRun = 4;
+        const long MaxCostMin = 256;
+        const long HeurMinCost = 256;
+        const long SnakeCnt = 20;
+        const long KHeur = 4;
+        const long NonUnique = LONG_MAX;
+
+        const int MaxIndent = 200;
+        const int MaxBlanks = 20;
+        const int StartOfFilePenalty = 1;
+        const int EndOfFilePenalty = 21;
+        const int TotalBlankWeight = -30;
+        const int PostBlankWeight = 6;
+        const int RelativeIndentPenalty = -4;
+        const int RelativeIndentWithBlankPenalty = 10;
+        const int RelativeOutdentPenalty = 24;
+        const int RelativeOutdentWithBlankPenalty = 17;
+        const int RelativeDedentPenalty = 23;
+        const int RelativeDedentWithBlankPenalty = 17;
+        const int IndentWeight = 60;
+        const long IndentHeuristicMaxSliding = 100;
+
+        const unsigned HistogramMaxChainLength = 64;
+        const size_t FuncLineMax = 80;
+        const size_t BinaryCheckBytes = 8000;
+
+        // git's sane_ctype, not the locale dependent one
+        inline bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        inline bool isAlpha(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        }
+
+        struct File
+        {
+            std::vector<std::string_view> recs;
+            std::vector<long> ha;  // Equivalence class of each record
+            std::vector<char> rchgBuffer;
+            char *rchg = nullptr;  // Changed flags, rchg[-1] and rchg[nrec] are always 0
+            long nrec = 0;
+
+            void init(std::string_view data, std::unordered_map<std::string_view, long> &classes)
+            {
+                size_t pos = 0;
+                while (pos < data.size()) {
+                    size_t nl = data.find('\n', pos);
+                    size_t end = nl == std::string_view::npos ? data.size() : nl + 1;
+                    std::string_view rec = data.substr(pos, end - pos);
+                    long cls = classes.emplace(rec, long(classes.size())).first->second;
+                    recs.push_back(rec);
+                    ha.push_back(cls);
+                    pos = end;
+                }
+                nrec = recs.size();
+                rchgBuffer.assign(nrec + 2, 0);
+                rchg = rchgBuffer.data() + 1;
+            }
+        };
+
+        long bogoSqrt(long n)
+        {
+            long i;
+            for (i = 1; n > 0; n >>= 2) {
+                i <<= 1;
+            }
+            return i;
+        }
+
+        // Myers -------------------------------------------------------------------------------
+
+        struct DiffData
+        {
+            const long *ha;
+            const long *rindex;
+            char *rchg;
+        };
+
+        struct Split
+        {
+            long i1, i2;
+            bool minLo, minHi;
+        };
+
+        bool cleanMMatch(const char *dis, long i, long s, long e)
+        {
+            long r, rdis0, rpdis0, rdis1, rpdis1;
+
+            if (i - s > SimScanWindow) s = i - SimScanWindow;
+            if (e - i > SimScanWindow) e = i + SimScanWindow;
+
+            for (r = 1, rdis0 = 0, rpdis0 = 1; (i - r) >= s; r++) {
+                if (!dis[i - r]) {
+                    rdis0++;
+                } else if (dis[i - r] == 2) {
+                    rpdis0++;
+                } else {
+                    break;
+                }
+            }
+            if (rdis0 == 0) return false;
+            for (r = 1, rdis1 = 0, rpdis1 = 1; (i + r) <= e; r++) {
+                if (!dis[i + r]) {
+                    rdis1++;
+                } else if (dis[i + r] == 2) {
+                    rpdis1++;
+                } else {
+                    break;
+                }
+            }
+            if (rdis1 == 0) return false;
+            rdis1 += rdis0;
+            rpdis1 += rpdis0;
+            return rpdis1 * KpDisRun < (rpdis1 + rdis1);
+        }
+
+        long split(const long *ha1, long off1, long lim1, const long *ha2, long off2, long lim2,
+            long *kvdf, long *kvdb, bool needMin, Split &spl, long mxcost)
+        {
+            long dmin = off1 - lim2, dmax = lim1 - off2;
+            long fmid = off1 - off2, bmid = lim1 - lim2;
+            long odd = (fmid - bmid) & 1;
+            long fmin = fmid, fmax = fmid;
+            long bmin = bmid, bmax = bmid;
+            long ec, d, i1, i2, prev1, best, dd, v, k;
+
+            kvdf[fmid] = off1;
+            kvdb[bmid] = lim1;
+
+            for (ec = 1;; ec++) {
+                bool gotSnake = false;
+
+                if (fmin > dmin) {
+                    kvdf[--fmin - 1] = -1;
+                } else {
+                    ++fmin;
+                }
+                if (fmax < dmax) {
+                    kvdf[++fmax + 1] = -1;
+                } else {
+                    --fmax;
+                }
+
+                for (d = fmax; d >= fmin; d -= 2) {
+                    if (kvdf[d - 1] >= kvdf[d + 1]) {
+                        i1 = kvdf[d - 1] + 1;
+                    } else {
+                        i1 = kvdf[d + 1];
+                    }
+                    prev1 = i1;
+                    i2 = i1 - d;
+                    for (; i1 < lim1 && i2 < lim2 && ha1[i1] == ha2[i2]; i1++, i2++) {
+                    }
+                    if (i1 - prev1 > SnakeCnt) gotSnake = true;
+                    kvdf[d] = i1;
+                    if (odd && bmin <= d && d <= bmax && kvdb[d] <= i1) {
+                        spl.i1 = i1;
+                        spl.i2 = i2;
+                        spl.minLo = spl.minHi = true;
+                        return ec;
+                    }
+                }
+
+                if (bmin > dmin) {
+                    kvdb[--bmin - 1] = LONG_MAX;
+                } else {
+                    ++bmin;
+                }
+                if (bmax < dmax) {
+                    kvdb[++bmax + 1] = LONG_MAX;
+                } else {
+                    --bmax;
+                }
+
+                for (d = bmax; d >= bmin; d -= 2) {
+                    if (kvdb[d - 1] < kvdb[d + 1]) {
+                        i1 = kvdb[d - 1];
+                    } else {
+                        i1 = kvdb[d + 1] - 1;
+                    }
+                    prev1 = i1;
+                    i2 = i1 - d;
+                    for (; i1 > off1 && i2 > off2 && ha1[i1 - 1] == ha2[i2 - 1]; i1--, i2--) {
+                    }
+                    if (prev1 - i1 > SnakeCnt) gotSnake = true;
+                    kvdb[d] = i1;
+                    if (!odd && fmin <= d && d <= fmax && i1 <= kvdf[d]) {
+                        spl.i1 = i1;
+                        spl.i2 = i2;
+                        spl.minLo = spl.minHi = true;
+                        return ec;
+                    }
+                }
+
+                if (needMin) continue;
+
+                // Sample the diagonals for a long enough snake once the cost gets high
+                if (gotSnake && ec > HeurMinCost) {
+                    for (best = 0, d = fmax; d >= fmin; d -= 2) {
+                        dd = d > fmid ? d - fmid : fmid - d;
+                        i1 = kvdf[d];
+                        i2 = i1 - d;
+                        v = (i1 - off1) + (i2 - off2) - dd;
+
+                        if (v > KHeur * ec && v > best && off1 + SnakeCnt <= i1 && i1 < lim1 &&
+                            off2 + SnakeCnt <= i2 && i2 < lim2) {
+                            for (k = 1; ha1[i1 - k] == ha2[i2 - k]; k++) {
+                                if (k == SnakeCnt) {
+                                    best = v;
+                                    spl.i1 = i1;
+                                    spl.i2 = i2;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                    if (best > 0) {
+                        spl.minLo = true;
+                        spl.minHi = false;
+                        return ec;
+                    }
+
+                    for (best = 0, d = bmax; d >= bmin; d -= 2) {
+                        dd = d > bmid ? d - bmid : bmid - d;
+                        i1 = kvdb[d];
+                        i2 = i1 - d;
+                        v = (lim1 - i1) + (lim2 - i2) - dd;
+
+                        if (v > KHeur * ec && v > best && off1 < i1 && i1 <= lim1 - SnakeCnt &&
+                            off2 < i2 && i2 <= lim2 - SnakeCnt) {
+                            for (k = 0; ha1[i1 + k] == ha2[i2 + k]; k++) {
+                                if (k == SnakeCnt - 1) {
+                                    best = v;
+                                    spl.i1 = i1;
+                                    spl.i2 = i2;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                    if (best > 0) {
+                        spl.minLo = false;
+                        spl.minHi = true;
+                        return ec;
+                    }
+                }
+
+                // Too expensive, take the furthest reaching path
+                if (ec >= mxcost) {
+                    long fbest, fbest1, bbest, bbest1;
+
+                    fbest = fbest1 = -1;
+                    for (d = fmax; d >= fmin; d -= 2) {
+                        i1 = std::min(kvdf[d], lim1);
+                        i2 = i1 - d;
+                        if (lim2 < i2) {
+                            i1 = lim2 + d;
+                            i2 = lim2;
+                        }
+                        if (fbest < i1 + i2) {
+                            fbest = i1 + i2;
+                            fbest1 = i1;
+                        }
+                    }
+
+                    bbest = bbest1 = LONG_MAX;
+                    for (d = bmax; d >= bmin; d -= 2) {
+                        i1 = std::max(off1, kvdb[d]);
+                        i2 = i1 - d;
+                        if (i2 < off2) {
+                            i1 = off2 + d;
+                            i2 = off2;
+                        }
+                        if (i1 + i2 < bbest) {
+                            bbest = i1 + i2;
+                            bbest1 = i1;
+                        }
+                    }
+
+                    if ((lim1 + lim2) - bbest < fbest - (off1 + off2)) {
+                        spl.i1 = fbest1;
+                        spl.i2 = fbest - fbest1;
+                        spl.minLo = true;
+                        spl.minHi = false;
+                    } else {
+                        spl.i1 = bbest1;
+                        spl.i2 = bbest - bbest1;
+                        spl.minLo = false;
+                        spl.minHi = true;
+                    }
+                    return ec;
+                }
+            }
+        }
+
+        void recsCmp(const DiffData &dd1, long off1, long lim1, const DiffData &dd2, long off2,
+            long lim2, long *kvdf, long *kvdb, bool needMin, long mxcost)
+        {
+            const long *ha1 = dd1.ha, *ha2 = dd2.ha;
+
+            for (; off1 < lim1 && off2 < lim2 && ha1[off1] == ha2[off2]; off1++, off2++) {
+            }
+            for (; off1 < lim1 && off2 < lim2 && ha1[lim1 - 1] == ha2[lim2 - 1]; lim1--, lim2--) {
+            }
+
+            if (off1 == lim1) {
+                for (; off2 < lim2; off2++) {
+                    dd2.rchg[dd2.rindex[off2]] = 1;
+                }
+            } else if (off2 == lim2) {
+                for (; off1 < lim1; off1++) {
+                    dd1.rchg[dd1.rindex[off1]] = 1;
+                }
+            } else {
+                Split spl = {0, 0, false, false};
+                split(ha1, off1, lim1, ha2, off2, lim2, kvdf, kvdb, needMin, spl, mxcost);
+                recsCmp(dd1, off1, spl.i1, dd2, off2, spl.i2, kvdf, kvdb, spl.minLo, mxcost);
+                recsCmp(dd1, spl.i1, lim1, dd2, spl.i2, lim2, kvdf, kvdb, spl.minHi, mxcost);
+            }
+        }
+
+        // xdl_do_diff() for Myers on two record ranges, prepared from scratch the same way
+        // xdl_fall_back_diff() does it for the patience and histogram fallbacks
+        void classicDiff(
+            const long *ha1, long n1, const long *ha2, long n2, char *rchg1, char *rchg2, bool needMin)
+        {
+            std::unordered_map<long, std::pair<long, long>> counts;
+            counts.reserve(n1 + n2);
+            for (long i = 0; i < n1; ++i) {
+                counts[ha1[i]].first++;
+            }
+            for (long i = 0; i < n2; ++i) {
+                counts[ha2[i]].second++;
+            }
+
+            // Trim common head and tail
+            long i, lim = std::min(n1, n2);
+            for (i = 0; i < lim; i++) {
+                if (ha1[i] != ha2[i]) break;
+            }
+            const long dstart = i;
+            for (lim -= i, i = 0; i < lim; i++) {
+                if (ha1[n1 - 1 - i] != ha2[n2 - 1 - i]) break;
+            }
+            const long dend1 = n1 - i - 1;
+            const long dend2 = n2 - i - 1;
+
+            // Discard lines without a match, and multi-matches surrounded by them
+            std::vector<char> dis1(n1 + 1), dis2(n2 + 1);
+            long mlim = std::min(bogoSqrt(n1), MaxEqLimit);
+            for (i = dstart; i <= dend1; i++) {
+                long nm = counts[ha1[i]].second;
+                dis1[i] = nm == 0 ? 0 : (nm >= mlim) ? 2 : 1;
+            }
+            mlim = std::min(bogoSqrt(n2), MaxEqLimit);
+            for (i = dstart; i <= dend2; i++) {
+                long nm = counts[ha2[i]].first;
+                dis2[i] = nm == 0 ? 0 : (nm >= mlim) ? 2 : 1;
+            }
+
+            std::vector<long> rindex1, rha1, rindex2, rha2;
+            for (i = dstart; i <= dend1; i++) {
+                if (dis1[i] == 1 || (dis1[i] == 2 && !cleanMMatch(dis1.data(), i, dstart, dend1))) {
+                    rindex1.push_back(i);
+                    rha1.push_back(ha1[i]);
+                } else {
+                    rchg1[i] = 1;
+                }
+            }
+            for (i = dstart; i <= dend2; i++) {
+                if (dis2[i] == 1 || (dis2[i] == 2 && !cleanMMatch(dis2.data(), i, dstart, dend2))) {
+                    rindex2.push_back(i);
+                    rha2.push_back(ha2[i]);
+                } else {
+                    rchg2[i] = 1;
+                }
+            }
+
+            const long nreff1 = rindex1.size();
+            const long nreff2 = rindex2.size();
+            const long ndiags = nreff1 + nreff2 + 3;
+            std::vector<long> kvd(2 * ndiags + 2);
+            long *kvdf = kvd.data() + nreff2 + 1;
+            long *kvdb = kvd.data() + ndiags + nreff2 + 1;
+            const long mxcost = std::max(bogoSqrt(ndiags), MaxCostMin);
+
+            DiffData dd1 = {rha1.data(), rindex1.data(), rchg1};
+            DiffData dd2 = {rha2.data(), rindex2.data(), rchg2};
+            recsCmp(dd1, 0, nreff1, dd2, 0, nreff2, kvdf, kvdb, needMin, mxcost);
+        }
+
+        // Patience ----------------------------------------------------------------------------
+
+        void patienceDiff(File &f1, File &f2, long line1, long count1, long line2, long count2)
+        {
+            if (!count1) {
+                while (count2--) {
+                    f2.rchg[line2++ - 1] = 1;
+                }
+                return;
+            } else if (!count2) {
+                while (count1--) {
+                    f1.rchg[line1++ - 1] = 1;
+                }
+                return;
+            }
+
+            struct Entry
+            {
+                long line1;
+                long line2;
+                long previous;
+            };
+
+            // Unique lines of the first range in file order, matched against the second
+            std::vector<Entry> entries;
+            std::unordered_map<long, long> entryOfClass;
+            entryOfClass.reserve(count1);
+            bool hasMatches = false;
+            for (long l = line1; l < line1 + count1; ++l) {
+                auto inserted = entryOfClass.emplace(f1.ha[l - 1], long(entries.size()));
+                if (inserted.second) {
+                    entries.push_back({l, 0, -1});
+                } else {
+                    entries[inserted.first->second].line2 = NonUnique;
+                }
+            }
+            for (long l = line2; l < line2 + count2; ++l) {
+                auto found = entryOfClass.find(f2.ha[l - 1]);
+                if (found == entryOfClass.end()) continue;
+                hasMatches = true;
+                Entry &entry = entries[found->second];
+                entry.line2 = entry.line2 ? NonUnique : l;
+            }
+
+            if (!hasMatches) {
+                while (count1--) {
+                    f1.rchg[line1++ - 1] = 1;
+                }
+                while (count2--) {
+                    f2.rchg[line2++ - 1] = 1;
+                }
+                return;
+            }
+
+            // Longest increasing sequence of line2 among the unique common lines
+            std::vector<long> sequence(entries.size());
+            long longest = 0;
+            for (long k = 0; k < long(entries.size()); ++k) {
+                Entry &entry = entries[k];
+                if (!entry.line2 || entry.line2 == NonUnique) continue;
+                long left = -1, right = longest;
+                while (left + 1 < right) {
+                    long middle = left + (right - left) / 2;
+                    if (entries[sequence[middle]].line2 > entry.line2) {
+                        right = middle;
+                    } else {
+                        left = middle;
+                    }
+                }
+                entry.previous = left < 0 ? -1 : sequence[left];
+                sequence[left + 1] = k;
+                if (left + 1 == longest) longest++;
+            }
+
+            if (!longest) {
+                classicDiff(&f1.ha[line1 - 1], count1, &f2.ha[line2 - 1], count2,
+                    f1.rchg + line1 - 1, f2.rchg + line2 - 1, false);
+                return;
+            }
+
+            std::vector<long> chain;
+            for (long k = sequence[longest - 1]; k >= 0; k = entries[k].previous) {
+                chain.push_back(k);
+            }
+            std::reverse(chain.begin(), chain.end());
+
+            auto match = [&](long l1, long l2) {
+                return f1.ha[l1 - 1] == f2.ha[l2 - 1];
+            };
+
+            const long end1 = line1 + count1, end2 = line2 + count2;
+            size_t ci = 0;
+            for (;;) {
+                long next1, next2;
+                if (ci < chain.size()) {
+                    next1 = entries[chain[ci]].line1;
+                    next2 = entries[chain[ci]].line2;
+                    while (next1 > line1 && next2 > line2 && match(next1 - 1, next2 - 1)) {
+                        next1--;
+                        next2--;
+                    }
+                } else {
+                    next1 = end1;
+                    next2 = end2;
+                }
+                while (line1 < next1 && line2 < next2 && match(line1, line2)) {
+                    line1++;
+                    line2++;
+                }
+
+                if (next1 > line1 || next2 > line2) {
+                    patienceDiff(f1, f2, line1, next1 - line1, line2, next2 - line2);
+                }
+
+                if (ci >= chain.size()) return;
+
+                while (ci + 1 < chain.size() &&
+                       entries[chain[ci + 1]].line1 == entries[chain[ci]].line1 + 1 &&
+                       entries[chain[ci + 1]].line2 == entries[chain[ci]].line2 + 1) {
+                    ci++;
+                }
+                line1 = entries[chain[ci]].line1 + 1;
+                line2 = entries[chain[ci]].line2 + 1;
+                ci++;
+            }
+        }
+
+        // Histogram ---------------------------------------------------------------------------
+
+        struct Region
+        {
+            unsigned begin1, end1;
+            unsigned begin2, end2;
+        };
+
+        struct HistIndex
+        {
+            struct Record
+            {
+                unsigned ptr, cnt;
+            };
+            std::vector<Record> records;
+            std::unordered_map<long, unsigned> recordOfClass;
+            std::vector<unsigned> lineMap;   // Line to record
+            std::vector<unsigned> nextPtrs;  // Line to next occurrence, 0 if none
+            unsigned ptrShift;
+            unsigned cnt;
+            bool hasCommon = false;
+        };
+
+        unsigned hashBits(unsigned size)
+        {
+            unsigned val = 1, bits = 0;
+            for (; val < size && bits < CHAR_BIT * sizeof(unsigned); val <<= 1, bits++) {
+            }
+            return bits ? bits : 1;
+        }
+
+        inline unsigned long hashLong(unsigned long v, unsigned bits)
+        {
+            return (v + (v >> ((CHAR_BIT * sizeof(unsigned long)) - bits))) & ((1UL << bits) - 1);
+        }
+
+        // Returns -1 on failure, 1 to fall back to Myers, 0 when lcs is filled (or empty)
+        int findLcs(const File &f1, const File &f2, Region &lcs, long line1, long count1,
+            long line2, long count2)
+        {
+            HistIndex index;
+            index.ptrShift = line1;
+            index.lineMap.assign(count1, 0);
+            index.nextPtrs.assign(count1, 0);
+
+            // scanA(), hash chains only matter for their length limit
+            const unsigned tableBits = hashBits(count1);
+            std::vector<unsigned> chainLengths(size_t(1) << tableBits);
+            for (long ptr = line1 + count1 - 1; line1 <= ptr; ptr--) {
+                const long cls = f1.ha[ptr - 1];
+                auto found = index.recordOfClass.find(cls);
+                if (found != index.recordOfClass.end()) {
+                    HistIndex::Record &rec = index.records[found->second];
+                    index.nextPtrs[ptr - index.ptrShift] = rec.ptr;
+                    rec.ptr = ptr;
+                    rec.cnt = std::min<unsigned>(INT_MAX, rec.cnt + 1);
+                    index.lineMap[ptr - index.ptrShift] = found->second;
+                    continue;
+                }
+                unsigned &chainLength = chainLengths[hashLong(cls, tableBits)];
+                if (chainLength == HistogramMaxChainLength) return -1;
+                chainLength++;
+                index.recordOfClass.emplace(cls, unsigned(index.records.size()));
+                index.lineMap[ptr - index.ptrShift] = index.records.size();
+                index.records.push_back({unsigned(ptr), 1});
+            }
+
+            auto cmp = [&](unsigned l1, unsigned l2) {
+                return f1.ha[l1 - 1] == f2.ha[l2 - 1];
+            };
+            auto cnt = [&](unsigned ptr) {
+                return index.records[index.lineMap[ptr - index.ptrShift]].cnt;
+            };
+            auto nextPtr = [&](unsigned ptr) {
+                return index.nextPtrs[ptr - index.ptrShift];
+            };
+            const unsigned lineEnd1 = line1 + count1 - 1;
+            const unsigned lineEnd2 = line2 + count2 - 1;
+
+            index.cnt = HistogramMaxChainLength + 1;
+            for (unsigned bPtr = line2; bPtr <= lineEnd2;) {
+                // try_lcs()
+                unsigned bNext = bPtr + 1;
+                auto found = index.recordOfClass.find(f2.ha[bPtr - 1]);
+                if (found != index.recordOfClass.end()) {
+                    const HistIndex::Record &rec = index.records[found->second];
+                    if (rec.cnt > index.cnt) {
+                        index.hasCommon = true;
+                    } else {
+                        index.hasCommon = true;
+                        unsigned as = rec.ptr, ae, bs, be, np, rc;
+                        for (;;) {
+                            np = nextPtr(as);
+                            bs = bPtr;
+                            ae = as;
+                            be = bs;
+                            rc = rec.cnt;
+
+                            while (line1 < as && line2 < bs && cmp(as - 1, bs - 1)) {
+                                as--;
+                                bs--;
+                                if (1 < rc) rc = std::min(rc, cnt(as));
+                            }
+                            while (ae < lineEnd1 && be < lineEnd2 && cmp(ae + 1, be + 1)) {
+                                ae++;
+                                be++;
+                                if (1 < rc) rc = std::min(rc, cnt(ae));
+                            }
+
+                            if (bNext <= be) bNext = be + 1;
+                            if (lcs.end1 - lcs.begin1 < ae - as || rc < index.cnt) {
+                                lcs.begin1 = as;
+                                lcs.begin2 = bs;
+                                lcs.end1 = ae;
+                                lcs.end2 = be;
+                                index.cnt = rc;
+                            }
+
+                            if (np == 0) break;
+                            while (np && np <= ae) {
+                                np = nextPtr(np);
+                            }
+                            if (np == 0) break;
+                            as = np;
+                        }
+                    }
+                }
+                bPtr = bNext;
+            }
+
+            return index.hasCommon && HistogramMaxChainLength < index.cnt ? 1 : 0;
+        }
+
+        bool histogramDiff(File &f1, File &f2, long line1, long count1, long line2, long count2)
+        {
+            for (;;) {
+                if (count1 <= 0 && count2 <= 0) return true;
+
+                if (!count1) {
+                    while (count2--) {
+                        f2.rchg[line2++ - 1] = 1;
+                    }
+                    return true;
+                } else if (!count2) {
+                    while (count1--) {
+                        f1.rchg[line1++ - 1] = 1;
+                    }
+                    return true;
+                }
+
+                Region lcs = {0, 0, 0, 0};
+                int lcsFound = findLcs(f1, f2, lcs, line1, count1, line2, count2);
+                if (lcsFound < 0) {
+                    return false;
+                } else if (lcsFound) {
+                    classicDiff(&f1.ha[line1 - 1], count1, &f2.ha[line2 - 1], count2,
+                        f1.rchg + line1 - 1, f2.rchg + line2 - 1, false);
+                    return true;
+                } else if (lcs.begin1 == 0 && lcs.begin2 == 0) {
+                    while (count1--) {
+                        f1.rchg[line1++ - 1] = 1;
+                    }
+                    while (count2--) {
+                        f2.rchg[line2++ - 1] = 1;
+                    }
+                    return true;
+                }
+
+                if (!histogramDiff(f1, f2, line1, lcs.begin1 - line1, line2, lcs.begin2 - line2)) {
+                    return false;
+                }
+                count1 = line1 + count1 - 1 - lcs.end1;
+                line1 = lcs.end1 + 1;
+                count2 = line2 + count2 - 1 - lcs.end2;
+                line2 = lcs.end2 + 1;
+            }
+        }
+
+        // Compaction --------------------------------------------------------------------------
+
+        struct SplitMeasurement
+        {
+            bool endOfFile;
+            int indent;
+            int preBlank;
+            int preIndent;
+            int postBlank;
+            int postIndent;
+        };
+
+        struct SplitScore
+        {
+            int effectiveIndent;
+            int penalty;
+        };
+
+        struct Group
+        {
+            long start;
+            long end;
+        };
+
+        int getIndent(std::string_view rec)
+        {
+            int ret = 0;
+            for (char c : rec) {
+                if (!isSpace(c)) {
+                    return ret;
+                } else if (c == ' ') {
+                    ret += 1;
+                } else if (c == '\t') {
+                    ret += 8 - ret % 8;
+                }
+                if (ret >= MaxIndent) return MaxIndent;
+            }
+            // The line contains only whitespace
+            return -1;
+        }
+
+        void measureSplit(const File &f, long split, SplitMeasurement &m)
+        {
+            if (split >= f.nrec) {
+                m.endOfFile = true;
+                m.indent = -1;
+            } else {
+                m.endOfFile = false;
+                m.indent = getIndent(f.recs[split]);
+            }
+
+            m.preBlank = 0;
+            m.preIndent = -1;
+            for (long i = split - 1; i >= 0; i--) {
+                m.preIndent = getIndent(f.recs[i]);
+                if (m.preIndent != -1) break;
+                m.preBlank += 1;
+                if (m.preBlank == MaxBlanks) {
+                    m.preIndent = 0;
+                    break;
+                }
+            }
+
+            m.postBlank = 0;
+            m.postIndent = -1;
+            for (long i = split + 1; i < f.nrec; i++) {
+                m.postIndent = getIndent(f.recs[i]);
+                if (m.postIndent != -1) break;
+                m.postBlank += 1;
+                if (m.postBlank == MaxBlanks) {
+                    m.postIndent = 0;
+                    break;
+                }
+            }
+        }
+
+        void scoreAddSplit(const SplitMeasurement &m, SplitScore &s)
+        {
+            if (m.preIndent == -1 && m.preBlank == 0) s.penalty += StartOfFilePenalty;
+            if (m.endOfFile) s.penalty += EndOfFilePenalty;
+
+            int postBlank = (m.indent == -1) ? 1 + m.postBlank : 0;
+            int totalBlank = m.preBlank + postBlank;
+
+            s.penalty += TotalBlankWeight * totalBlank;
+            s.penalty += PostBlankWeight * postBlank;
+
+            int indent = m.indent != -1 ? m.indent : m.postIndent;
+            bool anyBlanks = totalBlank != 0;
+
+            s.effectiveIndent += indent;
+
+            if (indent == -1 || m.preIndent == -1) {
+                // No additional adjustments needed
+            } else if (indent > m.preIndent) {
+                s.penalty += anyBlanks ? RelativeIndentWithBlankPenalty : RelativeIndentPenalty;
+            } else if (indent == m.preIndent) {
+                // No additional adjustments needed
+            } else if (m.postIndent != -1 && m.postIndent > indent) {
+                s.penalty += anyBlanks ? RelativeOutdentWithBlankPenalty : RelativeOutdentPenalty;
+            } else {
+                s.penalty += anyBlanks ? RelativeDedentWithBlankPenalty : RelativeDedentPenalty;
+            }
+        }
+
+        int scoreCmp(const SplitScore &s1, const SplitScore &s2)
+        {
+            int cmpIndents = (s1.effectiveIndent > s2.effectiveIndent) -
+                             (s1.effectiveIndent < s2.effectiveIndent);
+            return IndentWeight * cmpIndents + (s1.penalty - s2.penalty);
+        }
+
+        void groupInit(const File &f, Group &g)
+        {
+            g.start = g.end = 0;
+            while (f.rchg[g.end]) {
+                g.end++;
+            }
+        }
+
+        bool groupNext(const File &f, Group &g)
+        {
+            if (g.end == f.nrec) return false;
+            g.start = g.end + 1;
+            for (g.end = g.start; f.rchg[g.end]; g.end++) {
+            }
+            return true;
+        }
+
+        bool groupPrevious(const File &f, Group &g)
+        {
+            if (g.start == 0) return false;
+            g.end = g.start - 1;
+            for (g.start = g.end; f.rchg[g.start - 1]; g.start--) {
+            }
+            return true;
+        }
+
+        bool groupSlideDown(File &f, Group &g)
+        {
+            if (g.end < f.nrec && f.ha[g.start] == f.ha[g.end]) {
+                f.rchg[g.start++] = 0;
+                f.rchg[g.end++] = 1;
+                while (f.rchg[g.end]) {
+                    g.end++;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        bool groupSlideUp(File &f, Group &g)
+        {
+            if (g.start > 0 && f.ha[g.start - 1] == f.ha[g.end - 1]) {
+                f.rchg[--g.start] = 1;
+                f.rchg[--g.end] = 0;
+                while (f.rchg[g.start - 1]) {
+                    g.start--;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // Slide each group of changes to its most readable position, keeping both files in sync
+        void changeCompact(File &f, File &fo, bool indentHeuristic)
+        {
+            Group g, go;
+            long earliestEnd, endMatchingOther, groupSize;
+
+            groupInit(f, g);
+            groupInit(fo, go);
+
+            while (true) {
+                if (g.end != g.start) {
+                    do {
+                        groupSize = g.end - g.start;
+                        endMatchingOther = -1;
+
+                        while (groupSlideUp(f, g)) {
+                            groupPrevious(fo, go);
+                        }
+                        earliestEnd = g.end;
+                        if (go.end > go.start) endMatchingOther = g.end;
+
+                        while (groupSlideDown(f, g)) {
+                            groupNext(fo, go);
+                            if (go.end > go.start) endMatchingOther = g.end;
+                        }
+                    } while (groupSize != g.end - g.start);
+
+                    if (g.end == earliestEnd) {
+                        // No shifting was possible
+                    } else if (endMatchingOther != -1) {
+                        // Line up with the last group of changes in the other file
+                        while (go.end == go.start) {
+                            groupSlideUp(f, g);
+                            groupPrevious(fo, go);
+                        }
+                    } else if (indentHeuristic) {
+                        long shift, bestShift = -1;
+                        SplitScore bestScore = {0, 0};
+
+                        shift = earliestEnd;
+                        if (g.end - groupSize - 1 > shift) shift = g.end - groupSize - 1;
+                        if (g.end - IndentHeuristicMaxSliding > shift) {
+                            shift = g.end - IndentHeuristicMaxSliding;
+                        }
+                        for (; shift <= g.end; shift++) {
+                            SplitMeasurement m;
+                            SplitScore score = {0, 0};
+
+                            measureSplit(f, shift, m);
+                            scoreAddSplit(m, score);
+                            measureSplit(f, shift - groupSize, m);
+                            scoreAddSplit(m, score);
+                            if (bestShift == -1 || scoreCmp(score, bestScore) <= 0) {
+                                bestScore = score;
+                                bestShift = shift;
+                            }
+                        }
+
+                        while (g.end > bestShift) {
+                            groupSlideUp(f, g);
+                            groupPrevious(fo, go);
+                        }
+                    }
+                }
+
+                if (!groupNext(f, g)) break;
+                groupNext(fo, go);
+            }
+        }
+
+        // Emission ----------------------------------------------------------------------------
+
+        struct Change
+        {
+            long i1, i2;
+            long chg1, chg2;
+        };
+
+        std::vector<Change> buildScript(const File &f1, const File &f2)
+        {
+            std::vector<Change> script;
+            const char *rchg1 = f1.rchg, *rchg2 = f2.rchg;
+            for (long i1 = f1.nrec, i2 = f2.nrec; i1 >= 0 || i2 >= 0; i1--, i2--) {
+                if (rchg1[i1 - 1] || rchg2[i2 - 1]) {
+                    long l1 = i1, l2 = i2;
+                    for (; rchg1[i1 - 1]; i1--) {
+                    }
+                    for (; rchg2[i2 - 1]; i2--) {
+                    }
+                    script.push_back({i1, i2, l1 - i1, l2 - i2});
+                }
+            }
+            std::reverse(script.begin(), script.end());
+            return script;
+        }
+
+        // git's default funcname matcher, def_ff()
+        bool matchFuncLine(std::string_view rec, std::string_view &func)
+        {
+            if (rec.empty() || !(isAlpha(rec[0]) || rec[0] == '_' || rec[0] == '$')) return false;
+            size_t len = std::min(rec.size(), FuncLineMax);
+            while (len > 0 && isSpace(rec[len - 1])) {
+                len--;
+            }
+            func = rec.substr(0, len);
+            return true;
+        }
+
+        std::string hunkHeader(long s1, long c1, long s2, long c2, std::string_view func)
+        {
+            std::string header = "@@ -" + std::to_string(c1 ? s1 : s1 - 1);
+            if (c1 != 1) header += "," + std::to_string(c1);
+            header += " +" + std::to_string(c2 ? s2 : s2 - 1);
+            if (c2 != 1) header += "," + std::to_string(c2);
+            header += " @@";
+            if (!func.empty()) {
+                header += ' ';
+                header += func;
+            }
+            return header;
+        }
+
+        std::vector<Hunk> emitHunks(const File &f1, const File &f2, const std::vector<Change> &script,
+            long ctxLen)
+        {
+            std::vector<Hunk> hunks;
+            std::string_view funcLine;
+            long funcLinePrev = -1;
+
+            size_t next = 0;
+            while (next < script.size()) {
+                // Merge changes whose gap fits in the surrounding context
+                const size_t first = next;
+                size_t last = next;
+                while (last + 1 < script.size() &&
+                       script[last + 1].i1 - (script[last].i1 + script[last].chg1) <= 2 * ctxLen) {
+                    last++;
+                }
+                next = last + 1;
+                const Change &xch = script[first];
+                const Change &xche = script[last];
+
+                long s1 = std::max(xch.i1 - ctxLen, 0L);
+                long s2 = std::max(xch.i2 - ctxLen, 0L);
+                long lctx = ctxLen;
+                lctx = std::min(lctx, f1.nrec - (xche.i1 + xche.chg1));
+                lctx = std::min(lctx, f2.nrec - (xche.i2 + xche.chg2));
+                const long e1 = xche.i1 + xche.chg1 + lctx;
+                const long e2 = xche.i2 + xche.chg2 + lctx;
+
+                // Keeps the previous function name when none is found in between
+                for (long l = s1 - 1; l != funcLinePrev && 0 <= l && l < f1.nrec; l--) {
+                    if (matchFuncLine(f1.recs[l], funcLine)) break;
+                }
+                funcLinePrev = s1 - 1;
+
+                Hunk &hunk = hunks.emplace_back();
+                hunk.header = hunkHeader(s1 + 1, e1 - s1, s2 + 1, e2 - s2, funcLine);
+
+                for (; s2 < xch.i2; s2++) {
+                    hunk.lines.push_back({' ', f2.recs[s2]});
+                }
+                s1 = xch.i1;
+                s2 = xch.i2;
+                for (size_t c = first;; ++c) {
+                    const Change &change = script[c];
+                    for (; s1 < change.i1 && s2 < change.i2; s1++, s2++) {
+                        hunk.lines.push_back({' ', f2.recs[s2]});
+                    }
+                    for (s1 = change.i1; s1 < change.i1 + change.chg1; s1++) {
+                        hunk.lines.push_back({'-', f1.recs[s1]});
+                    }
+                    for (s2 = change.i2; s2 < change.i2 + change.chg2; s2++) {
+                        hunk.lines.push_back({'+', f2.recs[s2]});
+                    }
+                    if (c == last) break;
+                    s1 = change.i1 + change.chg1;
+                    s2 = change.i2 + change.chg2;
+                }
+
+                for (s2 = xche.i2 + xche.chg2; s2 < e2; s2++) {
+                    hunk.lines.push_back({' ', f2.recs[s2]});
+                }
+            }
+            return hunks;
+        }
+
+    }  // namespace
+
+    bool isBinary(std::string_view data)
+    {
+        return std::memchr(data.data(), 0, std::min(data.size(), BinaryCheckBytes)) != nullptr;
+    }
+
+    bool diff(std::string_view a, std::string_view b, const Options &options,
+        std::vector<Hunk> &hunks)
+    {
+        std::unordered_map<std::string_view, long> classes;
+        File f1, f2;
+        f1.init(a, classes);
+        f2.init(b, classes);
+
+        switch (options.algorithm) {
+            case Patience:
+                patienceDiff(f1, f2, 1, f1.nrec, 1, f2.nrec);
+                break;
+            case Histogram:
+                if (!histogramDiff(f1, f2, 1, f1.nrec, 1, f2.nrec)) return false;
+                break;
+            default:
+                classicDiff(f1.ha.data(), f1.nrec, f2.ha.data(), f2.nrec, f1.rchg, f2.rchg,
+                    options.algorithm == Minimal);
+                break;
+        }
+
+        changeCompact(f1, f2, options.indentHeuristic);
+        changeCompact(f2, f1, options.indentHeuristic);
+        hunks = emitHunks(f1, f2, buildScript(f1, f2), options.contextLines);
+        return true;
+    }
+
+}  // namespace xdiff
@@ -0,0 +1,53 @@
+// Copyright (C) 2003-2016 Davide Libenzi, Johannes E. Schindelin, Git contributors
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Line matching and hunk emission ported from git's xdiff (xprepare.c, xdiffi.c,
+// xpatience.c, xhistogram.c, xemit.c), so that hunks are identical to `git diff`.
+
+#ifndef XDIFF_H
+#define XDIFF_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xdiff {
+
+    enum Algorithm
+    {
+        Myers = 0,
+        Minimal,
+        Patience,
+        Histogram,
+    };
+
+    struct Options
+    {
+        Algorithm algorithm = Myers;
+        bool indentHeuristic = true;
+        long contextLines = 3;
+    };
+
+    struct Line
+    {
+        char origin;            // ' ', '-' or '+'
+        std::string_view text;  // Including the trailing '\n', missing on an incomplete last line
+    };
+
+    struct Hunk
+    {
+        std::string header;  // "@@ -a,b +c,d @@ funcname", without newline
+        std::vector<Line> lines;
+    };
+
+    // Same check as git's buffer_is_binary()
+    bool isBinary(std::string_view data);
+
+    // Returned lines point into a and b, which must outlive the result. Fails only where git
+    // itself gives up (histogram chains over the limit).
+    bool diff(std::string_view a, std::string_view b, const Options &options,
+        std::vector<Hunk> &hunks);
+
+}  // namespace xdiff
+
+#endif  // XDIFF_H
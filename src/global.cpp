@@ -1,6 +1,9 @@
 #include "global.h"
 
 #include <QDir>
+#include <QFile>
+
+#include <sys/stat.h>
 
 namespace global {
     int commitPageSize = 100;
@@ -26,4 +29,45 @@ namespace global {
         return process.readAll();
     }
 
+    QByteArray getCmdOutput(
+        const QString &program, const QStringList &arguments, const QString &dir)
+    {
+        qDebug() << "Cmd:" << program << arguments;
+        QProcess process;
+        process.setWorkingDirectory(dir);
+        // Not merged with stderr, a warning would end up in the middle of the records
+        process.start(program, arguments, QIODeviceBase::ReadOnly);
+        if (!process.waitForFinished(-1) || process.error() == QProcess::FailedToStart) return {};
+        return process.readAllStandardOutput();
+    }
+
+    FileStat statFile(const QString &path, bool followLinks)
+    {
+        FileStat fileStat;
+        struct stat st;
+        const QByteArray name = QFile::encodeName(path);
+        if ((followLinks ? stat(name.constData(), &st) : lstat(name.constData(), &st)) == 0) {
+            fileStat.exists = true;
+            fileStat.mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+            fileStat.size = st.st_size;
+            fileStat.inode = st.st_ino;
+        }
+        return fileStat;
+    }
+
+    bool isUnmerged(const QString &mode)
+    {
+        return mode == "AA" || mode == "DD" || mode.contains("U");
+    }
+
+    bool isInPaths(const QString &path, const QStringList &paths)
+    {
+        for (const QString &p : paths) {
+            if (path == p || (path.startsWith(p) && path[p.size()] == '/')) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 }  // namespace global
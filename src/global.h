@@ -40,6 +40,9 @@ struct GitFile
     }
     QString path;
     QString mode;
+    // Blob ids of a status entry, empty when not known
+    QString headOid;
+    QString indexOid;
 
     friend bool operator==(const GitFile &f1, const GitFile &f2) noexcept
     {
@@ -52,6 +55,25 @@ namespace global {
 
     extern int getCmdCode(const QString &cmd, const QString &dir);
     extern QString getCmdResult(const QString &cmd, const QString &dir);
+    // Standard output only, for output that is parsed
+    extern QByteArray getCmdOutput(
+        const QString &program, const QStringList &arguments, const QString &dir);
+
+    // What git's stat data check looks at, to tell a file changed without reading it
+    struct FileStat
+    {
+        bool exists = false;
+        qint64 mtime = 0;  // Nanoseconds
+        qint64 size = -1;
+        quint64 inode = 0;
+    };
+    // Of the symlink itself unless followLinks, like lstat
+    extern FileStat statFile(const QString &path, bool followLinks = true);
+
+    // Of a GitFile: a status mode of a path with conflicts, e.g. "UU" or "AA"
+    extern bool isUnmerged(const QString &mode);
+    // path is one of paths or inside one of them
+    extern bool isInPaths(const QString &path, const QStringList &paths);
 }  // namespace global
 
 #endif  // GLOBAL_H
@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QFileInfo>
 
+#include "benchmark.h"
 #include "mainwindow.h"
 #include "themes/repomanstyle.h"
 
@@ -15,6 +16,9 @@ using namespace utils;
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    if (a.arguments().size() > 1 && a.arguments().at(1) == "--benchmark") {
+        return benchmark::run(a.arguments().mid(2));
+    }
     QSettings settings;
 
     a.setStyle(new RepoManStyle());
@@ -12,14 +12,22 @@
 #include <QSettings>
 #include <QStandardPaths>
 #include <QTextCodec>
+#include <QTimer>
 #include <QToolButton>
 #include <QtConcurrent>
+#include <memory>
 
 #include "dialogs/cmddialog.h"
+#include "dialogs/multiprojectopdialog.h"
+#include "dialogs/refsearchdialog.h"
 #include "dialogs/repoinitdialog.h"
 #include "dialogs/reposyncdialog.h"
 #include "dialogs/switchmanifestdialog.h"
+#include "manifestparser.h"
+#include "pages/dashboardpage.h"
+#include "pages/manifestdeltapage.h"
 #include "pages/newtabpage.h"
+#include "pages/timelinepage.h"
 #include "themes/icon.h"
 #include "themes/theme.h"
 #include "ui_mainwindow.h"
@@ -27,9 +35,12 @@
 using namespace global;
 using namespace utils;
 
+static const int maxWarmingUp = 2;
+
 MainWindow::MainWindow(QString repoPath)
     : QMainWindow(nullptr), ui(new Ui::MainWindow), m_context(repoPath)
 {
+    m_startupTimer.start();
     ui->setupUi(this);
     move(screen()->geometry().center() - frameGeometry().center());
 
@@ -42,6 +53,13 @@ MainWindow::MainWindow(QString repoPath)
     connect(ui->actionRepo_Switch_manifest, &QAction::triggered, this, &MainWindow::onAction);
     connect(ui->actionRepo_Start, &QAction::triggered, this, &MainWindow::onAction);
     connect(ui->actionRepo_Sync, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionRepo_Status, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionRepo_Run_on_Projects, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionRepo_Timeline, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionRepo_Find_Refs, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionRepo_Manifest_Delta, &QAction::triggered, this, &MainWindow::onAction);
+    connect(ui->actionProject_Status_Performance, &QAction::triggered, this,
+        &MainWindow::onAction);
     connect(ui->actionHelp_About, &QAction::triggered, this, &MainWindow::onAction);
 
     // ToolBar
@@ -94,10 +112,10 @@ MainWindow::MainWindow(QString repoPath)
         saveTabs();
     });
 
-    if (m_context.isValid()) {
+    loadManifestAsync(repoPath, [this]() {
         updateUI();
         restoreTabs();
-    }
+    });
 }
 
 MainWindow::~MainWindow()
@@ -130,15 +148,29 @@ void MainWindow::onAction()
         onActionRepoSync();
     } else if (action == ui->actionRepo_Start) {
         onActionRepoStart();
+    } else if (action == ui->actionRepo_Status) {
+        onActionRepoStatus();
+    } else if (action == ui->actionRepo_Run_on_Projects) {
+        onActionRepoRunOnProjects();
+    } else if (action == ui->actionRepo_Timeline) {
+        onActionRepoTimeline();
+    } else if (action == ui->actionRepo_Find_Refs) {
+        onActionRepoFindRefs();
+    } else if (action == ui->actionRepo_Manifest_Delta) {
+        onActionRepoManifestDelta();
     } else if (action == ui->actionRepo_Switch_manifest || action == m_actionRepoSwitchManifest) {
         SwitchManifestDialog dialog(this, m_context);
         if (dialog.exec()) {
-            m_context.loadManifest();
-            updateUI();
-            if (dialog.syncAfterSwitch()) {
-                onActionRepoSync();
-            }
+            const bool syncAfterSwitch = dialog.syncAfterSwitch();
+            loadManifestAsync(m_context.repoPath(), [this, syncAfterSwitch]() {
+                updateUI();
+                if (syncAfterSwitch) {
+                    onActionRepoSync();
+                }
+            });
         }
+    } else if (action == ui->actionProject_Status_Performance) {
+        onProjectAction(&PageHost::onActionStatusCache);
     } else if (action == ui->actionHelp_About) {
         QMessageBox::about(this, "RepoMan", "Repo GUI front-end");
     } else if (action == m_actionPush) {
@@ -163,7 +195,7 @@ void MainWindow::onProjectAction(void (PageHost::*func)())
         return;
     }
     auto data = ui->tabWidget->tabData(index).value<TabData>();
-    if (!data.isNewTab) {
+    if (!data.isNewTab && !data.isRepoPage) {
         (static_cast<PageHost *>(data.page)->*func)();
     }
 }
@@ -193,9 +225,50 @@ int MainWindow::addTab(const Project &project, bool isNewTab, int index)
     return newIndex;
 }
 
+int MainWindow::addRepoPageTab(QWidget *page, const QString &title)
+{
+    TabData data;
+    data.isRepoPage = true;
+    data.page = page;
+    int newIndex = ui->tabWidget->addTab(page, title);
+    ui->tabWidget->setTabData(newIndex, QVariant::fromValue(data));
+    return newIndex;
+}
+
+template<typename T>
+bool MainWindow::showRepoPageTab()
+{
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        if (qobject_cast<T *>(ui->tabWidget->widget(i))) {
+            ui->tabWidget->setCurrentIndex(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+PageHost *MainWindow::openProjectNextTo(QWidget *page, const Project &project)
+{
+    // Next to the repo page, which stays open
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        auto data = ui->tabWidget->tabData(i).value<TabData>();
+        if (!data.isNewTab && !data.isRepoPage && data.project.path == project.path) {
+            ui->tabWidget->setCurrentIndex(i);
+            return static_cast<PageHost *>(data.page);
+        }
+    }
+    int newIndex = addTab(project, false, ui->tabWidget->indexOf(page) + 1);
+    ui->tabWidget->setCurrentIndex(newIndex);
+    saveTabs();
+    return static_cast<PageHost *>(ui->tabWidget->widget(newIndex));
+}
+
 void MainWindow::closeTab(int index)
 {
     auto data = ui->tabWidget->tabData(index).value<TabData>();
+    m_warmUpQueue.removeIf([&data](const QPointer<PageHost> &page) {
+        return page == data.page;
+    });
     ui->tabWidget->removeTab(index);
     data.page->deleteLater();
 }
@@ -222,7 +295,7 @@ void MainWindow::saveTabs()
     int count = ui->tabWidget->count();
     for (int i = 0; i < count; ++i) {
         auto data = ui->tabWidget->tabData(i).value<TabData>();
-        if (data.isNewTab) continue;
+        if (data.isNewTab || data.isRepoPage) continue;
         value.append(data.project.path);
         if (i < count - 1) value.append(";");
     }
@@ -237,14 +310,107 @@ void MainWindow::restoreTabs()
     if (value.isEmpty()) {
         addTab(Project(), true);
     } else {
+        // Only the current tab loads right away, the others when shown or warmed up
+        const ManifestPtr manifest = m_context.manifest();
         for (const QString &path : value.split(";")) {
-            addTab(m_context.manifest().projectMap.value(path));
+            if (const Project *project = manifest->findProject(path)) {
+                addTab(*project);
+            }
+        }
+        if (ui->tabWidget->count() == 0) {
+            addTab(Project(), true);
         }
     }
+
+    const qint64 restoredMs = m_startupTimer.elapsed();
+    auto current = qobject_cast<PageHost *>(ui->tabWidget->currentWidget());
+    if (!current) {
+        qInfo() << "Startup: interactive after" << restoredMs << "ms";
+        return;
+    }
+    m_warmUpQueue.clear();
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        auto page = qobject_cast<PageHost *>(ui->tabWidget->widget(i));
+        if (page && page != current) {
+            m_warmUpQueue.append(page);
+        }
+    }
+    // The tabs in the background wait for the one in front
+    const int tabCount = ui->tabWidget->count();
+    connect(
+        current, &PageHost::warmedUp, this,
+        [this, restoredMs, tabCount]() {
+            qInfo() << "Startup:" << tabCount << "tabs restored after" << restoredMs
+                    << "ms, interactive after" << m_startupTimer.elapsed() << "ms";
+            warmUpNext();
+        },
+        Qt::SingleShotConnection);
+    current->activate();
+}
+
+void MainWindow::warmUpNext()
+{
+    while (m_warmingUp < maxWarmingUp && !m_warmUpQueue.isEmpty()) {
+        QPointer<PageHost> page = m_warmUpQueue.takeFirst();
+        if (page.isNull() || page->isActivated()) {
+            continue;
+        }
+        ++m_warmingUp;
+        // Once per page, whether it loaded or its tab was closed meanwhile
+        auto done = [this, finished = std::make_shared<bool>(false)]() {
+            if (*finished) return;
+            *finished = true;
+            --m_warmingUp;
+            if (m_warmingUp == 0 && m_warmUpQueue.isEmpty()) {
+                qInfo() << "Startup: all tabs warmed up after" << m_startupTimer.elapsed()
+                        << "ms";
+            }
+            // Lets pending input through between pages
+            QTimer::singleShot(0, this, &MainWindow::warmUpNext);
+        };
+        connect(page, &PageHost::warmedUp, this, done);
+        connect(page, &QObject::destroyed, this, done);
+        page->activate();
+    }
+}
+
+void MainWindow::loadManifestAsync(const QString &repoPath, const std::function<void()> &onLoaded)
+{
+    if (repoPath.isEmpty()) {
+        return;
+    }
+    // A big manifest with includes takes a while, the window shows meanwhile
+    m_statusLabel->setText("  Loading manifest...");
+    m_manifestWorker.cancel();
+    m_manifestWorker = QtConcurrent::run([repoPath]() {
+        return ManifestParser(repoPath).load();
+    });
+    QPointer thisPtr(this);
+    m_manifestWorker.then(qApp, [thisPtr, repoPath, onLoaded](const Manifest &manifest) {
+        if (thisPtr.isNull()) return;
+        if (manifest.filePath.isEmpty()) {
+            thisPtr->m_statusLabel->setText("  Cannot read the manifest of " + repoPath);
+            QMessageBox::warning(thisPtr, "Manifest", manifest.error.isEmpty()
+                                     ? "Cannot read the manifest of " + repoPath
+                                     : manifest.error);
+            return;
+        }
+        if (!manifest.error.isEmpty()) {
+            // Local manifests are read on their own, the rest of the manifest is usable
+            QMessageBox::warning(thisPtr, "Manifest", manifest.error);
+        }
+        // Pages and dialogs sharing the context pick the new manifest up from its state
+        if (thisPtr->m_context.repoPath() != repoPath) {
+            thisPtr->m_context = RepoContext(repoPath);
+        }
+        thisPtr->m_context.setManifest(manifest);
+        onLoaded();
+    });
 }
 
 void MainWindow::closeAllTabs()
 {
+    m_warmUpQueue.clear();
     while (ui->tabWidget->count()) {
         closeTab(0);
     }
@@ -262,10 +428,11 @@ void MainWindow::openRepo(const QString &path)
     msgBox.setDefaultButton(currentBtn);
     msgBox.exec();
     if (msgBox.clickedButton() == currentBtn) {
-        m_context = RepoContext(path);
-        updateUI();
-        closeAllTabs();
-        restoreTabs();
+        loadManifestAsync(path, [this]() {
+            updateUI();
+            closeAllTabs();
+            restoreTabs();
+        });
     } else if (msgBox.clickedButton() == newBtn) {
         auto win = new MainWindow(path);
         win->show();
@@ -284,7 +451,7 @@ void MainWindow::onActionRepoSync()
     int currentIndex = -1;
     for (int i = 0; i < ui->tabWidget->count(); ++i) {
         auto data = ui->tabWidget->tabData(i).value<TabData>();
-        if (!data.isNewTab) {
+        if (!data.isNewTab && !data.isRepoPage) {
             projects.append(data.project);
             if (i == ui->tabWidget->currentIndex()) {
                 currentIndex = projects.size() - 1;
@@ -295,9 +462,78 @@ void MainWindow::onActionRepoSync()
     dialog.exec();
 }
 
+void MainWindow::onActionRepoStatus()
+{
+    if (showRepoPageTab<DashboardPage>()) {
+        return;
+    }
+    auto page = new DashboardPage(m_context);
+    connect(page, &DashboardPage::projectDoubleClicked, this, [this, page](const Project &project) {
+        openProjectNextTo(page, project);
+    });
+    ui->tabWidget->setCurrentIndex(addRepoPageTab(page, "Status"));
+}
+
+void MainWindow::onActionRepoTimeline()
+{
+    if (showRepoPageTab<TimelinePage>()) {
+        return;
+    }
+    auto page = new TimelinePage(m_context);
+    connect(page, &TimelinePage::commitDoubleClicked, this,
+        [this, page](const Project &project, const QString &hash) {
+            openProjectNextTo(page, project)->showCommit(hash);
+        });
+    ui->tabWidget->setCurrentIndex(addRepoPageTab(page, "Timeline"));
+}
+
+void MainWindow::onActionRepoFindRefs()
+{
+    RefSearchDialog dialog(this, m_context);
+    if (!dialog.exec()) {
+        return;
+    }
+    const RefIndex::Match &match = dialog.selectedMatch();
+    const ManifestPtr manifest = m_context.manifest();
+    if (const Project *project = manifest->findProject(match.projectPath)) {
+        openProjectNextTo(ui->tabWidget->currentWidget(), *project)->showCommit(match.oid);
+    }
+}
+
+void MainWindow::onActionRepoManifestDelta()
+{
+    if (showRepoPageTab<ManifestDeltaPage>()) {
+        return;
+    }
+    auto page = new ManifestDeltaPage(m_context);
+    connect(page, &ManifestDeltaPage::commitDoubleClicked, this,
+        [this, page](const Project &project, const QString &hash) {
+            openProjectNextTo(page, project)->showCommit(hash);
+        });
+    ui->tabWidget->setCurrentIndex(addRepoPageTab(page, "Manifest Delta"));
+}
+
+QList<Project> MainWindow::openedProjects() const
+{
+    QList<Project> projects;
+    for (int i = 0; i < ui->tabWidget->count(); ++i) {
+        auto data = ui->tabWidget->tabData(i).value<TabData>();
+        if (!data.isNewTab && !data.isRepoPage) {
+            projects.append(data.project);
+        }
+    }
+    return projects;
+}
+
+void MainWindow::onActionRepoRunOnProjects()
+{
+    MultiProjectOpDialog dialog(this, m_context, openedProjects());
+    dialog.exec();
+}
+
 void MainWindow::onActionRepoStart()
 {
-    QString targetManifest = QFileInfo(m_context.manifest().filePath).symLinkTarget();
+    QString targetManifest = QFileInfo(m_context.manifest()->filePath).symLinkTarget();
     QString defName = QFileInfo(targetManifest).fileName().split(".").first();
 
     QInputDialog inputDlg(this);
@@ -333,8 +569,8 @@ void MainWindow::updateUI()
 {
     setWindowTitle(QString("%1 - %2").arg(m_context.repoPath(), QApplication::applicationName()));
 
-    QString targetManifest = QFileInfo(m_context.manifest().filePath).symLinkTarget();
+    QString targetManifest = QFileInfo(m_context.manifest()->filePath).symLinkTarget();
     m_statusLabel->setText(
         QString("  %1  |  %2")
-            .arg(QFileInfo(targetManifest).fileName(), m_context.manifest().revision));
+            .arg(QFileInfo(targetManifest).fileName(), m_context.manifest()->revision));
 }
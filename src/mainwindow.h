@@ -2,9 +2,13 @@
 #define MAINWINDOW_H
 
 #include <QComboBox>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QPointer>
 #include <QLabel>
 #include <QMainWindow>
 #include <QThreadPool>
+#include <functional>
 
 #include "pages/pagehost.h"
 #include "repocontext.h"
@@ -28,6 +32,7 @@ public:
         Project project;
         QWidget *page;
         bool isNewTab = false;
+        bool isRepoPage = false;  // Not bound to a project, e.g. the dashboard
     };
 
 private slots:
@@ -52,16 +57,34 @@ private:
     QComboBox *m_projectCombo;
 
     RepoContext m_context;
+    QFuture<Manifest> m_manifestWorker;
+    QElapsedTimer m_startupTimer;  // From the window created to the restored tab interactive
+    // Restored tabs not shown yet, activated a few at a time in the background
+    QList<QPointer<PageHost>> m_warmUpQueue;
+    int m_warmingUp = 0;
 
     void onActionOpen();
     void onActionRepoStart();
     void onActionRepoSync();
+    void onActionRepoStatus();
+    void onActionRepoRunOnProjects();
+    void onActionRepoTimeline();
+    void onActionRepoFindRefs();
+    void onActionRepoManifestDelta();
+    QList<Project> openedProjects() const;
     void onProjectAction(void (PageHost::*func)());
 
     void updateUI();
     int addTab(const Project &project, bool isNewTab = false, int index = -1);
+    int addRepoPageTab(QWidget *page, const QString &title);
+    template<typename T>
+    bool showRepoPageTab();
+    PageHost *openProjectNextTo(QWidget *page, const Project &project);
     void saveTabs();
     void restoreTabs();
+    void warmUpNext();
+    // Replaces the context once the manifest is parsed, then calls onLoaded
+    void loadManifestAsync(const QString &repoPath, const std::function<void()> &onLoaded);
     void closeAllTabs();
     void openRepo(const QString &path);
 
@@ -0,0 +1,441 @@
+#include "manifestparser.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+
+#include "global.h"
+
+static const quint32 snapshotMagic = 0x524d4d46;  // "RMMF"
+static const quint32 snapshotVersion = 3;
+
+static QStringList splitGroups(QStringView groups)
+{
+    static const QRegularExpression separator("[,\\s]+");
+    return groups.toString().split(separator, Qt::SkipEmptyParts);
+}
+
+static void indexProjects(Manifest &manifest)
+{
+    manifest.projectIndex.clear();
+    manifest.projectIndex.reserve(manifest.projectList.size());
+    for (int i = 0; i < manifest.projectList.size(); ++i) {
+        manifest.projectIndex.insert(manifest.projectList[i].path, i);
+    }
+}
+
+ManifestParser::ManifestParser(const QString &repoPath)
+    : m_repoPath(repoPath),
+      m_snapshotPath(QDir::cleanPath(repoPath + "/repoman.manifest")),
+      m_manifestsDir(QDir::cleanPath(repoPath + "/.repo/manifests"))
+{
+}
+
+Manifest ManifestParser::load()
+{
+    Manifest manifest;
+    if (readSnapshot(manifest)) {
+        return manifest;
+    }
+    manifest = parse();
+    manifest.error = m_error;
+    // Read again next time rather than trusted, e.g. a local manifest that is being edited
+    if (!manifest.filePath.isEmpty() && m_error.isEmpty()) {
+        writeSnapshot(manifest);
+    }
+    return manifest;
+}
+
+void ManifestParser::reset()
+{
+    m_files.clear();
+    m_includeStack.clear();
+    m_projects.clear();
+    m_remoteRevisions.clear();
+    m_defaultUpstream.clear();
+    m_defaultDestBranch.clear();
+    m_manifest = Manifest();
+    m_branch.clear();
+    m_error.clear();
+}
+
+void ManifestParser::setError(const QString &error)
+{
+    qWarning() << "Manifest:" << error;
+    if (m_error.isEmpty()) {
+        m_error = error;
+    }
+}
+
+Manifest ManifestParser::parse()
+{
+    reset();
+    if (m_repoPath.isEmpty()) {
+        return Manifest();
+    }
+
+    const QString manifestsDir = m_manifestsDir;
+    const QString manPath = QDir::cleanPath(m_repoPath + "/.repo/manifest.xml");
+    if (!parseFile(manPath, manifestsDir, {})) {
+        return Manifest();
+    }
+    m_manifest.filePath = manPath;
+
+    // Local manifests apply on top of the main one, in file name order
+    const QString localDir = QDir::cleanPath(m_repoPath + "/.repo/local_manifests");
+    m_files.append(stampOf(localDir));
+    const QFileInfoList localManifests =
+        QDir(localDir).entryInfoList({"*.xml"}, QDir::Files, QDir::Name);
+    for (const QFileInfo &info : localManifests) {
+        parseFile(info.filePath(), localDir, {});
+    }
+    const QString legacyPath = QDir::cleanPath(m_repoPath + "/.repo/local_manifest.xml");
+    if (QFile::exists(legacyPath)) {
+        parseFile(legacyPath, manifestsDir, {});
+    } else {
+        m_files.append(stampOf(legacyPath));
+    }
+
+    return build(manifestGroups());
+}
+
+Manifest ManifestParser::parseManifestFile(const QString &filePath)
+{
+    reset();
+    if (!parseFile(filePath, QFileInfo(filePath).absolutePath(), {})) {
+        return Manifest();
+    }
+    m_manifest.filePath = filePath;
+    return build(manifestGroups());
+}
+
+Manifest ManifestParser::parseManifestBranch(const QString &branch)
+{
+    reset();
+    m_branch = branch;
+    // Older repo versions link .repo/manifest.xml to the file, newer ones include it
+    QString manPath = QDir::cleanPath(m_repoPath + "/.repo/manifest.xml");
+    const QFileInfo info(manPath);
+    if (info.isSymLink()) {
+        manPath = m_manifestsDir + "/" + QFileInfo(info.symLinkTarget()).fileName();
+    }
+    const bool parsed = parseFile(manPath, m_manifestsDir, {});
+    m_branch.clear();
+    if (!parsed) {
+        return Manifest();
+    }
+    m_manifest.filePath = manPath;
+    return build(manifestGroups());
+}
+
+bool ManifestParser::readFile(const QString &path, QByteArray &data) const
+{
+    if (!m_branch.isEmpty() && path.startsWith(m_manifestsDir + "/")) {
+        QProcess git;
+        git.setWorkingDirectory(m_manifestsDir);
+        git.start("git", {"show", m_branch + ":" + path.mid(m_manifestsDir.size() + 1)},
+            QIODeviceBase::ReadOnly);
+        if (!git.waitForFinished(-1) || git.exitStatus() != QProcess::NormalExit ||
+            git.exitCode() != 0) {
+            return false;
+        }
+        data = git.readAllStandardOutput();
+        return true;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    data = file.readAll();
+    return true;
+}
+
+ManifestParser::FileStamp ManifestParser::stampOf(const QString &path)
+{
+    const global::FileStat st = global::statFile(path);
+    return {path, QFileInfo(path).symLinkTarget(), st.exists ? st.mtime : -1, st.size};
+}
+
+bool ManifestParser::parseFile(
+    const QString &path, const QString &includeRoot, const QStringList &groups)
+{
+    // Stamped before reading, a change while parsing invalidates the snapshot
+    m_files.append(stampOf(path));
+    QByteArray data;
+    if (!readFile(path, data)) {
+        setError("Cannot read " + path);
+        return false;
+    }
+    // Files on a branch need not exist on disk
+    QString canonicalPath = QFileInfo(path).canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        canonicalPath = path;
+    }
+    if (m_includeStack.contains(canonicalPath)) {
+        setError("Include cycle at " + path);
+        return false;
+    }
+    m_includeStack.append(canonicalPath);
+
+    QXmlStreamReader xml(data);
+    if (!xml.readNextStartElement() || xml.name() != u"manifest") {
+        if (!xml.hasError()) {
+            setError(path + " is not a manifest");
+            m_includeStack.removeLast();
+            return false;
+        }
+    } else {
+        while (xml.readNextStartElement()) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if (xml.name() == u"project") {
+                parseProject(xml, nullptr, groups);
+                continue;
+            }
+            if (xml.name() == u"include") {
+                // Without its includes a manifest looks complete but lacks projects
+                const QString name = attributes.value("name").toString();
+                if (!parseFile(QDir::cleanPath(includeRoot + "/" + name), includeRoot,
+                        groups + splitGroups(attributes.value("groups")))) {
+                    m_includeStack.removeLast();
+                    return false;
+                }
+            } else if (xml.name() == u"default") {
+                m_manifest.remote = attributes.value("remote").toString();
+                m_manifest.revision = attributes.value("revision").toString();
+                m_manifest.syncJ = attributes.value("sync-j").toInt();
+                m_defaultUpstream = attributes.value("upstream").toString();
+                m_defaultDestBranch = attributes.value("dest-branch").toString();
+            } else if (xml.name() == u"remote") {
+                if (attributes.hasAttribute("revision")) {
+                    m_remoteRevisions.insert(attributes.value("name").toString(),
+                        attributes.value("revision").toString());
+                }
+            } else if (xml.name() == u"remove-project") {
+                removeProject(attributes);
+            } else if (xml.name() == u"extend-project") {
+                extendProject(attributes);
+            }
+            xml.skipCurrentElement();
+        }
+    }
+    if (xml.hasError()) {
+        setError(QString("%1 line %2: %3").arg(path).arg(xml.lineNumber()).arg(xml.errorString()));
+    }
+    m_includeStack.removeLast();
+    return !xml.hasError();
+}
+
+void ManifestParser::parseProject(
+    QXmlStreamReader &xml, const ParsedProject *parent, const QStringList &groups)
+{
+    const QXmlStreamAttributes attributes = xml.attributes();
+    ParsedProject project;
+    project.name = attributes.value("name").toString();
+    project.path = attributes.value("path").toString();
+    if (project.path.isEmpty()) project.path = project.name;
+    project.groups = groups + splitGroups(attributes.value("groups"));
+    project.remote = attributes.value("remote").toString();
+    project.revision = attributes.value("revision").toString();
+    project.upstream = attributes.value("upstream").toString();
+    project.destBranch = attributes.value("dest-branch").toString();
+    // Nested projects live inside their parent
+    if (parent) {
+        project.name = parent->name + "/" + project.name;
+        project.path = parent->path + "/" + project.path;
+        project.groups += parent->groups;
+    }
+    if (!attributes.value("name").isEmpty()) {
+        m_projects.append(project);
+    }
+
+    while (xml.readNextStartElement()) {
+        if (xml.name() == u"project") {
+            parseProject(xml, &project, {});
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void ManifestParser::removeProject(const QXmlStreamAttributes &attributes)
+{
+    const QString name = attributes.value("name").toString();
+    const QString path = attributes.value("path").toString();
+    if (name.isEmpty() && path.isEmpty()) {
+        return;
+    }
+    const qsizetype removed = m_projects.removeIf([&](const ParsedProject &project) {
+        return (name.isEmpty() || project.name == name) && (path.isEmpty() || project.path == path);
+    });
+    if (removed == 0 && attributes.value("optional") != u"true") {
+        qWarning() << "remove-project matches no project:" << name << path;
+    }
+}
+
+void ManifestParser::extendProject(const QXmlStreamAttributes &attributes)
+{
+    const QString name = attributes.value("name").toString();
+    const QString path = attributes.value("path").toString();
+    const QString destPath = attributes.value("dest-path").toString();
+    const QStringList groups = splitGroups(attributes.value("groups"));
+    for (ParsedProject &project : m_projects) {
+        if (project.name != name || (!path.isEmpty() && project.path != path)) {
+            continue;
+        }
+        project.groups += groups;
+        if (!destPath.isEmpty()) {
+            project.path = destPath;
+        }
+        if (attributes.hasAttribute("remote")) {
+            project.remote = attributes.value("remote").toString();
+        }
+        if (attributes.hasAttribute("revision")) {
+            project.revision = attributes.value("revision").toString();
+        }
+        if (attributes.hasAttribute("upstream")) {
+            project.upstream = attributes.value("upstream").toString();
+        }
+        if (attributes.hasAttribute("dest-branch")) {
+            project.destBranch = attributes.value("dest-branch").toString();
+        }
+    }
+}
+
+// The groups given to `repo init -g`, kept in the manifest repository's config
+QStringList ManifestParser::manifestGroups()
+{
+    const QString configPath = QDir::cleanPath(m_repoPath + "/.repo/manifests.git/config");
+    m_files.append(stampOf(configPath));
+    QFile file(configPath);
+    if (file.open(QIODevice::ReadOnly)) {
+        bool inManifest = false;
+        for (const QByteArray &rawLine : file.readAll().split('\n')) {
+            const QByteArray line = rawLine.trimmed();
+            if (line.startsWith('[')) {
+                inManifest = line == "[manifest]";
+            } else if (inManifest && line.startsWith("groups")) {
+                const qsizetype eq = line.indexOf('=');
+                if (eq > 0 && line.left(eq).trimmed() == "groups") {
+                    return splitGroups(QString::fromUtf8(line.mid(eq + 1)));
+                }
+            }
+        }
+    }
+    return {"default", "platform-linux"};
+}
+
+Manifest ManifestParser::build(const QStringList &manifestGroups)
+{
+    Manifest manifest = m_manifest;
+    QSet<QString> paths;
+    for (const ParsedProject &project : std::as_const(m_projects)) {
+        QStringList groups = project.groups;
+        groups << "all" << "name:" + project.name << "path:" + project.path;
+        if (!groups.contains("notdefault")) {
+            groups << "default";
+        }
+        // Later entries win, "-group" takes out what an earlier one brought in
+        bool matched = false;
+        for (const QString &group : manifestGroups) {
+            if (group.startsWith('-') && groups.contains(group.mid(1))) {
+                matched = false;
+            } else if (groups.contains(group)) {
+                matched = true;
+            }
+        }
+        if (!matched) {
+            continue;
+        }
+        if (paths.contains(project.path)) {
+            qWarning() << "Duplicate manifest project path:" << project.path;
+            continue;
+        }
+        paths.insert(project.path);
+        Project &added = manifest.projectList.emplace_back(
+            project.name, project.path, QDir::cleanPath(m_repoPath + "/" + project.path));
+        // A project's own attributes, then its remote's revision, then <default>
+        added.remote = project.remote.isEmpty() ? manifest.remote : project.remote;
+        added.revision = project.revision;
+        if (added.revision.isEmpty()) {
+            added.revision = m_remoteRevisions.value(added.remote, manifest.revision);
+        }
+        added.upstream = project.upstream.isEmpty() ? m_defaultUpstream : project.upstream;
+        added.destBranch =
+            project.destBranch.isEmpty() ? m_defaultDestBranch : project.destBranch;
+    }
+    std::sort(manifest.projectList.begin(), manifest.projectList.end(),
+        [](const Project &p1, const Project &p2) {
+            return p1.path < p2.path;
+        });
+    indexProjects(manifest);
+    return manifest;
+}
+
+bool ManifestParser::readSnapshot(Manifest &manifest) const
+{
+    QFile file(m_snapshotPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString repoPath;
+    quint32 fileCount = 0;
+    in >> magic >> version >> repoPath >> fileCount;
+    if (magic != snapshotMagic || version != snapshotVersion || repoPath != m_repoPath) {
+        return false;
+    }
+    for (quint32 i = 0; i < fileCount; ++i) {
+        FileStamp stamp;
+        in >> stamp.path >> stamp.symLinkTarget >> stamp.mtime >> stamp.size;
+        if (in.status() != QDataStream::Ok || !(stampOf(stamp.path) == stamp)) {
+            return false;
+        }
+    }
+
+    qint32 syncJ = 0;
+    quint32 projectCount = 0;
+    in >> manifest.filePath >> manifest.remote >> manifest.revision >> syncJ >> projectCount;
+    manifest.syncJ = syncJ;
+    manifest.projectList.reserve(projectCount);
+    for (quint32 i = 0; i < projectCount && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        QString path;
+        in >> name >> path;
+        Project &project = manifest.projectList.emplace_back(
+            name, path, QDir::cleanPath(m_repoPath + "/" + path));
+        in >> project.remote >> project.revision >> project.upstream >> project.destBranch;
+    }
+    if (in.status() != QDataStream::Ok) {
+        manifest = Manifest();
+        return false;
+    }
+    indexProjects(manifest);
+    return true;
+}
+
+void ManifestParser::writeSnapshot(const Manifest &manifest) const
+{
+    QSaveFile file(m_snapshotPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << snapshotMagic << snapshotVersion << m_repoPath << quint32(m_files.size());
+    for (const FileStamp &stamp : m_files) {
+        out << stamp.path << stamp.symLinkTarget << stamp.mtime << stamp.size;
+    }
+    out << manifest.filePath << manifest.remote << manifest.revision << qint32(manifest.syncJ)
+        << quint32(manifest.projectList.size());
+    for (const Project &project : manifest.projectList) {
+        out << project.name << project.path << project.remote << project.revision
+            << project.upstream << project.destBranch;
+    }
+    file.commit();
+}
@@ -0,0 +1,86 @@
+#ifndef MANIFESTPARSER_H
+#define MANIFESTPARSER_H
+
+#include <QXmlStreamReader>
+
+#include "repocontext.h"
+
+// Resolves .repo/manifest.xml the way repo does: includes, local manifests, remove-project,
+// extend-project and the groups selected at init. Blocking, meant for a worker thread.
+class ManifestParser
+{
+public:
+    explicit ManifestParser(const QString &repoPath);
+
+    // From the snapshot when none of the files it was resolved from changed, otherwise parses
+    // and saves a new snapshot
+    Manifest load();
+    Manifest parse();
+    // Another manifest file, with the includes next to it, e.g. one written by
+    // `repo manifest -r`. Local manifests don't apply.
+    Manifest parseManifestFile(const QString &filePath);
+    // The manifest as it is on a branch of .repo/manifests, without the local manifests
+    Manifest parseManifestBranch(const QString &branch);
+
+    // The first problem of the last parse, the manifest may still have been read in part.
+    // Empty if there was none.
+    const QString &error() const
+    {
+        return m_error;
+    }
+
+private:
+    struct FileStamp
+    {
+        QString path;
+        QString symLinkTarget;
+        qint64 mtime;  // -1 for a missing file
+        qint64 size;
+
+        bool operator==(const FileStamp &other) const
+        {
+            return path == other.path && symLinkTarget == other.symLinkTarget &&
+                   mtime == other.mtime && size == other.size;
+        }
+    };
+
+    struct ParsedProject
+    {
+        QString name;
+        QString path;
+        QStringList groups;
+        QString remote;  // Empty ones fall back to the defaults in build()
+        QString revision;
+        QString upstream;
+        QString destBranch;
+    };
+
+    QString m_repoPath;
+    QString m_snapshotPath;
+    QString m_manifestsDir;
+    QString m_branch;  // Files in m_manifestsDir are read from it when set
+    QString m_error;
+    QList<FileStamp> m_files;  // Everything the result depends on
+    QStringList m_includeStack;
+    QList<ParsedProject> m_projects;
+    QHash<QString, QString> m_remoteRevisions;  // key:remote name, for those with a revision
+    QString m_defaultUpstream;
+    QString m_defaultDestBranch;
+    Manifest m_manifest;
+
+    static FileStamp stampOf(const QString &path);
+    void reset();
+    void setError(const QString &error);
+    bool readFile(const QString &path, QByteArray &data) const;
+    bool parseFile(const QString &path, const QString &includeRoot, const QStringList &groups);
+    void parseProject(QXmlStreamReader &xml, const ParsedProject *parent,
+        const QStringList &groups);
+    void removeProject(const QXmlStreamAttributes &attributes);
+    void extendProject(const QXmlStreamAttributes &attributes);
+    QStringList manifestGroups();
+    Manifest build(const QStringList &manifestGroups);
+    bool readSnapshot(Manifest &manifest) const;
+    void writeSnapshot(const Manifest &manifest) const;
+};
+
+#endif  // MANIFESTPARSER_H
@@ -4,36 +4,52 @@
 #include <QDesktopServices>
 #include <QFileDialog>
 #include <QMenu>
+#include <QMessageBox>
 #include <QProgressBar>
+#include <QSettings>
 #include <QShortcut>
+#include <QTimer>
 #include <QtConcurrent>
 
 #include "dialogs/cmddialog.h"
 #include "dialogs/warningfilelistdialog.h"
+#include "git/statusparser.h"
 #include "ui_changespage.h"
 
-ChangesPage::ChangesPage(QWidget *parent, const Project &project)
-    : QWidget(parent), ui(new Ui::ChangesPage), m_project(project)
+ChangesPage::ChangesPage(
+    QWidget *parent, const Project &project, const QSharedPointer<ProjectData> &data)
+    : QWidget(parent), ui(new Ui::ChangesPage), m_project(project), m_data(data)
 {
     ui->setupUi(this);
     ui->bottomSplitter->setSizes(QList<int>({1000, 100}));
     ui->centerSplitter->setSizes(QList<int>({100, 300}));
     m_indicator = new QProgressIndicator(this);
 
+    const bool grouped = QSettings().value("changesGroupedByDirectory", false).toBool();
+
+    m_unstagedModel = new GitFileModel(this);
+    m_unstagedModel->setGrouped(grouped);
+    ui->unstagedTable->setModel(m_unstagedModel);
     ui->unstagedTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    connect(ui->unstagedTable, &QTableWidget::cellDoubleClicked, this,
-        &ChangesPage::onFileDoubleClicked);
-    connect(
-        ui->unstagedTable, &QTableWidget::currentItemChanged, this, &ChangesPage::onFileSelected);
-    connect(ui->unstagedTable, &QTableWidget::customContextMenuRequested, this,
+    connect(ui->unstagedTable, &QTableView::doubleClicked, this, &ChangesPage::onFileDoubleClicked);
+    connect(ui->unstagedTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+        [this](const QModelIndex &current) {
+            onFileSelected(ui->unstagedTable, current);
+        });
+    connect(ui->unstagedTable, &QTableView::customContextMenuRequested, this,
         &ChangesPage::onFileListMenuRequested);
     connect(ui->unstageBtn, &QPushButton::clicked, this, &ChangesPage::onTableButtonClicked);
 
+    m_stagedModel = new GitFileModel(this);
+    m_stagedModel->setGrouped(grouped);
+    ui->stagedTable->setModel(m_stagedModel);
     ui->stagedTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    connect(
-        ui->stagedTable, &QTableWidget::cellDoubleClicked, this, &ChangesPage::onFileDoubleClicked);
-    connect(ui->stagedTable, &QTableWidget::currentItemChanged, this, &ChangesPage::onFileSelected);
-    connect(ui->stagedTable, &QTableWidget::customContextMenuRequested, this,
+    connect(ui->stagedTable, &QTableView::doubleClicked, this, &ChangesPage::onFileDoubleClicked);
+    connect(ui->stagedTable->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+        [this](const QModelIndex &current) {
+            onFileSelected(ui->stagedTable, current);
+        });
+    connect(ui->stagedTable, &QTableView::customContextMenuRequested, this,
         &ChangesPage::onFileListMenuRequested);
     connect(ui->stageBtn, &QPushButton::clicked, this, &ChangesPage::onTableButtonClicked);
 
@@ -42,63 +58,56 @@ ChangesPage::ChangesPage(QWidget *parent, const Project &project)
     connect(ui->amendCheckBox, &QCheckBox::toggled, this, &ChangesPage::onAmendToggled);
     connect(ui->commitButton, &QPushButton::clicked, this, &ChangesPage::onCommit);
 
-    getChangesAsync();
+    // Another page of the project may have loaded it already
+    connect(m_data.get(), &ProjectData::statusLoading, this, &ChangesPage::onStatusLoading);
+    connect(m_data.get(), &ProjectData::statusChanged, this, &ChangesPage::onStatusChanged);
+    connect(m_data.get(), &ProjectData::statusFailed, this, &ChangesPage::onStatusFailed);
+    if (m_data->isStatusLoading()) {
+        onStatusLoading();
+    }
+    if (m_data->hasStatus()) {
+        // Once the host listens
+        QTimer::singleShot(0, this, [this]() {
+            onStatusChanged({});
+        });
+    }
+    m_data->ensureStatus();
 }
 
 ChangesPage::~ChangesPage()
 {
+    // File operations finish in the project data
     reset(All);
     delete ui;
 }
 
 void ChangesPage::showEvent(QShowEvent *event)
 {
-    refresh();
+    // Kept up to date by the watcher, even while hidden
+    if (!m_data->isWatching()) {
+        refresh();
+    }
 }
 
 void ChangesPage::refresh()
 {
-    reset(List | Diff);
-    getChangesAsync();
+    m_data->refreshStatus();
 }
 
 void ChangesPage::updateUI(unsigned flags)
 {
     if (flags & List) {
-        const int stagedSize = m_stagedList.size();
-        const int unstagedSize = m_unstagedList.size();
-
-        for (int i = 0; i < unstagedSize; ++i) {
-            GitFile f = m_unstagedList.at(i);
-            ui->unstagedTable->insertRow(i);
-            QTableWidgetItem *modeItem = new QTableWidgetItem(f.mode);
-            modeItem->setToolTip(f.path);
-            ui->unstagedTable->setItem(i, 0, modeItem);
-            QTableWidgetItem *fileItem = new QTableWidgetItem(f.path);
-            fileItem->setToolTip(f.path);
-            ui->unstagedTable->setItem(i, 1, fileItem);
-        }
-        for (int i = 0; i < stagedSize; ++i) {
-            GitFile f = m_stagedList.at(i);
-            ui->stagedTable->insertRow(i);
-            QTableWidgetItem *modeItem = new QTableWidgetItem(f.mode);
-            modeItem->setToolTip(f.path);
-            ui->stagedTable->setItem(i, 0, modeItem);
-            QTableWidgetItem *fileItem = new QTableWidgetItem(f.path);
-            fileItem->setToolTip(f.path);
-            ui->stagedTable->setItem(i, 1, fileItem);
-        }
-
-        m_stagedSelection = qMin(stagedSize - 1, m_stagedSelection);
-        m_unstagedSelection = qMin(unstagedSize - 1, m_unstagedSelection);
-        if (m_stagedSelection >= 0) {
-            ui->stagedTable->selectRow(m_stagedSelection);
-        } else if (m_unstagedSelection >= 0) {
-            ui->unstagedTable->selectRow(m_unstagedSelection);
-        } else if (ui->stagedTable->rowCount() > 0) {
-            ui->stagedTable->selectRow(0);
-        } else if (ui->unstagedTable->rowCount() > 0) {
-            ui->unstagedTable->selectRow(0);
+        m_stagedModel->setFiles(m_stagedList);
+        m_unstagedModel->setFiles(m_unstagedList);
+
+        // Selection survives updates, only pick one when there is none
+        if (!ui->stagedTable->currentIndex().isValid() &&
+            !ui->unstagedTable->currentIndex().isValid()) {
+            if (m_stagedModel->rowCount() > 0) {
+                ui->stagedTable->selectRow(0);
+            } else if (m_unstagedModel->rowCount() > 0) {
+                ui->unstagedTable->selectRow(0);
+            }
         }
     }
     if (flags & Diff) {
@@ -109,11 +118,10 @@ void ChangesPage::updateUI(unsigned flags)
 void ChangesPage::reset(unsigned flags)
 {
     if (flags & List) {
-        m_changesWorker.cancel();
         m_unstagedList.clear();
         m_stagedList.clear();
-        ui->unstagedTable->setRowCount(0);
-        ui->stagedTable->setRowCount(0);
+        m_unstagedModel->setFiles({});
+        m_stagedModel->setFiles({});
     }
     if (flags & Diff) {
         m_diffWorker.cancel();
@@ -127,101 +135,76 @@ void ChangesPage::reset(unsigned flags)
     }
 }
 
-static bool isStagedFile(const QString &mode)
+void ChangesPage::onStatusLoading()
 {
-    // Untracked
-    if (mode == "??") {
-        return false;
-    }
-    // Unmerged
-    if (mode == "AA" || mode == "DD" || mode.contains("U")) {
-        return false;
-    }
-    if (mode[0] != ' ') {
-        return true;
-    }
-    if (mode[1] != ' ') {
-        return false;
+    // No busy indicator for updates from the watcher
+    if (!m_statusHint) {
+        m_statusHint = true;
+        m_indicator->startHint();
     }
-    Q_UNREACHABLE();
 }
 
-void ChangesPage::getChangesAsync()
+void ChangesPage::onStatusFailed(const QString &error)
 {
-    QString projectPath = m_project.absPath;
-    if (projectPath.isEmpty()) {
-        return;
-    }
-    m_indicator->startHint();
-    m_changesWorker = QtConcurrent::run([projectPath](QPromise<ChangesResult> &promise) {
-        QString cmdResult =
-            global::getCmdResult("git status --porcelain --untracked-files=all", projectPath);
-        if (promise.isCanceled()) {
-            return;
+    // Updates of a few paths show no busy indicator and fail quietly
+    if (m_statusHint) {
+        m_statusHint = false;
+        m_indicator->stopHint();
+        if (isVisible()) {
+            QMessageBox::warning(this, "Git Error", error);
         }
-        QStringList lines = cmdResult.split('\n');
-        ChangesResult result;
-        for (int i = 0; i < lines.size(); ++i) {
-            QString line = lines[i];
-            if (line.isEmpty()) {
-                continue;
-            }
-            result.fileCount++;
-
-            QString mode = line.sliced(0, 2);
-            QString path = line.sliced(3);
+    }
+}
 
-            if (path.contains(" -> ")) {
-                path = path.split(" -> ").last();
-            }
-            if (isStagedFile(mode)) {
-                result.stagedList.emplace_back(path, mode);
-            } else {
-                result.unstagedList.emplace_back(path, mode);
-            }
+void ChangesPage::onStatusChanged(const QStringList &paths)
+{
+    const ProjectData::Status &status = m_data->status();
+    m_stagedList = status.stagedList;
+    m_unstagedList = status.unstagedList;
+    updateUI(List);
+    if (paths.isEmpty()) {
+        if (m_statusHint) {
+            m_statusHint = false;
+            m_indicator->stopHint();
         }
-        promise.addResult(result);
-    });
-    QPointer thisPtr(this);
-    m_changesWorker
-        .then(qApp,
-            [this](const ChangesResult &result) {
-                this->m_indicator->stopHint();
-                this->m_unstagedList = result.unstagedList;
-                this->m_stagedList = result.stagedList;
-                updateUI(List);
-                emit newChangesEvent(result.fileCount);
-            })
-        .onCanceled(qApp, [thisPtr] {
-            if (thisPtr.isNull()) return;
-            thisPtr->m_indicator->stopHint();
-        });
+        reloadDiff();
+    } else if (global::isInPaths(m_file.path, paths)) {
+        reloadDiff();
+    }
+    m_data->precomputeDiffs(ui->diffView->getContextLines());
+    emit newChangesEvent(m_stagedList.size() + m_unstagedList.size());
+}
+
+void ChangesPage::reloadDiff()
+{
+    // The selected file may have moved between the lists or changed its mode
+    QTableView *table =
+        ui->stagedTable->currentIndex().isValid() ? ui->stagedTable : ui->unstagedTable;
+    onFileSelected(table, table->currentIndex());
 }
 
 void ChangesPage::getDiffAsync()
 {
-    QString cmd;
-    if (m_file.mode == "??") {
-        cmd = QString(R"(git diff -U%1 -- /dev/null "%2")")
-                  .arg(QString::number(ui->diffView->getContextLines()), m_file.path);
-    } else if (isStagedFile(m_file.mode)) {
-        cmd = QString(R"(git diff -U%1 -M --cached -- "%2")")
-                  .arg(QString::number(ui->diffView->getContextLines()), m_file.path);
-    } else {
-        cmd = QString(R"(git diff -U%1 -M -- "%2")")
-                  .arg(QString::number(ui->diffView->getContextLines()), m_file.path);
+    m_diffWorker.cancel();
+    if (m_file.path.isEmpty()) {
+        return;
+    }
+    const int contextLines = ui->diffView->getContextLines();
+    const bool staged = ProjectData::isStagedFile(m_file.mode);
+    const DiffCache::Key key = DiffCache::makeKey(m_project.absPath, m_file, staged, contextLines);
+    if (m_data->diffCache()->find(m_file.path, key, m_diffHunks)) {
+        updateUI(Diff);
+        return;
     }
-    QString projectPath = m_project.absPath;
     m_indicator->startHint();
-    m_diffWorker = QtConcurrent::run([projectPath, cmd](QPromise<DiffResult> &promise) {
-        QString cmdResult = global::getCmdResult(cmd, projectPath);
-        if (promise.isCanceled()) {
-            return;
-        }
-
+    m_diffWorker = QtConcurrent::run([data = m_data, config = m_data->status().diffConfig,
+                                         file = m_file, staged,
+                                         contextLines](QPromise<DiffResult> &promise) {
         DiffResult result;
-        result.hunks = parseDiffHunks(cmdResult);
-        promise.addResult(result);
+        result.hunks = data->readWorkTreeDiff(file, staged, contextLines, config);
+        if (!promise.isCanceled()) {
+            promise.addResult(result);
+        }
     });
     QPointer thisPtr(this);
     m_diffWorker
@@ -239,16 +222,17 @@ void ChangesPage::getDiffAsync()
 
 void ChangesPage::onFileListMenuRequested(const QPoint &pos)
 {
-    auto sourceTable = qobject_cast<QTableWidget *>(sender());
+    auto sourceTable = qobject_cast<QTableView *>(sender());
     const QModelIndex &index = sourceTable->indexAt(pos);
     if (!index.isValid()) return;
-    QList<GitFile> &fileList = sourceTable == ui->stagedTable ? m_stagedList : m_unstagedList;
-    const GitFile &file = fileList.at(index.row());
-    const QString &absPath = QDir::cleanPath(m_project.absPath + "/" + file.path);
-    const QModelIndexList &selectedRows = sourceTable->selectionModel()->selectedRows();
+    auto model = static_cast<GitFileModel *>(sourceTable->model());
+    const QString &path = index.data(Qt::ToolTipRole).toString();
+    const QString &absPath = QDir::cleanPath(m_project.absPath + "/" + path);
+    const QList<GitFile> &selection = model->files(sourceTable->selectionModel()->selectedRows());
+    const bool singleFile = selection.size() == 1 && !model->isDirectory(index.row());
     QStringList selectedFiles;
-    for (const QModelIndex &index : selectedRows) {
-        selectedFiles << fileList.at(index.row()).path;
+    for (const GitFile &file : selection) {
+        selectedFiles << file.path;
     }
 
     QMenu menu;
@@ -256,7 +240,7 @@ void ChangesPage::onFileListMenuRequested(const QPoint &pos)
             [&]() {
                 QDesktopServices::openUrl(QUrl::fromLocalFile(absPath));
             })
-        ->setEnabled(selectedRows.size() == 1);
+        ->setEnabled(singleFile);
     menu.addAction("Open Containing Folder", this, [&]() {
         QDir dir = QFileInfo(absPath).absoluteDir();
         QDesktopServices::openUrl(QUrl::fromLocalFile(dir.path()));
@@ -265,23 +249,19 @@ void ChangesPage::onFileListMenuRequested(const QPoint &pos)
             [&]() {
                 QGuiApplication::clipboard()->setText(absPath);
             })
-        ->setEnabled(selectedRows.size() == 1);
+        ->setEnabled(singleFile);
     menu.addSeparator();
     menu.addAction("Discard", this, [&]() {
         if (WarningFileListDialog::confirm(this, "Confirm Discard",
                 "Changes in the following files will be discarded, THIS CANNOT BE UNDONE",
                 selectedFiles)) {
-            if (sourceTable == ui->unstagedTable) {
-                batchFilesAction(ui->unstagedTable, {"git checkout --"});
-            } else {
-                batchFilesAction(ui->stagedTable, {"git reset --", "git checkout --"});
-            }
+            batchFilesAction(sourceTable, git::FileOp::Discard);
         }
     });
 
     bool enableRemove = true;
-    for (auto &index : selectedRows) {
-        if (fileList.at(index.row()).mode.contains("D")) {
+    for (const GitFile &file : selection) {
+        if (file.mode.contains("D")) {
             enableRemove = false;
             break;
         }
@@ -292,86 +272,94 @@ void ChangesPage::onFileListMenuRequested(const QPoint &pos)
                         "The following files will be removed, THIS CANNOT BE UNDONE if file is not "
                         "tracked by git",
                         selectedFiles)) {
-                    if (sourceTable == ui->unstagedTable) {
-                        batchFilesAction(ui->unstagedTable, {"rm"});
-                    } else {
-                        batchFilesAction(ui->stagedTable, {"git reset --", "rm"});
-                    }
+                    batchFilesAction(sourceTable, git::FileOp::Remove);
                 }
             })
         ->setEnabled(enableRemove);
     menu.addSeparator();
     menu.addAction(sourceTable == ui->stagedTable ? "Unstage" : "Stage", this, [&]() {
         if (sourceTable == ui->unstagedTable) {
-            batchFilesAction(ui->unstagedTable, {"git add --"});
+            batchFilesAction(ui->unstagedTable, git::FileOp::Stage);
         } else {
-            batchFilesAction(ui->stagedTable, {"git reset --"});
+            batchFilesAction(ui->stagedTable, git::FileOp::Unstage);
         }
     });
     menu.addAction(sourceTable == ui->stagedTable ? "Unstage All" : "Stage All", this, [&]() {
-        QString cmd = sourceTable == ui->stagedTable ? "git reset" : "git add .";
-        CmdDialog::execute(this, cmd, m_project.absPath, true);
-        reset(List | Diff);
-        getChangesAsync();
+        if (sourceTable == ui->unstagedTable) {
+            applyFileOpAsync(git::FileOp::Stage, m_unstagedList, false);
+        } else {
+            applyFileOpAsync(git::FileOp::Unstage, m_stagedList, true);
+        }
+    });
+    menu.addSeparator();
+    QAction *groupAction = menu.addAction("Group by Directory", this, [this](bool checked) {
+        QSettings().setValue("changesGroupedByDirectory", checked);
+        m_stagedModel->setGrouped(checked);
+        m_unstagedModel->setGrouped(checked);
+        reset(Diff);
+        m_file = GitFile();
+        updateUI(List);
     });
+    groupAction->setCheckable(true);
+    groupAction->setChecked(model->grouped());
     menu.exec(sourceTable->mapToGlobal(pos));
 }
 
-void ChangesPage::onFileDoubleClicked(int row, int column)
+void ChangesPage::onFileDoubleClicked(const QModelIndex &index)
 {
     if (sender() == ui->unstagedTable) {
-        batchFilesAction(ui->unstagedTable, {"git add --"});
+        batchFilesAction(ui->unstagedTable, git::FileOp::Stage);
     } else {
-        batchFilesAction(ui->stagedTable, {"git reset --"});
+        batchFilesAction(ui->stagedTable, git::FileOp::Unstage);
     }
 }
 
 void ChangesPage::onTableButtonClicked()
 {
     if (sender() == ui->stageBtn) {
-        batchFilesAction(ui->unstagedTable, {"git add --"});
+        batchFilesAction(ui->unstagedTable, git::FileOp::Stage);
     } else {
-        batchFilesAction(ui->stagedTable, {"git reset --"});
+        batchFilesAction(ui->stagedTable, git::FileOp::Unstage);
     }
 }
 
-void ChangesPage::batchFilesAction(QTableWidget *table, const QStringList &cmds)
+void ChangesPage::batchFilesAction(QTableView *table, git::FileOp op)
 {
-    const QModelIndexList &indexes = table->selectionModel()->selectedRows();
-    if (indexes.isEmpty()) return;
-    const QList<GitFile> &fileList = table == ui->stagedTable ? m_stagedList : m_unstagedList;
-
-    QStringList fullCmds;
-    for (auto &c : cmds) {
-        QString fullCmd = c;
-        for (const QModelIndex &index : indexes) {
-            fullCmd.append(" ").append(fileList.at(index.row()).path);
-        }
-        fullCmds << fullCmd;
-    }
+    auto model = static_cast<GitFileModel *>(table->model());
+    applyFileOpAsync(
+        op, model->files(table->selectionModel()->selectedRows()), table == ui->stagedTable);
+}
 
-    CmdDialog::execute(this, fullCmds, m_project.absPath, true);
-    reset(List | Diff);
-    getChangesAsync();
+void ChangesPage::applyFileOpAsync(git::FileOp op, const QList<GitFile> &files, bool staged)
+{
+    if (files.isEmpty()) return;
+    m_indicator->startHint();
+    // The lists are patched through the project data, for every page showing it
+    m_fileOpWorker = m_data->applyFileOp(op, files, staged);
+    QPointer thisPtr(this);
+    m_fileOpWorker.then(qApp, [thisPtr](const git::FileOpResult &result) {
+        if (thisPtr.isNull()) return;
+        thisPtr->m_indicator->stopHint();
+        if (!result.error.isEmpty()) {
+            QMessageBox::warning(thisPtr, "Git Error", result.error);
+        }
+    });
 }
 
-void ChangesPage::onFileSelected(QTableWidgetItem *current, QTableWidgetItem *previous)
+void ChangesPage::onFileSelected(QTableView *table, const QModelIndex &current)
 {
-    if (!current) return;
-
-    GitFile file;
-    if (sender() == ui->stagedTable) {
-        file = m_stagedList.at(current->row());
-        ui->unstagedTable->setCurrentItem(nullptr);
-        m_stagedSelection = current->row();
-        m_unstagedSelection = -1;
-    } else {
-        file = m_unstagedList.at(current->row());
-        ui->stagedTable->setCurrentItem(nullptr);
-        m_stagedSelection = -1;
-        m_unstagedSelection = current->row();
+    if (!current.isValid()) return;
+
+    QTableView *otherTable = table == ui->stagedTable ? ui->unstagedTable : ui->stagedTable;
+    otherTable->selectionModel()->clear();
+
+    auto model = static_cast<GitFileModel *>(table->model());
+    if (model->isDirectory(current.row())) {
+        m_file = GitFile();
+        reset(Diff);
+        return;
     }
-    m_file = file;
+    m_file = model->file(current.row());
     getDiffAsync();
 }
 
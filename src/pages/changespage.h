@@ -4,12 +4,13 @@
 #include <QFutureWatcher>
 #include <QMutex>
 #include <QPromise>
-#include <QTableWidgetItem>
-#include <QThreadPool>
+#include <QTableView>
 #include <QWaitCondition>
 #include <QWidget>
 
+#include "git/projectdata.h"
 #include "global.h"
+#include "pages/gitfilemodel.h"
 #include "pages/historytablemodel.h"
 #include "repocontext.h"
 #include "widgets/QProgressIndicator.h"
@@ -24,7 +25,7 @@ class ChangesPage : public QWidget
     Q_OBJECT
 
 public:
-    ChangesPage(QWidget *parent, const Project &project);
+    ChangesPage(QWidget *parent, const Project &project, const QSharedPointer<ProjectData> &data);
     ~ChangesPage();
 
     void refresh();
@@ -50,35 +51,35 @@ private:
     QList<GitFile> m_stagedList;
     QList<GitFile> m_unstagedList;
     QList<DiffHunk> m_diffHunks;
-    int m_stagedSelection = -1;
-    int m_unstagedSelection = -1;
+    GitFileModel *m_stagedModel;
+    GitFileModel *m_unstagedModel;
     GitFile m_file;
+    QSharedPointer<ProjectData> m_data;
+    bool m_statusHint = false;
 
-    struct ChangesResult
-    {
-        QList<GitFile> unstagedList;
-        QList<GitFile> stagedList;
-        int fileCount = 0;
-    };
     struct DiffResult
     {
         QList<DiffHunk> hunks;
     };
-    QFuture<ChangesResult> m_changesWorker;
     QFuture<DiffResult> m_diffWorker;
     QFuture<QString> m_amendWorker;
-    void getChangesAsync();
+    QFuture<git::FileOpResult> m_fileOpWorker;
+    void reloadDiff();
     void getDiffAsync();
-    void batchFilesAction(QTableWidget *table, const QStringList &cmds);
+    void batchFilesAction(QTableView *table, git::FileOp op);
+    void applyFileOpAsync(git::FileOp op, const QList<GitFile> &files, bool staged);
 
 signals:
     void commitEvent(const HistorySelectionArg &arg = HistorySelectionArg());
     void newChangesEvent(int count);
 
 private slots:
+    void onStatusLoading();
+    void onStatusChanged(const QStringList &paths);
+    void onStatusFailed(const QString &error);
     void onFileListMenuRequested(const QPoint &pos);
-    void onFileDoubleClicked(int row, int column);
-    void onFileSelected(QTableWidgetItem *current, QTableWidgetItem *previous);
+    void onFileDoubleClicked(const QModelIndex &index);
+    void onFileSelected(QTableView *table, const QModelIndex &current);
     void onTableButtonClicked();
     void onAmendToggled(bool checked);
     void onCommit();
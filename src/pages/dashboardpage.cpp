@@ -0,0 +1,284 @@
+#include "dashboardpage.h"
+
+#include <QtConcurrent>
+
+#include "themes/theme.h"
+#include "ui_dashboardpage.h"
+
+using namespace utils;
+
+ProjectStatusModel::ProjectStatusModel(QObject *parent, const RepoContext &context)
+    : QAbstractTableModel(parent),
+      m_manifest(context.manifest()),
+      m_statusList(m_manifest->projectList.size()),
+      m_scanned(m_manifest->projectList.size(), false)
+{
+}
+
+int ProjectStatusModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_statusList.size();
+}
+
+int ProjectStatusModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+static QString countText(int count)
+{
+    return count < 0 ? QString() : QString::number(count);
+}
+
+QVariant ProjectStatusModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Project &project = this->project(index.row());
+    const ProjectStatus &status = m_statusList.at(index.row());
+    const bool scanned = m_scanned.at(index.row());
+
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case PathColumn:
+                    return project.path;
+                case BranchColumn:
+                    if (!status.valid) {
+                        return scanned ? "Not checked out" : QString();
+                    }
+                    return status.branch.isEmpty() ? "(detached)" : status.branch;
+                case ChangesColumn:
+                    return countText(status.changes);
+                case AheadColumn:
+                    return countText(status.ahead);
+                case BehindColumn:
+                    return countText(status.behind);
+            }
+            break;
+        case Qt::UserRole:  // Sort key, unknown counts sort first
+            switch (index.column()) {
+                case PathColumn:
+                    return project.path;
+                case BranchColumn:
+                    return status.branch;
+                case ChangesColumn:
+                    return status.changes;
+                case AheadColumn:
+                    return status.ahead;
+                case BehindColumn:
+                    return status.behind;
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (index.column() == BranchColumn && status.valid) {
+                return QString("Upstream: %1\nManifest revision: %2")
+                    .arg(status.upstream.isEmpty() ? "none" : status.upstream,
+                        project.revision);
+            }
+            return project.name;
+        case Qt::FontRole: {
+            const bool highlight = (index.column() == BranchColumn && status.offRevision) ||
+                                   (index.column() == ChangesColumn && status.changes > 0) ||
+                                   (index.column() == AheadColumn && status.ahead > 0);
+            if (highlight) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            break;
+        }
+        case Qt::ForegroundRole:
+            if (scanned && !status.valid) {
+                return creatorTheme()->color(Theme::PaletteTextDisabled);
+            }
+            break;
+        case Qt::TextAlignmentRole:
+            if (index.column() >= ChangesColumn) {
+                return int(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            break;
+    }
+    return QVariant();
+}
+
+QVariant ProjectStatusModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case PathColumn:
+            return "Project";
+        case BranchColumn:
+            return "Branch";
+        case ChangesColumn:
+            return "Changes";
+        case AheadColumn:
+            return "Ahead";
+        case BehindColumn:
+            return "Behind";
+    }
+    return QVariant();
+}
+
+void ProjectStatusModel::setManifest(const ManifestPtr &manifest)
+{
+    QHash<QString, int> oldRows;
+    for (int row = 0; row < m_manifest->projectList.size(); ++row) {
+        oldRows.insert(m_manifest->projectList[row].path, row);
+    }
+    QList<ProjectStatus> statusList(manifest->projectList.size());
+    QList<bool> scanned(manifest->projectList.size(), false);
+    for (int row = 0; row < manifest->projectList.size(); ++row) {
+        const int oldRow = oldRows.value(manifest->projectList[row].path, -1);
+        if (oldRow >= 0) {
+            statusList[row] = m_statusList[oldRow];
+            scanned[row] = m_scanned[oldRow];
+        }
+    }
+
+    beginResetModel();
+    m_manifest = manifest;
+    m_statusList = statusList;
+    m_scanned = scanned;
+    endResetModel();
+}
+
+const Project &ProjectStatusModel::project(int row) const
+{
+    return m_manifest->projectList.at(row);
+}
+
+const ProjectStatus &ProjectStatusModel::status(int row) const
+{
+    return m_statusList.at(row);
+}
+
+void ProjectStatusModel::setStatus(int row, const ProjectStatus &status)
+{
+    m_statusList[row] = status;
+    m_scanned[row] = true;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+DashboardPage::DashboardPage(const RepoContext &context)
+    : QWidget(nullptr), ui(new Ui::DashboardPage), m_context(context)
+{
+    ui->setupUi(this);
+    // Mostly waiting on git and the disk, more than the cores pays off
+    m_pool.setMaxThreadCount(qBound(4, QThread::idealThreadCount() * 2, 32));
+
+    m_model = new ProjectStatusModel(this, context);
+    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setSortRole(Qt::UserRole);
+    // Rows stay in place while results stream in, until a header is clicked again
+    m_proxyModel->setDynamicSortFilter(false);
+    ui->tableView->setModel(m_proxyModel);
+    ui->tableView->sortByColumn(ProjectStatusModel::PathColumn, Qt::AscendingOrder);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(
+        ProjectStatusModel::PathColumn, QHeaderView::Stretch);
+    connect(ui->tableView, &QTableView::doubleClicked, this, [this](const QModelIndex &index) {
+        emit projectDoubleClicked(m_model->project(m_proxyModel->mapToSource(index).row()));
+    });
+    connect(ui->refreshBtn, &QPushButton::clicked, this, [this]() {
+        refresh(true);
+    });
+
+    connect(context.state(), &RepoState::manifestChanged, this, [this]() {
+        // Rows of the scan in flight refer to the old project list
+        m_scanWatcher.cancel();
+        m_model->setManifest(m_context.manifest());
+        refresh();
+    });
+
+    connect(&m_scanWatcher, &QFutureWatcher<ScanResult>::resultReadyAt, this,
+        &DashboardPage::onScanResult);
+    connect(&m_scanWatcher, &QFutureWatcher<ScanResult>::finished, this,
+        &DashboardPage::updateSummary);
+}
+
+DashboardPage::~DashboardPage()
+{
+    // The pool still waits for the projects in flight
+    m_scanWatcher.cancel();
+    delete ui;
+}
+
+void DashboardPage::showEvent(QShowEvent *event)
+{
+    refresh();
+}
+
+void DashboardPage::refresh(bool force)
+{
+    if (m_scanWatcher.isRunning() && !m_scanWatcher.isCanceled()) {
+        if (!force) return;
+        // In flight projects finish in the background, their results are dropped
+        m_scanWatcher.cancel();
+    }
+
+    QList<ScanJob> jobs;
+    const ManifestPtr manifest = m_model->manifest();
+    const QList<Project> &projectList = manifest->projectList;
+    jobs.reserve(projectList.size());
+    for (int row = 0; row < projectList.size(); ++row) {
+        const ProjectStatus::Stamp stamp =
+            force ? ProjectStatus::Stamp() : m_model->status(row).stamp;
+        // Projects may be pinned, on another branch or from another remote
+        const Project &project = projectList[row];
+        jobs.append({row, project.absPath, project.remote, project.revision, stamp});
+    }
+
+    m_rescanned = 0;
+    m_scanTimer.start();
+    m_scanWatcher.setFuture(QtConcurrent::mapped(&m_pool, std::move(jobs), [](const ScanJob &job) {
+        if (job.stamp.isValid() && ProjectStatus::readStamp(job.absPath) == job.stamp) {
+            return ScanResult{job.row, true, {}};
+        }
+        return ScanResult{
+            job.row, false, ProjectStatus::read(job.absPath, job.remote, job.revision)};
+    }));
+    updateSummary();
+}
+
+void DashboardPage::onScanResult(int index)
+{
+    const ScanResult result = m_scanWatcher.resultAt(index);
+    if (!result.unchanged) {
+        m_model->setStatus(result.row, result.status);
+        ++m_rescanned;
+    }
+    updateSummary();
+}
+
+void DashboardPage::updateSummary()
+{
+    int withChanges = 0;
+    int ahead = 0;
+    int offRevision = 0;
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        const ProjectStatus &status = m_model->status(row);
+        withChanges += status.changes > 0;
+        ahead += status.ahead > 0;
+        offRevision += status.offRevision;
+    }
+    QString text = QString("%1 with changes  |  %2 ahead  |  %3 off revision")
+                       .arg(withChanges)
+                       .arg(ahead)
+                       .arg(offRevision);
+    if (m_scanWatcher.isRunning()) {
+        text += QString("  |  Scanning %1/%2")
+                    .arg(m_scanWatcher.progressValue())
+                    .arg(m_scanWatcher.progressMaximum());
+    } else {
+        text += QString("  |  %1 of %2 rescanned in %3 ms")
+                    .arg(m_rescanned)
+                    .arg(m_model->rowCount())
+                    .arg(m_scanTimer.elapsed());
+    }
+    ui->summaryLabel->setText(text);
+}
@@ -0,0 +1,102 @@
+#ifndef DASHBOARDPAGE_H
+#define DASHBOARDPAGE_H
+
+#include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QSortFilterProxyModel>
+#include <QThreadPool>
+#include <QWidget>
+
+#include "git/projectstatus.h"
+#include "repocontext.h"
+
+namespace Ui {
+    class DashboardPage;
+}
+
+class ProjectStatusModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        PathColumn,
+        BranchColumn,
+        ChangesColumn,
+        AheadColumn,
+        BehindColumn,
+        ColumnCount,
+    };
+
+    ProjectStatusModel(QObject *parent, const RepoContext &context);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    const ManifestPtr &manifest() const
+    {
+        return m_manifest;
+    }
+    // Keeps the status of the projects still in the manifest
+    void setManifest(const ManifestPtr &manifest);
+    const Project &project(int row) const;
+    const ProjectStatus &status(int row) const;
+    void setStatus(int row, const ProjectStatus &status);
+
+private:
+    ManifestPtr m_manifest;
+    QList<ProjectStatus> m_statusList;  // Same order as the manifest project list
+    QList<bool> m_scanned;
+};
+
+// Status of every project in the manifest, scanned in parallel
+class DashboardPage : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DashboardPage(const RepoContext &context);
+    ~DashboardPage();
+
+    // Rescans projects whose index or HEAD changed since the last scan, or all of them
+    void refresh(bool force = false);
+
+signals:
+    void projectDoubleClicked(const Project &project);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    struct ScanJob
+    {
+        int row;
+        QString absPath;
+        QString remote;  // Of the project, what its manifest revision is compared in
+        QString revision;
+        ProjectStatus::Stamp stamp;  // Of the cached status, invalid to always scan
+    };
+    struct ScanResult
+    {
+        int row;
+        bool unchanged;
+        ProjectStatus status;
+    };
+
+    Ui::DashboardPage *ui;
+    RepoContext m_context;
+    ProjectStatusModel *m_model;
+    QSortFilterProxyModel *m_proxyModel;
+    QThreadPool m_pool;
+    QFutureWatcher<ScanResult> m_scanWatcher;
+    QElapsedTimer m_scanTimer;
+    int m_rescanned = 0;
+
+    void onScanResult(int index);
+    void updateSummary();
+};
+
+#endif  // DASHBOARDPAGE_H
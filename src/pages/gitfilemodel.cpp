@@ -0,0 +1,206 @@
+#include "gitfilemodel.h"
+
+#include <algorithm>
+
+#include <QFont>
+#include <QMap>
+#include <QSet>
+
+GitFileModel::GitFileModel(QObject *parent) : QAbstractTableModel{parent}
+{
+}
+
+int GitFileModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int GitFileModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant GitFileModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    const Row &row = m_rows.at(index.row());
+    const bool isDir = row.key.endsWith('/');
+    switch (role) {
+        case Qt::DisplayRole:
+            if (index.column() == 0) {
+                return isDir ? QString::number(row.count) : row.file.mode;
+            }
+            if (isDir) {
+                return row.file.path.isEmpty() ? "./" : row.file.path + "/";
+            }
+            return m_grouped ? "    " + row.file.path.section('/', -1) : row.file.path;
+        case Qt::ToolTipRole:
+            return row.file.path;
+        case Qt::FontRole:
+            if (isDir) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            return QVariant();
+        default:
+            return QVariant();
+    }
+}
+
+void GitFileModel::setFiles(const QList<GitFile> &files)
+{
+    applyRows(buildRows(files));
+    m_files = files;
+}
+
+void GitFileModel::setGrouped(bool grouped)
+{
+    if (m_grouped == grouped) {
+        return;
+    }
+    // Every file row changes its text
+    beginResetModel();
+    m_grouped = grouped;
+    m_rows = buildRows(m_files);
+    m_rowOfKey.clear();
+    for (int i = 0; i < m_rows.size(); ++i) {
+        m_rowOfKey.insert(m_rows[i].key, i);
+    }
+    endResetModel();
+}
+
+bool GitFileModel::isDirectory(int row) const
+{
+    return row >= 0 && row < m_rows.size() && m_rows[row].key.endsWith('/');
+}
+
+GitFile GitFileModel::file(int row) const
+{
+    return row >= 0 && row < m_rows.size() && !isDirectory(row) ? m_rows[row].file : GitFile();
+}
+
+int GitFileModel::rowOf(const QString &path) const
+{
+    return m_rowOfKey.value(path, -1);
+}
+
+QList<GitFile> GitFileModel::files(const QModelIndexList &indexes) const
+{
+    QList<int> rows;
+    for (const QModelIndex &index : indexes) {
+        rows << index.row();
+        if (isDirectory(index.row())) {
+            for (int row = index.row() + 1; row < m_rows.size() && !isDirectory(row); ++row) {
+                rows << row;
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    QList<GitFile> result;
+    for (int row : rows) {
+        if (!isDirectory(row)) {
+            result << m_rows[row].file;
+        }
+    }
+    return result;
+}
+
+QList<GitFileModel::Row> GitFileModel::buildRows(const QList<GitFile> &files) const
+{
+    QList<Row> rows;
+    if (!m_grouped) {
+        rows.reserve(files.size());
+        for (const GitFile &file : files) {
+            rows.append({file.path, file, 0});
+        }
+        return rows;
+    }
+
+    QMap<QString, QList<GitFile>> dirs;
+    for (const GitFile &file : files) {
+        const int slash = file.path.lastIndexOf('/');
+        dirs[slash < 0 ? QString() : file.path.left(slash)].append(file);
+    }
+    rows.reserve(files.size() + dirs.size());
+    for (auto it = dirs.cbegin(); it != dirs.cend(); ++it) {
+        rows.append({it.key() + "/", GitFile(it.key(), ""), int(it.value().size())});
+        for (const GitFile &file : it.value()) {
+            rows.append({file.path, file, 0});
+        }
+    }
+    return rows;
+}
+
+void GitFileModel::applyRows(const QList<Row> &rows)
+{
+    QHash<QString, int> newRowOfKey;
+    newRowOfKey.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        newRowOfKey.insert(rows[i].key, i);
+    }
+
+    // Removals, in runs from the bottom so row numbers above stay valid
+    for (int i = m_rows.size() - 1; i >= 0;) {
+        if (newRowOfKey.contains(m_rows[i].key)) {
+            --i;
+            continue;
+        }
+        const int last = i;
+        while (i >= 0 && !newRowOfKey.contains(m_rows[i].key)) {
+            --i;
+        }
+        beginRemoveRows(QModelIndex(), i + 1, last);
+        m_rows.remove(i + 1, last - i);
+        endRemoveRows();
+    }
+
+    // Rows that were kept but moved around can't be expressed as inserts
+    bool ordered = true;
+    QSet<QString> keptKeys;
+    for (int i = 0, prev = -1; i < m_rows.size(); ++i) {
+        const int pos = newRowOfKey.value(m_rows[i].key);
+        if (pos < prev) {
+            ordered = false;
+            break;
+        }
+        prev = pos;
+        keptKeys.insert(m_rows[i].key);
+    }
+
+    if (!ordered) {
+        beginResetModel();
+        m_rows = rows;
+        m_rowOfKey = newRowOfKey;
+        endResetModel();
+        return;
+    }
+
+    // Insertions and changes
+    for (int i = 0; i < rows.size();) {
+        if (i < m_rows.size() && m_rows[i].key == rows[i].key) {
+            const bool changed =
+                m_rows[i].file.mode != rows[i].file.mode || m_rows[i].count != rows[i].count;
+            m_rows[i] = rows[i];
+            if (changed) {
+                emit dataChanged(index(i, 0), index(i, columnCount() - 1));
+            }
+            ++i;
+            continue;
+        }
+        int end = i;
+        while (end < rows.size() && !keptKeys.contains(rows[end].key)) {
+            ++end;
+        }
+        beginInsertRows(QModelIndex(), i, end - 1);
+        m_rows.insert(i, end - i, Row());
+        std::copy(rows.begin() + i, rows.begin() + end, m_rows.begin() + i);
+        endInsertRows();
+        i = end;
+    }
+    m_rowOfKey = newRowOfKey;
+}
@@ -0,0 +1,56 @@
+#ifndef GITFILEMODEL_H
+#define GITFILEMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "global.h"
+
+// File list of a status or a commit. New lists are applied as row inserts, removals and
+// changes, so selection and scroll position survive refreshes.
+class GitFileModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit GitFileModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    const QList<GitFile> &files() const
+    {
+        return m_files;
+    }
+    void setFiles(const QList<GitFile> &files);
+
+    // Groups files under a row per directory, showing the number of files in it
+    bool grouped() const
+    {
+        return m_grouped;
+    }
+    void setGrouped(bool grouped);
+
+    bool isDirectory(int row) const;
+    GitFile file(int row) const;
+    int rowOf(const QString &path) const;
+    // A directory row stands for all its files
+    QList<GitFile> files(const QModelIndexList &indexes) const;
+
+private:
+    struct Row
+    {
+        QString key;  // File path, or directory path with a trailing '/'
+        GitFile file;
+        int count = 0;
+    };
+
+    QList<Row> buildRows(const QList<GitFile> &files) const;
+    void applyRows(const QList<Row> &rows);
+
+    QList<GitFile> m_files;
+    QList<Row> m_rows;
+    QHash<QString, int> m_rowOfKey;
+    bool m_grouped = false;
+};
+
+#endif  // GITFILEMODEL_H
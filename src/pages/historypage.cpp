@@ -10,8 +10,9 @@
 #include "dialogs/resetdialog.h"
 #include "ui_historypage.h"
 
-HistoryPage::HistoryPage(QWidget *parent, const Project &project)
-    : QWidget(parent), ui(new Ui::HistoryPage), m_project(project)
+HistoryPage::HistoryPage(
+    QWidget *parent, const Project &project, const QSharedPointer<ProjectData> &data)
+    : QWidget(parent), ui(new Ui::HistoryPage), m_project(project), m_data(data)
 {
     ui->setupUi(this);
     ui->splitter->setSizes(QList<int>({300, 300}));
@@ -44,8 +45,11 @@ HistoryPage::HistoryPage(QWidget *parent, const Project &project)
 
     connect(this, &HistoryPage::logResult, this, &HistoryPage::onLogResult);
 
+    m_fileModel = new GitFileModel(this);
+    ui->fileTable->setModel(m_fileModel);
     ui->fileTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-    connect(ui->fileTable, &QTableWidget::itemSelectionChanged, this, &HistoryPage::onFileSelected);
+    connect(ui->fileTable->selectionModel(), &QItemSelectionModel::selectionChanged, this,
+        &HistoryPage::onFileSelected);
 
     connect(ui->diffView, &DiffView::diffParametersChanged, this, &HistoryPage::onFileSelected);
 
@@ -78,18 +82,8 @@ void HistoryPage::updateUI(unsigned flags)
     if (flags & Detail) {
         ui->detailScrollArea->setCommit(m_currentCommit, m_detailResult.rawBody);
 
-        const QList<GitFile> &fileList = m_detailResult.fileList;
-        for (int i = 0; i < fileList.size(); ++i) {
-            GitFile f = fileList.at(i);
-            ui->fileTable->insertRow(i);
-            QTableWidgetItem *modeItem = new QTableWidgetItem(f.mode);
-            modeItem->setToolTip(f.path);
-            ui->fileTable->setItem(i, 0, modeItem);
-            QTableWidgetItem *fileItem = new QTableWidgetItem(f.path);
-            fileItem->setToolTip(f.path);
-            ui->fileTable->setItem(i, 1, fileItem);
-        }
-        if (ui->fileTable->rowCount() > 0) {
+        m_fileModel->setFiles(m_detailResult.fileList);
+        if (m_fileModel->rowCount() > 0) {
             ui->fileTable->selectRow(0);
         }
     }
@@ -111,7 +105,7 @@ void HistoryPage::reset(unsigned flags)
         m_detailResult = {};
         m_detailWorker.cancel();
         ui->detailScrollArea->reset();
-        ui->fileTable->setRowCount(0);
+        m_fileModel->setFiles({});
     }
     if (flags & Diff) {
         m_diffResult = {};
@@ -165,39 +159,11 @@ void HistoryPage::onCommitSelected(const QModelIndex &current, const QModelIndex
 {
     reset(Detail | Diff);
     const Commit &commit = current.data(HistoryTableModel::CommitRole).value<Commit>();
-    const QString &projectPath = this->m_project.absPath;
 
     m_currentCommit = commit;
     m_indicator->startHint();
-    m_detailWorker = QtConcurrent::run([projectPath, commit](QPromise<DetailResult> &promise) {
-        DetailResult result;
-        result.rawBody =
-            global::getCmdResult("git log --format=%B -n1 " + commit.hash, projectPath);
-        QString cmdResult;
-        if (commit.parents.size() > 1) {
-            cmdResult = global::getCmdResult(
-                QString("git diff --name-status -M %1 %2").arg(commit.parents.first(), commit.hash),
-                projectPath);
-        } else {
-            cmdResult = global::getCmdResult(
-                QString("git diff-tree --name-status --no-commit-id -M -r --root %1")
-                    .arg(commit.hash),
-                projectPath);
-        }
-        QStringList lines = cmdResult.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            QString line = lines[i];
-            if (line.isEmpty()) {
-                continue;
-            }
-            QStringList parts = line.split('\t');
-            if (parts[0].startsWith("R")) {
-                result.fileList.emplaceBack(parts[2], "R");
-            } else {
-                result.fileList.emplaceBack(parts[1], parts[0]);
-            }
-        }
-        promise.addResult(result);
+    m_detailWorker = QtConcurrent::run([data = m_data, commit]() {
+        return data->readCommitDetail(commit);
     });
     QPointer thisPtr(this);
     m_detailWorker
@@ -216,33 +182,23 @@ void HistoryPage::onCommitSelected(const QModelIndex &current, const QModelIndex
 void HistoryPage::onFileSelected()
 {
     reset(Diff);
-    const QString &projectPath = this->m_project.absPath;
     const Commit &commit = this->m_currentCommit;
-    QModelIndexList indexes = ui->fileTable->selectionModel()->selectedIndexes();
+    QModelIndexList indexes = ui->fileTable->selectionModel()->selectedRows();
     if (indexes.empty()) {
         return;
     }
-    const GitFile &file = m_detailResult.fileList.at(indexes.first().row());
-    QString cmd;
-    if (commit.parents.size() > 1) {
-        cmd = QString("git diff -U%1 -M %2 %3 -- %4")
-                  .arg(QString::number(ui->diffView->getContextLines()), commit.parents.first(),
-                      commit.hash, file.path);
-    } else {
-        cmd = QString("git diff-tree -M -p -U%1 --root %2 -- %3")
-                  .arg(QString::number(ui->diffView->getContextLines()), commit.hash, file.path);
-    }
+    const GitFile &file = m_fileModel->file(indexes.first().row());
+    const int contextLines = ui->diffView->getContextLines();
     m_indicator->startHint();
-    m_diffWorker = QtConcurrent::run([=](QPromise<DiffResult> &promise) {
-        QString cmdResult = global::getCmdResult(cmd, projectPath);
-        if (promise.isCanceled()) {
-            return;
-        }
-        DiffResult result;
-        result.file = file;
-        result.hunks = parseDiffHunks(cmdResult);
-        promise.addResult(result);
-    });
+    m_diffWorker = QtConcurrent::run(
+        [data = m_data, commit, file, contextLines](QPromise<DiffResult> &promise) {
+            DiffResult result;
+            result.file = file;
+            result.hunks = data->readCommitDiff(commit, file.path, contextLines);
+            if (!promise.isCanceled()) {
+                promise.addResult(result);
+            }
+        });
     QPointer thisPtr(this);
     m_diffWorker
         .then(qApp,
@@ -331,12 +287,13 @@ void HistoryPage::onFetchMoreCommits(int skip, const HistorySelectionArg &arg)
     }
 
     LogResult &result = this->m_logResult;
-    QString &path = this->m_project.absPath;
-    int orderType = ui->orderComboBox->currentIndex();
-    int branchType = ui->branchComboBox->currentIndex();
-    bool showRemotes = ui->remotesCheckBox->isChecked();
-    int pageSize = global::commitPageSize;
-    int originalSkip = skip;
+    QSharedPointer<ProjectData> data = m_data;
+    ProjectData::LogKey key;
+    key.skip = skip;
+    key.maxCount = global::commitPageSize;
+    key.orderType = ui->orderComboBox->currentIndex();
+    key.branchType = ui->branchComboBox->currentIndex();
+    key.showRemotes = ui->remotesCheckBox->isChecked();
 
     m_indicator->startHint();
     if (arg.isSearchable()) {
@@ -352,8 +309,7 @@ void HistoryPage::onFetchMoreCommits(int skip, const HistorySelectionArg &arg)
             result.graphTable.clear();
             bool searchHit = false;
 
-            readCommits(promise, path, skip, pageSize, orderType, branchType, showRemotes, arg,
-                result, searchHit);
+            readCommits(promise, *data, key, arg, result, searchHit);
             if (promise.isCanceled()) {
                 break;
             }
@@ -361,12 +317,12 @@ void HistoryPage::onFetchMoreCommits(int skip, const HistorySelectionArg &arg)
             if (promise.isCanceled()) {
                 break;
             }
-            emit logResult(result, arg, skip + result.commits.size());
+            emit logResult(result, arg, key.skip + result.commits.size());
 
-            if (!arg.isSearchable() || searchHit || result.commits.size() < pageSize) {
+            if (!arg.isSearchable() || searchHit || result.commits.size() < key.maxCount) {
                 break;
             }
-            skip += result.commits.size();
+            key.skip += result.commits.size();
         }
     });
     QPointer thisPtr(this);
@@ -397,62 +353,16 @@ void HistoryPage::onLogResult(LogResult result, HistorySelectionArg arg, int cou
     }
 }
 
-void HistoryPage::readCommits(QPromise<void> &promise, const QString &projectPath, int skip,
-    int maxCount, int orderType, int branchType, bool showRemotes, const HistorySelectionArg &arg,
-    LogResult &result, bool &searchHit)
+void HistoryPage::readCommits(QPromise<void> &promise, ProjectData &data,
+    const ProjectData::LogKey &key, const HistorySelectionArg &arg, LogResult &result,
+    bool &searchHit)
 {
-    QString cmdResult = global::getCmdResult(
-        QString("git log --decorate=full --skip=%1 --max-count=%2%3%4%5 --branches --tags "
-                "--full-history --format=%H¿%h¿%P¿%ci¿%cn¿%ce¿%ai¿%an¿%ae¿%d¿%s HEAD")
-            .arg(QString::number(skip), QString::number(maxCount),
-                orderType ? " --topo-order" : " --date-order", branchType ? " --branches" : "",
-                showRemotes ? " --remotes" : ""),
-        projectPath);
-    QStringList lines = cmdResult.split('\n');
-    QString line;
-    foreach (line, lines) {
+    // Shared with the other pages of the project
+    result.commits = data.readLog(key);
+    for (const Commit &c : std::as_const(result.commits)) {
         if (promise.isCanceled()) {
             return;
         }
-        if (line.startsWith("fatal:") || line.startsWith("error:")) {
-            qDebug() << "readCommits()" << line;
-            return;
-        }
-        if (line.isEmpty()) {
-            continue;
-        }
-        //        qDebug() << line;
-        QStringList parts = line.split("¿");
-        Commit &c = result.commits.emplaceBack();
-        c.hash = parts.at(0);
-        c.shortHash = parts.at(1);
-        c.parents = parts.at(2).isEmpty() ? QStringList() : parts.at(2).split(" ");
-        c.commitDate = parts.at(3);
-        c.committer = parts.at(4);
-        c.committerEmail = parts.at(5);
-        c.authorDate = parts.at(6);
-        c.author = parts.at(7);
-        c.authorEmail = parts.at(8);
-        c.isHEAD = false;
-        if (!parts.at(9).isEmpty()) {
-            QStringList refs = parts.at(9).trimmed().sliced(1).chopped(1).split(", ");
-            for (QString r : refs) {
-                if (r.startsWith("HEAD")) {
-                    c.isHEAD = true;
-                    if (r.startsWith("HEAD -> ")) {
-                        r = r.sliced(8);
-                    }
-                }
-                if (r.startsWith("tag: refs/tags/"))
-                    c.tags << r.sliced(15);
-                else if (r.startsWith("refs/heads/"))
-                    c.heads << r.sliced(11);
-                else if (r.startsWith("refs/remotes/"))
-                    c.remotes << r.sliced(13);
-            }
-        }
-        c.subject = parts.at(10);
-
         if (arg.match(c)) {
             searchHit = true;
         }
@@ -7,6 +7,8 @@
 #include <QWaitCondition>
 #include <QWidget>
 
+#include "git/projectdata.h"
+#include "gitfilemodel.h"
 #include "global.h"
 #include "historygraphdelegate.h"
 #include "historytablemodel.h"
@@ -33,7 +35,7 @@ private:
     };
 
 public:
-    HistoryPage(QWidget *parent, const Project &project);
+    HistoryPage(QWidget *parent, const Project &project, const QSharedPointer<ProjectData> &data);
     ~HistoryPage();
 
     void refresh(const HistorySelectionArg &arg = HistorySelectionArg());
@@ -45,6 +47,7 @@ private:
     Ui::HistoryPage *ui;
     QProgressIndicator *m_indicator;
     HistoryTableModel *m_historyModel;
+    GitFileModel *m_fileModel;
     HistoryGraphDelegate *m_graphDelegate;
 
     struct LogResult
@@ -58,11 +61,7 @@ private:
         int newLaneId = 0;
         int laneCount = 0;
     };
-    struct DetailResult
-    {
-        QString rawBody;
-        QList<GitFile> fileList;
-    };
+    using DetailResult = ProjectData::CommitDetail;
     struct DiffResult
     {
         GitFile file;
@@ -70,6 +69,7 @@ private:
     };
 
     Project m_project;
+    QSharedPointer<ProjectData> m_data;
     Commit m_currentCommit;
     LogResult m_logResult;
     DetailResult m_detailResult;
@@ -81,9 +81,9 @@ private:
     QFuture<DetailResult> m_detailWorker;
     QFuture<DiffResult> m_diffWorker;
 
-    static void readCommits(QPromise<void> &promise, const QString &projectPath, int skip,
-        int maxCount, int orderType, int branchType, bool showRemotes,
-        const HistorySelectionArg &arg, LogResult &result, bool &searchHit);
+    static void readCommits(QPromise<void> &promise, ProjectData &data,
+        const ProjectData::LogKey &key, const HistorySelectionArg &arg, LogResult &result,
+        bool &searchHit);
     static void buildGraphTable(QPromise<void> &promise, LogResult &result);
 
 signals:
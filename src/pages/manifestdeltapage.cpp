@@ -0,0 +1,283 @@
+#include "manifestdeltapage.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QtConcurrent>
+
+#include "global.h"
+#include "ui_manifestdeltapage.h"
+
+enum Column
+{
+    SubjectColumn,
+    HashColumn,
+    AuthorColumn,
+    DateColumn,
+};
+
+ManifestDeltaPage::ManifestDeltaPage(const RepoContext &context)
+    : QWidget(nullptr), ui(new Ui::ManifestDeltaPage), m_context(context)
+{
+    ui->setupUi(this);
+    // Mostly waiting on git and the disk, more than the cores pays off
+    m_pool.setMaxThreadCount(qBound(4, QThread::idealThreadCount() * 2, 32));
+    ui->jobsSpin->setValue(m_pool.maxThreadCount());
+    connect(ui->jobsSpin, &QSpinBox::valueChanged, this, [this](int value) {
+        m_pool.setMaxThreadCount(value);
+    });
+
+    addSources(ui->fromCombo, {});
+    addSources(ui->toCombo, {});
+    ui->fromCombo->setCurrentIndex(qMax(0, ui->fromCombo->findData("presync")));
+    ui->toCombo->setCurrentIndex(ui->toCombo->findData("head"));
+
+    ui->treeWidget->header()->setSectionResizeMode(QHeaderView::Interactive);
+    ui->treeWidget->header()->setSectionResizeMode(SubjectColumn, QHeaderView::Stretch);
+    ui->treeWidget->setColumnWidth(HashColumn, 160);
+    ui->treeWidget->setColumnWidth(AuthorColumn, 200);
+    ui->treeWidget->setColumnWidth(DateColumn, 130);
+    connect(ui->treeWidget, &QTreeWidget::itemDoubleClicked, this,
+        [this](QTreeWidgetItem *item, int column) {
+            const QString hash = item->data(HashColumn, Qt::UserRole).toString();
+            if (hash.isEmpty() || !item->parent()) {
+                return;
+            }
+            const ManifestPtr manifest = m_context.manifest();
+            const QString path = item->parent()->data(SubjectColumn, Qt::UserRole).toString();
+            if (const Project *project = manifest->findProject(path)) {
+                emit commitDoubleClicked(*project, hash);
+            }
+        });
+
+    for (auto [combo, button] : {std::pair(ui->fromCombo, ui->fromBrowseBtn),
+             std::pair(ui->toCombo, ui->toBrowseBtn)}) {
+        connect(button, &QToolButton::clicked, this, [this, combo = combo]() {
+            const QString filePath = QFileDialog::getOpenFileName(
+                this, "Open Manifest", m_context.repoPath(), "Manifests (*.xml)");
+            if (!filePath.isEmpty()) {
+                combo->addItem(QDir::toNativeSeparators(filePath), "file:" + filePath);
+                combo->setCurrentIndex(combo->count() - 1);
+            }
+        });
+    }
+    connect(ui->compareBtn, &QPushButton::clicked, this, &ManifestDeltaPage::compare);
+    connect(&m_deltaWatcher, &QFutureWatcher<ProjectDelta>::resultReadyAt, this,
+        &ManifestDeltaPage::onDelta);
+    connect(&m_deltaWatcher, &QFutureWatcher<ProjectDelta>::finished, this,
+        &ManifestDeltaPage::updateSummary);
+
+    // Branches as last fetched, fetching is up to Switch Manifest
+    const QString manifestsDir = QDir::cleanPath(context.repoPath() + "/.repo/manifests");
+    QPointer thisPtr(this);
+    QtConcurrent::run([manifestsDir]() {
+        QStringList branches;
+        const QStringList lines = global::getCmdResult("git branch -r", manifestsDir).split('\n');
+        for (const QString &line : lines) {
+            const QString branch = line.trimmed();
+            if (branch.startsWith("origin/") && !branch.contains(" -> ")) {
+                branches << branch;
+            }
+        }
+        return branches;
+    }).then(qApp, [thisPtr](const QStringList &branches) {
+        if (thisPtr.isNull()) return;
+        thisPtr->addSources(thisPtr->ui->fromCombo, branches);
+        thisPtr->addSources(thisPtr->ui->toCombo, branches);
+    });
+}
+
+ManifestDeltaPage::~ManifestDeltaPage()
+{
+    // The pool still waits for the projects in flight
+    m_deltaWatcher.cancel();
+    delete ui;
+}
+
+void ManifestDeltaPage::addSources(QComboBox *combo, const QStringList &manifestBranches)
+{
+    if (manifestBranches.isEmpty()) {
+        combo->addItem("Checked out", "head");
+        if (QFile::exists(ManifestSnapshot::preSyncPath(m_context.repoPath()))) {
+            combo->addItem("Before last sync", "presync");
+        }
+        return;
+    }
+    for (const QString &branch : manifestBranches) {
+        combo->addItem("Manifest " + branch, "branch:" + branch);
+    }
+}
+
+QString ManifestDeltaPage::sourceOf(const QComboBox *combo)
+{
+    const int index = combo->currentIndex();
+    if (index >= 0 && combo->currentText() == combo->itemText(index)) {
+        return combo->itemData(index).toString();
+    }
+    return "file:" + QDir::fromNativeSeparators(combo->currentText().trimmed());
+}
+
+ManifestSnapshot ManifestDeltaPage::readSource(
+    const QString &source, const QString &repoPath, const Manifest &manifest)
+{
+    if (source == "head") {
+        return ManifestSnapshot::checkout(manifest);
+    }
+    if (source == "presync") {
+        return ManifestSnapshot::readFile(repoPath, ManifestSnapshot::preSyncPath(repoPath));
+    }
+    if (source.startsWith("branch:")) {
+        return ManifestSnapshot::readManifestBranch(repoPath, source.mid(7));
+    }
+    return ManifestSnapshot::readFile(repoPath, source.mid(5));
+}
+
+void ManifestDeltaPage::compare()
+{
+    // In flight projects finish in the background, their results are dropped
+    m_deltaWatcher.cancel();
+    ui->treeWidget->clear();
+    m_unchanged = 0;
+    m_unresolved = 0;
+    m_commits = 0;
+    m_timer.start();
+    ui->compareBtn->setEnabled(false);
+    ui->summaryLabel->setText("Reading snapshots...");
+
+    const QString oldSource = sourceOf(ui->fromCombo);
+    const QString newSource = sourceOf(ui->toCombo);
+    const QString repoPath = m_context.repoPath();
+    const ManifestPtr manifest = m_context.manifest();
+    m_snapshotWorker = QtConcurrent::run(&m_pool, [=]() {
+        return SnapshotPair(
+            readSource(oldSource, repoPath, *manifest), readSource(newSource, repoPath, *manifest));
+    });
+    QPointer thisPtr(this);
+    m_snapshotWorker.then(qApp, [thisPtr, repoPath](const SnapshotPair &snapshots) {
+        if (thisPtr.isNull()) return;
+        thisPtr->ui->compareBtn->setEnabled(true);
+        const auto &[oldSnapshot, newSnapshot] = snapshots;
+        if (!oldSnapshot.isValid() || !newSnapshot.isValid()) {
+            thisPtr->ui->summaryLabel->setText(
+                oldSnapshot.isValid() ? newSnapshot.error : oldSnapshot.error);
+            return;
+        }
+
+        QList<DeltaJob> jobs;
+        QStringList paths = oldSnapshot.projects.keys() + newSnapshot.projects.keys();
+        paths.removeDuplicates();
+        jobs.reserve(paths.size());
+        for (const QString &path : std::as_const(paths)) {
+            auto oldIt = oldSnapshot.projects.constFind(path);
+            auto newIt = newSnapshot.projects.constFind(path);
+            DeltaJob job{path, QDir::cleanPath(repoPath + "/" + path),
+                oldIt != oldSnapshot.projects.cend(), newIt != newSnapshot.projects.cend(), {},
+                {}};
+            if (job.hasOld) job.oldEntry = *oldIt;
+            if (job.hasNew) job.newEntry = *newIt;
+            jobs.append(job);
+        }
+        thisPtr->m_deltaWatcher.setFuture(
+            QtConcurrent::mapped(&thisPtr->m_pool, std::move(jobs), [](const DeltaJob &job) {
+                return ManifestDelta::instance().compute(job.absPath, job.path,
+                    job.hasOld ? &job.oldEntry : nullptr, job.hasNew ? &job.newEntry : nullptr);
+            }));
+        thisPtr->updateSummary();
+    });
+}
+
+void ManifestDeltaPage::onDelta(int index)
+{
+    const ProjectDelta delta = m_deltaWatcher.resultAt(index);
+    if (delta.kind == ProjectDelta::Unchanged) {
+        ++m_unchanged;
+        updateSummary();
+        return;
+    }
+
+    QString text = delta.path;
+    switch (delta.kind) {
+        case ProjectDelta::Changed:
+            text += QString("  (+%1%3, -%2%3)")
+                        .arg(delta.added.size())
+                        .arg(delta.dropped.size())
+                        .arg(delta.truncated ? "+" : "");
+            break;
+        case ProjectDelta::Added:
+            text += "  (new project)";
+            break;
+        case ProjectDelta::Removed:
+            text += "  (removed project)";
+            break;
+        case ProjectDelta::Unresolved:
+            text += "  (revision not found, fetch first)";
+            ++m_unresolved;
+            break;
+        default:
+            break;
+    }
+    auto item = new QTreeWidgetItem;
+    item->setText(SubjectColumn, text);
+    item->setData(SubjectColumn, Qt::UserRole, delta.path);
+    const QString oldRevision = delta.oldOid.isEmpty() ? delta.oldRevision : delta.oldOid.left(8);
+    const QString newRevision = delta.newOid.isEmpty() ? delta.newRevision : delta.newOid.left(8);
+    item->setText(HashColumn, oldRevision + " → " + newRevision);
+    item->setToolTip(HashColumn, delta.oldRevision + " → " + delta.newRevision);
+    addCommitItems(item, delta.added, "+ ");
+    addCommitItems(item, delta.dropped, "- ");
+    m_commits += delta.added.size() + delta.dropped.size();
+
+    // Sorted by path while the projects come in out of order
+    int first = 0;
+    int last = ui->treeWidget->topLevelItemCount();
+    while (first < last) {
+        const int middle = (first + last) / 2;
+        if (ui->treeWidget->topLevelItem(middle)->data(SubjectColumn, Qt::UserRole).toString() <
+            delta.path) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    ui->treeWidget->insertTopLevelItem(first, item);
+    updateSummary();
+}
+
+void ManifestDeltaPage::addCommitItems(
+    QTreeWidgetItem *parent, const QList<DeltaCommit> &commits, const QString &prefix)
+{
+    QList<QTreeWidgetItem *> items;
+    items.reserve(commits.size());
+    for (const DeltaCommit &commit : commits) {
+        auto item = new QTreeWidgetItem;
+        item->setText(SubjectColumn, prefix + commit.subject);
+        item->setToolTip(SubjectColumn, commit.subject);
+        item->setText(HashColumn, commit.hash.left(8));
+        item->setToolTip(HashColumn, commit.hash);
+        item->setData(HashColumn, Qt::UserRole, commit.hash);
+        item->setText(AuthorColumn, commit.author);
+        item->setText(
+            DateColumn, QDateTime::fromSecsSinceEpoch(commit.time).toString("yyyy-MM-dd hh:mm"));
+        items.append(item);
+    }
+    parent->addChildren(items);
+}
+
+void ManifestDeltaPage::updateSummary()
+{
+    QString text = QString("%1 projects changed, %2 commits, %3 unchanged")
+                       .arg(ui->treeWidget->topLevelItemCount() - m_unresolved)
+                       .arg(m_commits)
+                       .arg(m_unchanged);
+    if (m_unresolved > 0) {
+        text += QString(", %1 not resolved").arg(m_unresolved);
+    }
+    if (m_deltaWatcher.isRunning()) {
+        text += QString("  |  %1 of %2...")
+                    .arg(m_deltaWatcher.progressValue())
+                    .arg(m_deltaWatcher.progressMaximum());
+    } else {
+        text += QString("  |  %1 ms").arg(m_timer.elapsed());
+    }
+    ui->summaryLabel->setText(text);
+}
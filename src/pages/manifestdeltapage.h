@@ -0,0 +1,66 @@
+#ifndef MANIFESTDELTAPAGE_H
+#define MANIFESTDELTAPAGE_H
+
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QWidget>
+
+#include "git/manifestdelta.h"
+#include "repocontext.h"
+
+namespace Ui {
+    class ManifestDeltaPage;
+}
+
+class QTreeWidgetItem;
+
+// Commits that came and went in every project between two manifest snapshots
+class ManifestDeltaPage : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ManifestDeltaPage(const RepoContext &context);
+    ~ManifestDeltaPage();
+
+signals:
+    void commitDoubleClicked(const Project &project, const QString &hash);
+
+private:
+    struct DeltaJob
+    {
+        QString path;
+        QString absPath;
+        bool hasOld;
+        bool hasNew;
+        ManifestSnapshot::Entry oldEntry;
+        ManifestSnapshot::Entry newEntry;
+    };
+
+    using SnapshotPair = std::pair<ManifestSnapshot, ManifestSnapshot>;
+
+    Ui::ManifestDeltaPage *ui;
+    RepoContext m_context;
+    QThreadPool m_pool;
+    QFuture<SnapshotPair> m_snapshotWorker;
+    QFutureWatcher<ProjectDelta> m_deltaWatcher;
+    QElapsedTimer m_timer;
+    int m_unchanged = 0;
+    int m_unresolved = 0;
+    int m_commits = 0;
+
+    void addSources(QComboBox *combo, const QStringList &manifestBranches);
+    // "head", "presync", "branch:<name>" or a file path typed in
+    static QString sourceOf(const QComboBox *combo);
+    static ManifestSnapshot readSource(
+        const QString &source, const QString &repoPath, const Manifest &manifest);
+    void compare();
+    void onDelta(int index);
+    void addCommitItems(QTreeWidgetItem *parent, const QList<DeltaCommit> &commits,
+        const QString &prefix);
+    void updateSummary();
+};
+
+#endif  // MANIFESTDELTAPAGE_H
@@ -1,7 +1,6 @@
 #include "newtabpage.h"
 
 #include <QPainter>
-#include <QSortFilterProxyModel>
 #include <QTimer>
 
 #include "ui_newtabpage.h"
@@ -12,16 +11,26 @@ NewTabPage::NewTabPage(const RepoContext &context)
     : QWidget(nullptr), ui(new Ui::NewTabPage), m_context(context)
 {
     ui->setupUi(this);
-    auto filterModel = new ProjectListFilterModel(this);
-    filterModel->setSourceModel(new ProjectListModel(this, context));
-    filterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    ui->listView->setModel(filterModel);
+    auto model = new ProjectListModel(this, context);
+    ui->listView->setModel(model);
     ui->listView->setItemDelegate(new ProjectListDelegate(this));
+    ui->listView->setUniformItemSizes(true);
     connect(ui->listView, &QListView::doubleClicked, this, [this](const QModelIndex &index) {
         emit projectDoubleClicked(index.data(Qt::UserRole).value<Project>());
     });
-    connect(ui->searchEdit, &QLineEdit::textChanged, filterModel,
-        &QSortFilterProxyModel::setFilterFixedString);
+    connect(ui->searchEdit, &QLineEdit::textChanged, this, [this, model](const QString &text) {
+        model->setQuery(text);
+        // The best match, for Enter
+        if (!text.isEmpty() && model->rowCount(QModelIndex()) > 0) {
+            ui->listView->setCurrentIndex(model->index(0));
+        }
+    });
+    connect(ui->searchEdit, &QLineEdit::returnPressed, this, [this]() {
+        const QModelIndex index = ui->listView->currentIndex();
+        if (index.isValid()) {
+            emit projectDoubleClicked(index.data(Qt::UserRole).value<Project>());
+        }
+    });
 
     QTimer::singleShot(0, ui->searchEdit, SLOT(setFocus()));
 }
@@ -32,28 +41,44 @@ NewTabPage::~NewTabPage()
 }
 
 ProjectListModel::ProjectListModel(QObject *parent, const RepoContext &context)
-    : QAbstractListModel(parent), m_context(context)
+    : QAbstractListModel(parent), m_context(context), m_search(context.manifest())
 {
+    m_rows = m_search.search(m_query);
+    connect(context.state(), &RepoState::manifestChanged, this, [this]() {
+        beginResetModel();
+        m_search = ProjectSearch(m_context.manifest());
+        m_rows = m_search.search(m_query);
+        endResetModel();
+    });
 }
 
 int ProjectListModel::rowCount(const QModelIndex &parent) const
 {
-    return m_context.manifest().projectList.size();
+    return parent.isValid() ? 0 : m_rows.size();
 }
 
 QVariant ProjectListModel::data(const QModelIndex &index, int role) const
 {
-    const Project &project = m_context.manifest().projectList[index.row()];
-    if (role == Qt::DisplayRole) {  // Used when sorting
-        return project.path;
+    const Project &project = m_search.manifest()->projectList[m_rows[index.row()].project];
+    switch (role) {
+        case Qt::DisplayRole:
+            return project.path;
+        case NameRole:
+            return project.name;
+        case Qt::UserRole:
+            return QVariant::fromValue(project);
     }
-    if (role == Qt::UserRole) {
-        return QVariant::fromValue(project);
-    }
-
     return QVariant();
 }
 
+void ProjectListModel::setQuery(const QString &query)
+{
+    beginResetModel();
+    m_query = query;
+    m_rows = m_search.search(query);
+    endResetModel();
+}
+
 ProjectListDelegate::ProjectListDelegate(QObject *parent) : QStyledItemDelegate(parent)
 {
 }
@@ -77,45 +102,41 @@ void ProjectListDelegate::paint(
     style->drawControl(QStyle::CE_ItemViewItem, &opt, painter);
 
     // Text
-    QFont font = painter->font();
-    font.setPointSize(PATH_FONT_SIZE);
-    const int pathHeight = QFontMetrics(font).height();
-    font.setPointSize(NAME_FONT_SIZE);
-    const int nameHeight = QFontMetrics(font).height();
-    const int top = (rect.height() - pathHeight - LINE_SPACING - nameHeight) / 2;
-    const Project &project = index.data(Qt::UserRole).value<Project>();
+    updateFonts(painter->font());
+    const int top = (rect.height() - m_pathHeight - LINE_SPACING - m_nameHeight) / 2;
     const QPalette::ColorRole textRole =
         opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text;
 
     // Path
-    font.setPointSize(PATH_FONT_SIZE);
-    painter->setFont(font);
+    painter->setFont(m_pathFont);
     style->drawItemText(painter, rect.adjusted(10, top, -10, 0), Qt::AlignTop, opt.palette, true,
-        project.path, textRole);
+        index.data(Qt::DisplayRole).toString(), textRole);
 
     // Name
-    font.setPointSize(NAME_FONT_SIZE);
-    painter->setFont(font);
+    painter->setFont(m_nameFont);
     opt.palette.setColor(QPalette::Text, Qt::gray);
-    style->drawItemText(painter, rect.adjusted(10, top + pathHeight + LINE_SPACING, -10, 0),
-        Qt::AlignTop, opt.palette, true, project.name, textRole);
-}
-
-QSize ProjectListDelegate::sizeHint(
-    const QStyleOptionViewItem &option, const QModelIndex &index) const
-{
-    return QSize(0, 40);
+    style->drawItemText(painter, rect.adjusted(10, top + m_pathHeight + LINE_SPACING, -10, 0),
+        Qt::AlignTop, opt.palette, true, index.data(ProjectListModel::NameRole).toString(),
+        textRole);
+    painter->setFont(m_baseFont);
 }
 
-ProjectListFilterModel::ProjectListFilterModel(QObject *parent)
+void ProjectListDelegate::updateFonts(const QFont &baseFont) const
 {
+    if (m_pathHeight > 0 && baseFont == m_baseFont) {
+        return;
+    }
+    m_baseFont = baseFont;
+    m_pathFont = baseFont;
+    m_pathFont.setPointSize(PATH_FONT_SIZE);
+    m_pathHeight = QFontMetrics(m_pathFont).height();
+    m_nameFont = baseFont;
+    m_nameFont.setPointSize(NAME_FONT_SIZE);
+    m_nameHeight = QFontMetrics(m_nameFont).height();
 }
 
-bool ProjectListFilterModel::filterAcceptsRow(
-    int source_row, const QModelIndex &source_parent) const
+QSize ProjectListDelegate::sizeHint(
+    const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    const QModelIndex &index = sourceModel()->index(source_row, 0, source_parent);
-    const Project &project = index.data(Qt::UserRole).value<Project>();
-    return project.name.contains(filterRegularExpression()) ||
-           project.path.contains(filterRegularExpression());
+    return QSize(0, 40);
 }
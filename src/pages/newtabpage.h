@@ -2,11 +2,11 @@
 #define NEWTABPAGE_H
 
 #include <QAbstractListModel>
-#include <QSortFilterProxyModel>
 #include <QStyledItemDelegate>
 #include <QWidget>
 
 #include "global.h"
+#include "projectsearch.h"
 #include "repocontext.h"
 
 namespace Ui {
@@ -28,17 +28,28 @@ private:
     RepoContext m_context;
 };
 
+// Projects matching the search query, best first
 class ProjectListModel : public QAbstractListModel
 {
     Q_OBJECT
 
 public:
+    enum Role
+    {
+        NameRole = Qt::UserRole + 1,
+    };
+
     ProjectListModel(QObject *parent, const RepoContext &context);
     int rowCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
 
+    void setQuery(const QString &query);
+
 private:
     RepoContext m_context;
+    ProjectSearch m_search;  // Its manifest is the one the rows index into
+    QString m_query;
+    QList<ProjectSearch::Result> m_rows;
 };
 
 class ProjectListDelegate : public QStyledItemDelegate
@@ -50,17 +61,16 @@ public:
     void paint(QPainter *painter, const QStyleOptionViewItem &option,
         const QModelIndex &index) const override;
     QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
-};
-
-class ProjectListFilterModel : public QSortFilterProxyModel
-{
-    Q_OBJECT
 
-public:
-    ProjectListFilterModel(QObject *parent);
+private:
+    // Derived from the view's font on first paint
+    mutable QFont m_baseFont;
+    mutable QFont m_pathFont;
+    mutable QFont m_nameFont;
+    mutable int m_pathHeight = 0;
+    mutable int m_nameHeight = 0;
 
-protected:
-    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+    void updateFonts(const QFont &baseFont) const;
 };
 
 #endif  // NEWTABPAGE_H
@@ -2,12 +2,15 @@
 
 #include <QDesktopServices>
 #include <QShortcut>
+#include <QTimer>
 #include <QUrl>
 
 #include "dialogs/cleandialog.h"
 #include "dialogs/fetchdialog.h"
 #include "dialogs/pulldialog.h"
 #include "dialogs/pushdialog.h"
+#include "dialogs/statuscachedialog.h"
+#include "git/projectstatus.h"
 #include "themes/icon.h"
 #include "ui_pagehost.h"
 
@@ -34,14 +37,38 @@ PageHost::PageHost(const RepoContext &context, const Project &project)
 
     // Ref tree
     connect(ui->refTreeView, &QTreeView::clicked, this, &PageHost::onRefClicked);
+    connect(ui->refFilterEdit, &QLineEdit::textChanged, ui->refTreeView, &RefTreeView::setFilter);
     connect(ui->refTreeView, &RefTreeView::requestRefreshEvent, this, [&](HistorySelectionArg arg) {
         refresh(arg);
     });
 
-    ui->refTreeView->setProjectPath(m_project.absPath);
+    // Shortcuts
+    QShortcut *shortcut = new QShortcut(QKeySequence::Refresh, this);
+    connect(shortcut, &QShortcut::activated, this, [&]() {
+        refresh();
+    });
+}
 
-    m_changesPage = new ChangesPage(this, m_project);
-    m_historyPage = new HistoryPage(this, m_project);
+PageHost::~PageHost()
+{
+    delete ui;
+}
+
+void PageHost::activate()
+{
+    if (isActivated()) {
+        return;
+    }
+    m_data = ProjectData::get(m_project.absPath);
+    // The project's own revision, it may be pinned or come from another remote
+    const ManifestPtr manifest = m_context.manifest();
+    const Project *current = manifest ? manifest->findProject(m_project.path) : nullptr;
+    const Project &project = current ? *current : m_project;
+    ui->refTreeView->setProjectData(
+        m_data, ProjectStatus::revisionRef(project.remote, project.revision));
+
+    m_changesPage = new ChangesPage(this, m_project, m_data);
+    m_historyPage = new HistoryPage(this, m_project, m_data);
     ui->rightPanel->insertWidget(0, m_changesPage);
     ui->rightPanel->insertWidget(1, m_historyPage);
     connect(m_changesPage, &ChangesPage::commitEvent, this, [&](HistorySelectionArg arg) {
@@ -55,19 +82,40 @@ PageHost::PageHost(const RepoContext &context, const Project &project)
     connect(m_historyPage, &HistoryPage::requestRefreshEvent, this, [&]() {
         refresh();
     });
+    // Another page of the project refreshed it
+    connect(m_data.get(), &ProjectData::historyChanged, this, [this]() {
+        if (!m_refreshing) {
+            m_historyPage->refresh();
+        }
+    });
 
-    // Shortcuts
-    QShortcut *shortcut = new QShortcut(QKeySequence::Refresh, this);
-    connect(shortcut, &QShortcut::activated, this, [&]() {
-        refresh();
+    // Counts the first status and the first history page, whichever way they end
+    m_pendingLoads = 2;
+    auto onLoaded = [this]() {
+        if (m_pendingLoads > 0 && --m_pendingLoads == 0) {
+            emit warmedUp();
+        }
+    };
+    connect(m_changesPage, &ChangesPage::newChangesEvent, this, onLoaded,
+        Qt::SingleShotConnection);
+    connect(m_historyPage, &HistoryPage::logResult, this, onLoaded, Qt::SingleShotConnection);
+    QTimer::singleShot(10000, this, [this]() {
+        if (m_pendingLoads > 0) {
+            m_pendingLoads = 0;
+            emit warmedUp();
+        }
     });
 
     ui->changesModeBtn->setChecked(true);
 }
 
-PageHost::~PageHost()
+void PageHost::showEvent(QShowEvent *event)
 {
-    delete ui;
+    if (isActivated() && !m_data->isWatchingRefs()) {
+        // Cheap when nothing moved, the same snapshot comes back
+        m_data->refreshRefs();
+    }
+    activate();
 }
 
 void PageHost::onActionPush()
@@ -115,20 +163,43 @@ void PageHost::onActionFolder()
     QDesktopServices::openUrl(QUrl::fromLocalFile(m_project.absPath));
 }
 
+void PageHost::onActionStatusCache()
+{
+    StatusCacheDialog dialog(this, m_project.absPath);
+    dialog.exec();
+    refresh();
+}
+
 void PageHost::refresh(const HistorySelectionArg &arg)
 {
-    ui->refTreeView->refresh();
-    m_changesPage->refresh();
+    if (!isActivated()) {
+        // Loads everything fresh anyway
+        activate();
+        if (arg.type != HistorySelectionArg::Null) {
+            m_historyPage->refresh(arg);
+        }
+        return;
+    }
+    // The status and the refs come back through the project data, to every page showing it
+    m_refreshing = true;
+    m_data->refresh();
+    m_refreshing = false;
     m_historyPage->refresh(arg);
 }
 
+void PageHost::showCommit(const QString &hash)
+{
+    refresh(HistorySelectionArg(HistorySelectionArg::Hash, hash));
+    ui->historyModeBtn->setChecked(true);
+}
+
 void PageHost::onRefClicked(const QModelIndex &index)
 {
     if (!index.isValid()) {
         return;
     }
     RefTreeItem *item = static_cast<RefTreeItem *>(index.internalPointer());
-    if (item->type >= RefTreeItem::Branch) {
+    if (item->type >= RefTreeItem::Branch && isActivated()) {
         ui->historyModeBtn->setChecked(true);
         m_historyPage->jumpToRef(item);
     }
@@ -16,25 +16,47 @@ class PageHost : public QWidget
     Q_OBJECT
 
 public:
+    // Cheap until activated, restored tabs stay that way until shown or warmed up
     explicit PageHost(const RepoContext &context, const Project &project);
     ~PageHost();
 
+    // Builds the pages and starts loading them
+    void activate();
+    bool isActivated() const
+    {
+        return m_changesPage != nullptr;
+    }
+
     void onActionPush();
     void onActionPull();
     void onActionFetch();
     void onActionClean();
     void onActionTerm();
     void onActionFolder();
+    void onActionStatusCache();
 
     void onRefClicked(const QModelIndex &index);
     void onChangeMode();
     void refresh(const HistorySelectionArg &arg = HistorySelectionArg());
+    // Selects the commit in the history, loading pages until it is found
+    void showCommit(const QString &hash);
+
+signals:
+    // After activation, once the status and the first history page are in or took too long
+    void warmedUp();
+
+protected:
+    void showEvent(QShowEvent *event) override;
 
 private:
     Ui::PageHost *ui;
 
-    ChangesPage *m_changesPage;
-    HistoryPage *m_historyPage;
+    ChangesPage *m_changesPage = nullptr;
+    HistoryPage *m_historyPage = nullptr;
+    int m_pendingLoads = 0;
+    // Shared with the other tabs and windows showing the project
+    QSharedPointer<ProjectData> m_data;
+    bool m_refreshing = false;
 
     RepoContext m_context;
     Project m_project;
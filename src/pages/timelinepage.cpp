@@ -0,0 +1,226 @@
+#include "timelinepage.h"
+
+#include <QDateTime>
+#include <QtConcurrent>
+
+#include "global.h"
+#include "ui_timelinepage.h"
+
+TimelineModel::TimelineModel(QObject *parent) : QAbstractTableModel(parent)
+{
+}
+
+int TimelineModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_commitList.size();
+}
+
+int TimelineModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TimelineModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const TimelineCommit &commit = m_commitList.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case DateColumn:
+                    return QDateTime::fromSecsSinceEpoch(commit.time).toString("yyyy-MM-dd hh:mm");
+                case ProjectColumn:
+                    return commit.project.path;
+                case HashColumn:
+                    return commit.hash.left(8);
+                case AuthorColumn:
+                    return commit.author + " <" + commit.authorEmail + ">";
+                case SubjectColumn:
+                    return commit.subject;
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (index.column() == HashColumn) {
+                return commit.hash;
+            }
+            if (index.column() == SubjectColumn) {
+                return commit.subject;
+            }
+            break;
+    }
+    return QVariant();
+}
+
+QVariant TimelineModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case DateColumn:
+            return "Date";
+        case ProjectColumn:
+            return "Project";
+        case HashColumn:
+            return "Commit";
+        case AuthorColumn:
+            return "Author";
+        case SubjectColumn:
+            return "Subject";
+    }
+    return QVariant();
+}
+
+void TimelineModel::fetchMore(const QModelIndex &parent)
+{
+    emit fetchMoreEvt();
+}
+
+bool TimelineModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_canFetchMoreFlag;
+}
+
+void TimelineModel::reset()
+{
+    beginResetModel();
+    m_commitList.clear();
+    m_canFetchMoreFlag = true;
+    endResetModel();
+}
+
+void TimelineModel::addCommits(const QList<TimelineCommit> &commits, bool hasMore)
+{
+    m_canFetchMoreFlag = hasMore;
+    if (commits.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_commitList.size(), m_commitList.size() + commits.size() - 1);
+    m_commitList.append(commits);
+    endInsertRows();
+}
+
+const TimelineCommit &TimelineModel::commit(int row) const
+{
+    return m_commitList.at(row);
+}
+
+TimelinePage::TimelinePage(const RepoContext &context)
+    : QWidget(nullptr), ui(new Ui::TimelinePage), m_context(context)
+{
+    ui->setupUi(this);
+    // A page at a time, the timeline itself runs the projects in parallel
+    m_pool.setMaxThreadCount(1);
+
+    m_model = new TimelineModel(this);
+    ui->tableView->setModel(m_model);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(
+        TimelineModel::SubjectColumn, QHeaderView::Stretch);
+    ui->tableView->setColumnWidth(TimelineModel::DateColumn, 130);
+    ui->tableView->setColumnWidth(TimelineModel::ProjectColumn, 240);
+    ui->tableView->setColumnWidth(TimelineModel::HashColumn, 80);
+    ui->tableView->setColumnWidth(TimelineModel::AuthorColumn, 240);
+    connect(ui->tableView, &QTableView::doubleClicked, this, [this](const QModelIndex &index) {
+        const TimelineCommit &commit = m_model->commit(index.row());
+        emit commitDoubleClicked(commit.project, commit.hash);
+    });
+    connect(m_model, &TimelineModel::fetchMoreEvt, this, &TimelinePage::fetchMore);
+
+    connect(context.state(), &RepoState::manifestChanged, this, [this]() {
+        if (!m_timeline.isNull()) {
+            applyFilter();
+        }
+    });
+    connect(ui->applyBtn, &QPushButton::clicked, this, &TimelinePage::applyFilter);
+    for (QLineEdit *edit : {ui->projectEdit, ui->authorEdit, ui->sinceEdit, ui->untilEdit}) {
+        connect(edit, &QLineEdit::returnPressed, this, &TimelinePage::applyFilter);
+    }
+}
+
+TimelinePage::~TimelinePage()
+{
+    // The worker owns a reference to the timeline, it is dropped when the page in flight is done
+    m_fetchWorker.cancel();
+    delete ui;
+}
+
+void TimelinePage::showEvent(QShowEvent *event)
+{
+    if (m_timeline.isNull()) {
+        applyFilter();
+    }
+}
+
+void TimelinePage::applyFilter()
+{
+    // Any of the space separated parts of the path
+    const QStringList patterns = ui->projectEdit->text().split(' ', Qt::SkipEmptyParts);
+    QList<Project> projects;
+    const ManifestPtr manifest = m_context.manifest();
+    for (const Project &project : manifest->projectList) {
+        bool match = patterns.isEmpty();
+        for (const QString &pattern : patterns) {
+            match = match || project.path.contains(pattern, Qt::CaseInsensitive);
+        }
+        if (match) {
+            projects.append(project);
+        }
+    }
+
+    TimelineFilter filter;
+    filter.author = ui->authorEdit->text().trimmed();
+    filter.since = ui->sinceEdit->text().trimmed();
+    filter.until = ui->untilEdit->text().trimmed();
+
+    m_fetchWorker.cancel();
+    m_timeline.reset(new CommitTimeline(projects, filter));
+    m_model->reset();
+    fetchMore();
+}
+
+void TimelinePage::fetchMore()
+{
+    // A canceled page belongs to a dropped timeline, the pool runs this one after it
+    if ((m_fetchWorker.isRunning() && !m_fetchWorker.isCanceled()) || m_timeline.isNull()) {
+        return;
+    }
+    QSharedPointer<CommitTimeline> timeline = m_timeline;
+    m_fetchWorker =
+        QtConcurrent::run(&m_pool, [timeline](QPromise<QList<TimelineCommit>> &promise) {
+            const QList<TimelineCommit> commits =
+                timeline->take(global::commitPageSize, [&promise]() {
+                    return promise.isCanceled();
+                });
+            if (promise.isCanceled()) {
+                return;
+            }
+            promise.addResult(commits);
+        });
+    QPointer thisPtr(this);
+    m_fetchWorker
+        .then(qApp,
+            [thisPtr, timeline](const QList<TimelineCommit> &commits) {
+                if (thisPtr.isNull() || thisPtr->m_timeline != timeline) return;
+                thisPtr->m_model->addCommits(commits, !timeline->atEnd());
+                thisPtr->updateSummary();
+            })
+        .onCanceled(qApp, [thisPtr] {
+            if (thisPtr.isNull()) return;
+            thisPtr->updateSummary();
+        });
+    updateSummary();
+}
+
+void TimelinePage::updateSummary()
+{
+    QString text = QString("%1 commits from %2 projects")
+                       .arg(m_model->rowCount())
+                       .arg(m_timeline.isNull() ? 0 : m_timeline->projectCount());
+    if (m_fetchWorker.isRunning()) {
+        text += "  |  Loading...";
+    }
+    ui->summaryLabel->setText(text);
+}
@@ -0,0 +1,81 @@
+#ifndef TIMELINEPAGE_H
+#define TIMELINEPAGE_H
+
+#include <QAbstractTableModel>
+#include <QFuture>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWidget>
+
+#include "git/committimeline.h"
+#include "repocontext.h"
+
+namespace Ui {
+    class TimelinePage;
+}
+
+class TimelineModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        DateColumn,
+        ProjectColumn,
+        HashColumn,
+        AuthorColumn,
+        SubjectColumn,
+        ColumnCount,
+    };
+
+    explicit TimelineModel(QObject *parent = nullptr);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+
+    // canFetchMore is true until addCommits says there is no more
+    void reset();
+    void addCommits(const QList<TimelineCommit> &commits, bool hasMore);
+    const TimelineCommit &commit(int row) const;
+
+signals:
+    void fetchMoreEvt();
+
+private:
+    QList<TimelineCommit> m_commitList;
+    bool m_canFetchMoreFlag = false;
+};
+
+// History of many projects in one list, newest first
+class TimelinePage : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimelinePage(const RepoContext &context);
+    ~TimelinePage();
+
+signals:
+    void commitDoubleClicked(const Project &project, const QString &hash);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    Ui::TimelinePage *ui;
+    RepoContext m_context;
+    TimelineModel *m_model;
+    QSharedPointer<CommitTimeline> m_timeline;
+    QThreadPool m_pool;
+    QFuture<QList<TimelineCommit>> m_fetchWorker;
+
+    void applyFilter();
+    void fetchMore();
+    void updateSummary();
+};
+
+#endif  // TIMELINEPAGE_H
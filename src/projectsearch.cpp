@@ -0,0 +1,167 @@
+#include "projectsearch.h"
+
+#include <algorithm>
+#include <climits>
+
+// Scores in the spirit of fzf's, per matched character
+static const int scoreMatch = 16;
+static const int bonusSegmentStart = 10;  // After '/' or at the start
+static const int bonusWordStart = 7;      // After '-', '_' or '.'
+static const int bonusConsecutive = 4;
+static const int bonusLastSegment = 2;  // The directory name usually is what one types
+static const int penaltyGapStart = 3;
+static const int penaltyGapExtension = 1;
+static const int penaltyName = 8;  // Paths are what the list shows
+
+static int charBit(QChar c)
+{
+    const char16_t u = c.unicode();
+    if (u >= 'a' && u <= 'z') return u - 'a';
+    if (u >= '0' && u <= '9') return 26 + (u - '0');
+    switch (u) {
+        case '/':
+            return 36;
+        case '-':
+            return 37;
+        case '_':
+            return 38;
+        case '.':
+            return 39;
+    }
+    return 40 + u % 24;
+}
+
+static quint64 charMask(QStringView text)
+{
+    quint64 mask = 0;
+    for (QChar c : text) {
+        mask |= quint64(1) << charBit(c);
+    }
+    return mask;
+}
+
+static bool isWordSeparator(QChar c)
+{
+    return c == u'-' || c == u'_' || c == u'.';
+}
+
+ProjectSearch::ProjectSearch(const ManifestPtr &manifest) : m_manifest(manifest)
+{
+    m_entries.reserve(manifest->projectList.size());
+    for (const Project &project : manifest->projectList) {
+        Entry entry{project.path.toLower(), project.name.toLower(), 0};
+        entry.chars = charMask(entry.path) | charMask(entry.name);
+        m_entries.push_back(std::move(entry));
+    }
+}
+
+int ProjectSearch::score(QStringView text, QStringView query)
+{
+    if (query.isEmpty()) {
+        return 0;
+    }
+    // The earliest end of a match, then the latest start before it, for the tightest window
+    qsizetype q = 0;
+    qsizetype end = -1;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text[i] == query[q] && ++q == query.size()) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0) {
+        return -1;
+    }
+    qsizetype start = end;
+    q = query.size() - 1;
+    for (qsizetype i = end; i >= 0; --i) {
+        if (text[i] == query[q]) {
+            if (q == 0) {
+                start = i;
+                break;
+            }
+            --q;
+        }
+    }
+
+    const qsizetype lastSegment = text.lastIndexOf(u'/') + 1;
+    int score = 0;
+    int run = 0;
+    bool inGap = false;
+    q = 0;
+    for (qsizetype i = start; i <= end && q < query.size(); ++i) {
+        if (text[i] != query[q]) {
+            score -= inGap ? penaltyGapExtension : penaltyGapStart;
+            inGap = true;
+            run = 0;
+            continue;
+        }
+        score += scoreMatch;
+        if (i == 0 || text[i - 1] == u'/') {
+            score += bonusSegmentStart;
+        } else if (isWordSeparator(text[i - 1])) {
+            score += bonusWordStart;
+        }
+        if (i >= lastSegment) {
+            score += bonusLastSegment;
+        }
+        if (++run > 1) {
+            score += bonusConsecutive;
+        }
+        inGap = false;
+        ++q;
+    }
+    return score;
+}
+
+const QList<ProjectSearch::Result> &ProjectSearch::search(const QString &text, bool narrow)
+{
+    QString query = text.toLower();
+    query.remove(u' ');
+    if (m_searched && narrow && query == m_query) {
+        return m_results;
+    }
+
+    QList<Result> results;
+    if (query.isEmpty()) {
+        results.reserve(m_entries.size());
+        for (int i = 0; i < int(m_entries.size()); ++i) {
+            results.append({i, 0});
+        }
+    } else {
+        const quint64 mask = charMask(query);
+        auto match = [&](int i) {
+            const Entry &entry = m_entries[i];
+            if ((entry.chars & mask) != mask) {
+                return;
+            }
+            const int pathScore = score(entry.path, query);
+            const int nameScore = score(entry.name, query);
+            if (pathScore < 0 && nameScore < 0) {
+                return;
+            }
+            results.append({i, qMax(pathScore, nameScore < 0 ? INT_MIN : nameScore - penaltyName)});
+        };
+        // Whatever matches the longer query matched the shorter one
+        if (narrow && m_searched && !m_query.isEmpty() && query.startsWith(m_query)) {
+            for (const Result &result : std::as_const(m_results)) {
+                match(result.project);
+            }
+        } else {
+            for (int i = 0; i < int(m_entries.size()); ++i) {
+                match(i);
+            }
+        }
+        std::sort(results.begin(), results.end(), [this](const Result &r1, const Result &r2) {
+            if (r1.score != r2.score) return r1.score > r2.score;
+            const qsizetype length1 = m_entries[r1.project].path.size();
+            const qsizetype length2 = m_entries[r2.project].path.size();
+            if (length1 != length2) return length1 < length2;
+            return r1.project < r2.project;
+        });
+    }
+    m_query = query;
+    m_results = results;
+    m_searched = true;
+    return m_results;
+}
@@ -0,0 +1,50 @@
+#ifndef PROJECTSEARCH_H
+#define PROJECTSEARCH_H
+
+#include <QList>
+#include <QString>
+#include <vector>
+
+#include "repocontext.h"
+
+// Fuzzy search over the project paths and names of a manifest, like fzf: the query has to be a
+// subsequence, matches at the start of path segments and runs of matches rank higher
+class ProjectSearch
+{
+public:
+    struct Result
+    {
+        int project;  // Into the manifest's projectList
+        int score;
+    };
+
+    explicit ProjectSearch(const ManifestPtr &manifest);
+
+    // Best first, every project in path order for an empty query. A query extending the last one
+    // only looks at the projects the last one matched, unless narrow is false.
+    const QList<Result> &search(const QString &query, bool narrow = true);
+
+    const ManifestPtr &manifest() const
+    {
+        return m_manifest;
+    }
+
+    // Below 0 when query, lowercase, is not a subsequence of text, lowercase
+    static int score(QStringView text, QStringView query);
+
+private:
+    struct Entry
+    {
+        QString path;  // Lowercase
+        QString name;
+        quint64 chars;  // Bit per character class in path and name, see charBit
+    };
+
+    ManifestPtr m_manifest;
+    std::vector<Entry> m_entries;
+    QString m_query;
+    QList<Result> m_results;
+    bool m_searched = false;
+};
+
+#endif  // PROJECTSEARCH_H
@@ -1,51 +1,149 @@
 #include "ptydisplay.h"
 
-PtyDisplay::PtyDisplay(QPlainTextEdit *widget, QObject *parent)
+#include <QDebug>
+
+#include "widgets/outputview.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Bytes the tokenizer has to see: control characters, DEL and the 8-bit CSI (U+009B, 0xC2
+    // 0x9B in UTF-8). A 0xC2 ending the data counts, the next block tells what it is.
+    inline bool isSpecial(const char *p, const char *end)
+    {
+        const uchar c = uchar(*p);
+        if (c < 0x20 || c == 0x7f) {
+            return true;
+        }
+        return c == 0xc2 && (p + 1 == end || uchar(p[1]) == 0x9b);
+    }
+
+    // First special byte in [p, end), or end
+    const char *findSpecial(const char *p, const char *end)
+    {
+#ifdef __SSE2__
+        const __m128i controlMax = _mm_set1_epi8(0x1f);
+        const __m128i del = _mm_set1_epi8(0x7f);
+        const __m128i c2 = _mm_set1_epi8(char(0xc2));
+        for (; end - p >= 16; p += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            // Unsigned b <= 0x1f, saturating subtraction leaves zero
+            const __m128i control =
+                _mm_cmpeq_epi8(_mm_subs_epu8(bytes, controlMax), _mm_setzero_si128());
+            const __m128i controlOrDel = _mm_or_si128(control, _mm_cmpeq_epi8(bytes, del));
+            const __m128i candidates = _mm_or_si128(controlOrDel, _mm_cmpeq_epi8(bytes, c2));
+            for (int mask = _mm_movemask_epi8(candidates); mask; mask &= mask - 1) {
+                const char *candidate = p + __builtin_ctz(mask);
+                if (isSpecial(candidate, end)) {
+                    return candidate;
+                }
+            }
+        }
+#endif
+        for (; p < end; ++p) {
+            if (isSpecial(p, end)) {
+                return p;
+            }
+        }
+        return end;
+    }
+
+    // Length of an incomplete UTF-8 sequence ending [begin, end), cut by the end of a block
+    int incompleteTail(const char *begin, const char *end)
+    {
+        for (int i = 1; i <= 3 && end - i >= begin; ++i) {
+            const uchar c = uchar(end[-i]);
+            if ((c & 0xc0) == 0x80) {
+                continue;  // Continuation byte
+            }
+            const int size = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+            return size > i ? i : 0;
+        }
+        return 0;
+    }
+
+    // Decodes the character at p into cc and returns its length, or 0 if it continues past end.
+    // Malformed sequences decode to U+FFFD, like QTextDecoder did.
+    int decodeUtf8(const char *p, const char *end, uint *cc)
+    {
+        const uchar lead = uchar(*p);
+        if (lead < 0x80) {
+            *cc = lead;
+            return 1;
+        }
+        int size;
+        uint c;
+        if (lead < 0xc2 || lead > 0xf4) {
+            *cc = QChar::ReplacementCharacter;
+            return 1;
+        } else if (lead >= 0xf0) {
+            size = 4;
+            c = lead & 0x07;
+        } else if (lead >= 0xe0) {
+            size = 3;
+            c = lead & 0x0f;
+        } else {
+            size = 2;
+            c = lead & 0x1f;
+        }
+        for (int i = 1; i < size; ++i) {
+            if (p + i >= end) {
+                return 0;
+            }
+            const uchar next = uchar(p[i]);
+            if ((next & 0xc0) != 0x80) {
+                *cc = QChar::ReplacementCharacter;
+                return i;
+            }
+            c = (c << 6) | (next & 0x3f);
+        }
+        static const uint minimum[] = {0, 0, 0x80, 0x800, 0x10000};
+        const bool valid = c >= minimum[size] && c <= 0x10ffff && !QChar::isSurrogate(c);
+        *cc = valid ? c : uint(QChar::ReplacementCharacter);
+        return size;
+    }
+}  // namespace
+
+PtyDisplay::PtyDisplay(OutputView *view, QObject *parent)
     : QObject { parent }
-    , textEdit(widget)
-    , prevToken(-1)
+    , outputView(view)
+    , column(0)
+    , lineChanged(false)
 {
-    timer = new QTimer(this);
-    timer->start(100);
-    connect(timer, &QTimer::timeout, this, &PtyDisplay::onTimer);
-    _codec = QTextCodec::codecForName("UTF-8");
-    _decoder = _codec->makeDecoder();
     initTokenizer();
     resetTokenizer();
 }
 
-void PtyDisplay::flushContent()
-{
-    onTimer();
-}
-
 void PtyDisplay::onReceiveBlock(const char *buf, int len)
 {
-    /* XXX: the following code involves encoding & decoding of "UTF-16
-     *
-     * surrogate pairs", which does not work with characters higher than
-     * U+10FFFF
-     * https://unicodebook.readthedocs.io/unicode_encodings.html#surrogates
-     */
-    QString utf16Text = _decoder->toUnicode(buf, len);
-    std::wstring unicodeText = utf16Text.toStdWString();
-
-//    qDebug() << utf16Text;
-    // send characters to terminal emulator
-    for (size_t i = 0; i < unicodeText.length(); i++) {
-        //        qDebug() << unicodeText[i] << QString::fromWCharArray(&unicodeText[i], 1);
-        receiveChar(unicodeText[i]);
+    if (partialChar.isEmpty()) {
+        receiveBytes(buf, len);
+    } else {
+        // Finish the character the last block ended in
+        const QByteArray data = partialChar + QByteArray::fromRawData(buf, len);
+        partialChar.clear();
+        receiveBytes(data.constData(), data.size());
+    }
+    // The view paints at most once a frame, however many blocks come in between
+    if (!lines.isEmpty()) {
+        // The first of them finishes what the view shows as the last line
+        outputView->setLastLine(QString());
+        outputView->appendText(lines);
+        lines.clear();
+    }
+    if (lineChanged) {
+        outputView->setLastLine(line);
+        lineChanged = false;
     }
 }
 
-void PtyDisplay::onTimer()
+void PtyDisplay::endLine()
 {
-    if (!line.isEmpty()) {
-        textEdit->moveCursor(QTextCursor::End);
-        textEdit->insertPlainText(line);
-        textEdit->moveCursor(QTextCursor::End);
-        line.clear();
-    }
+    line.clear();
+    column = 0;
+    lineChanged = false;
 }
 
 #define COLOR_SPACE_UNDEFINED 0
@@ -73,6 +171,89 @@ void PtyDisplay::onTimer()
 
 #define MAX_ARGUMENT 4096
 
+// Decoding ---------------------------------------------------------------- --
+
+/* Between escape sequences, output is mostly printable text. Its runs go to the
+   line whole, found with a vectorized search for the next byte that isn't part
+   of them. Everything else, and all of an escape sequence, goes through
+   receiveChar a character at a time.
+*/
+
+void PtyDisplay::receiveBytes(const char *data, int len)
+{
+    const char *p = data;
+    const char *end = data + len;
+    while (p < end) {
+        if (tokenBufferPos == 0) {
+            const char *stop = findSpecial(p, end);
+            if (stop == end) {
+                stop -= incompleteTail(p, end);
+            }
+            if (stop > p) {
+                receiveText(p, stop - p);
+                p = stop;
+                continue;
+            }
+        }
+        uint cc;
+        const int size = decodeUtf8(p, end, &cc);
+        if (size == 0) {
+            partialChar = QByteArray(p, end - p);
+            return;
+        }
+        receiveChar(wchar_t(cc));
+        p += size;
+    }
+}
+
+// What receiveChar does for each character of a printable run
+void PtyDisplay::receiveText(const char *data, int len)
+{
+    writeText(QString::fromUtf8(data, len));
+}
+
+// Line screen -------------------------------------------------------------- --
+
+// The pty is this wide, see CmdDialog
+#define MAX_COLUMN 65535
+
+// Overwrites what is under the cursor, the common case of writing at the end appends
+void PtyDisplay::writeText(QStringView text)
+{
+    if (column > line.size())
+        line.append(QString(column - line.size(), ' '));
+    if (column == line.size())
+        line.append(text);
+    else
+        line.replace(column, qMin(text.size(), line.size() - column), text.data(), text.size());
+    column += int(text.size());
+    lineChanged = true;
+}
+
+void PtyDisplay::newLine()
+{
+    lines.append(line);
+    lines.append('\n');
+    line.clear();
+    column = 0;
+    lineChanged = true;
+}
+
+// CSI K: 0 erases from the cursor to the end, 1 from the start to the cursor, 2 everything.
+// Blanks are only kept before text, writing after the end pads up to the cursor.
+void PtyDisplay::eraseInLine(int mode)
+{
+    if (mode == 1 && column + 1 < line.size()) {
+        for (int i = 0; i <= column; ++i)
+            line[i] = ' ';
+    } else if (mode == 1 || mode == 2) {
+        line.clear();
+    } else if (column < line.size()) {
+        line.truncate(column);
+    }
+    lineChanged = true;
+}
+
 // Tokenizer --------------------------------------------------------------- --
 
 /* The tokenizer's state
@@ -275,25 +456,21 @@ void PtyDisplay::receiveChar(wchar_t cc)
 
 void PtyDisplay::processToken(int token, wchar_t p, int q)
 {
-    // Handle \r\n
-    bool skipNewLine = false;
-    if (prevToken == TY_CTL('M') && token == TY_CTL('J')) {
-        skipNewLine = true;
-    }
-    prevToken = token;
-
     switch (token)
     {
         case TY_CHR(         ) :
-            line.append(QChar(p));
-            break; //UTF16
+            if (QChar::requiresSurrogates(p)) {
+                const QChar pair[] = {QChar::highSurrogate(p), QChar::lowSurrogate(p)};
+                writeText(QStringView(pair, 2));
+            } else {
+                const QChar c(p);
+                writeText(QStringView(&c, 1));
+            }
+            break;
         case TY_CTL('J'      ) : //\n
         case TY_CTL('K'      ) :
-        case TY_CTL('L'      ) :
-        case TY_CTL('M'      ) : //\r
-            if (skipNewLine) break;
-            line.append("\n");
-            break;
+        case TY_CTL('L'      ) : newLine();                             break;
+        case TY_CTL('M'      ) : column = 0;                            break; //\r
         case TY_CTL('@'      ) : /* NUL: ignored                      */ break;
         case TY_CTL('A'      ) : /* SOH: ignored                      */ break;
         case TY_CTL('B'      ) : /* STX: ignored                      */ break;
@@ -302,8 +479,8 @@ void PtyDisplay::processToken(int token, wchar_t p, int q)
         case TY_CTL('E'      ) :      /*reportAnswerBack     (          )*/; break; //VT100
         case TY_CTL('F'      ) : /* ACK: ignored                      */ break;
         case TY_CTL('G'      ) : /*emit stateSet(NOTIFYBELL);*/         break; //VT100
-        case TY_CTL('H'      ) : /*_currentScreen->backspace            (          );*/ break; //VT100
-        case TY_CTL('I'      ) : line.append("\t");                     break; //VT100
+        case TY_CTL('H'      ) : column = qMax(0, column - 1);          break; //VT100
+        case TY_CTL('I'      ) : column = qMin((column / 8 + 1) * 8, MAX_COLUMN); break; //VT100
 
         case TY_CTL('P'      ) : /* DLE: ignored                      */ break;
         case TY_CTL('Q'      ) : /* DC1: XON continue                 */ break; //VT100
@@ -354,9 +531,12 @@ void PtyDisplay::processToken(int token, wchar_t p, int q)
         case TY_CSI_PR('s', 2004) :         break; //XTERM
         case TY_CSI_PR('r', 2004) :         break; //XTERM
 
-        case TY_CSI_PS('K',   0) :  break;
-        case TY_CSI_PS('K',   1) :  break;
-        case TY_CSI_PS('K',   2) :  break;
+        case TY_CSI_PS('K',   0) : eraseInLine(0); break;
+        case TY_CSI_PS('K',   1) : eraseInLine(1); break;
+        case TY_CSI_PS('K',   2) : eraseInLine(2); break;
+        case TY_CSI_PN('C'      ) : column = qMin(column + qMax(1, int(p)), MAX_COLUMN); break;
+        case TY_CSI_PN('D'      ) : column = qMax(0, column - qMax(1, int(p)));          break;
+        case TY_CSI_PN('G'      ) : column = qMin(qMax(1, int(p)), MAX_COLUMN) - 1;       break;
         case TY_CSI_PS('J',   0) :  break;
         case TY_CSI_PS('J',   1) :  break;
         case TY_CSI_PS('J',   2) :  break;
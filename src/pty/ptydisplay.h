@@ -1,27 +1,38 @@
 #ifndef PTYDISPLAY_H
 #define PTYDISPLAY_H
 
+#include <QByteArray>
 #include <QObject>
-#include <QPlainTextEdit>
-#include <QTextCodec>
-#include <QTimer>
+#include <QString>
+
+class OutputView;
 
 class PtyDisplay : public QObject
 {
     Q_OBJECT
 public:
-    explicit PtyDisplay(QPlainTextEdit *widget, QObject *parent = nullptr);
-    void flushContent();
+    explicit PtyDisplay(OutputView *view, QObject *parent = nullptr);
+
+    // Leaves the line the cursor is on as it is, the next output starts below what the view
+    // shows then
+    void endLine();
 
 private:
-    QPlainTextEdit *textEdit;
-    QTimer *timer;
+    OutputView *outputView;
 
-    const QTextCodec *_codec;
-    QTextDecoder *_decoder;
+    // A screen one line high: the line the cursor is on is rewritten in place by \r, backspace,
+    // cursor movement and CSI K. Finished lines go to the view as they are.
+    QString lines; // Finished, not yet in the view
     QString line;
-    int prevToken;
+    int column;
+    bool lineChanged;
+    QByteArray partialChar; // UTF-8 sequence split across blocks
 
+    void receiveBytes(const char *data, int len);
+    void receiveText(const char *data, int len);
+    void writeText(QStringView text);
+    void newLine();
+    void eraseInLine(int mode);
     void receiveChar(wchar_t cc);
     char eraseChar() const;
 
@@ -47,9 +58,6 @@ private:
     // for the purposes of decoding terminal output
     int charClass[256];
 
-private slots:
-    void onTimer();
-
 public slots:
     void onReceiveBlock(const char *buf, int len);
 };
@@ -1,68 +1,44 @@
 #include "repocontext.h"
 
 #include <QDir>
-#include <QDomDocument>
 
-RepoContext::RepoContext(const QString &repoPath) : m_repoPath(repoPath)
+RepoState::RepoState(const QString &repoPath)
+    : QObject(nullptr), m_repoPath(repoPath), m_manifest(new Manifest())
 {
-    loadManifest();
 }
 
-QSettings RepoContext::settings()
+ManifestPtr RepoState::manifest() const
 {
-    const QString &confFile = QDir::cleanPath(m_repoPath + "/repoman.conf");
-    return QSettings(confFile, QSettings::NativeFormat);
+    QMutexLocker locker(&m_mutex);
+    return m_manifest;
 }
 
-bool RepoContext::isValid()
+void RepoState::setManifest(const ManifestPtr &manifest)
 {
-    return !m_manifest.filePath.isEmpty();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_manifest = manifest;
+    }
+    emit manifestChanged();
 }
 
-void RepoContext::loadManifest()
+RepoContext::RepoContext(const QString &repoPath) : m_state(new RepoState(repoPath))
 {
-    if (m_repoPath.isEmpty()) return;
-    QString manPath = QDir::cleanPath(m_repoPath + "/.repo/manifest.xml");
-    parseManifest(manPath);
 }
 
-void RepoContext::parseManifest(const QString &manPath)
+QSettings RepoContext::settings()
 {
-    QFile manFile(manPath);
-    QDomDocument doc("");
-    if (!manFile.open(QIODevice::ReadOnly)) return;
-    if (!doc.setContent(&manFile)) {
-        manFile.close();
-        return;
-    }
-    manFile.close();
+    const QString &confFile = QDir::cleanPath(repoPath() + "/repoman.conf");
+    return QSettings(confFile, QSettings::NativeFormat);
+}
 
-    m_manifest = {};
-    m_manifest.filePath = manPath;
+bool RepoContext::isValid()
+{
+    return !manifest()->filePath.isEmpty();
+}
 
-    QDomNode n = doc.documentElement().firstChild();
-    while (!n.isNull()) {
-        QDomElement e = n.toElement();
-        if (e.nodeName() == "include") {
-            QString manPath2 =
-                QDir::cleanPath(m_repoPath + "/.repo/manifests/" + e.attribute("name"));
-            parseManifest(manPath2);
-        } else if (e.nodeName() == "default") {
-            m_manifest.remote = e.attribute("remote");
-            m_manifest.revision = e.attribute("revision");
-            m_manifest.syncJ = e.attribute("sync-j").toInt();
-        } else if (e.nodeName() == "project") {
-            QString name = e.attribute("name");
-            QString path = e.attribute("path");
-            if (path.isEmpty()) path = name;
-            QString absPath = QDir::cleanPath(m_repoPath + "/" + path);
-            m_manifest.projectList.emplace_back(name, path, absPath);
-            m_manifest.projectMap.insert(path, Project(name, path, absPath));
-        }
-        n = n.nextSibling();
-    }
-    std::sort(m_manifest.projectList.begin(), m_manifest.projectList.end(),
-        [](const Project &p1, const Project &p2) {
-            return p1.path < p2.path;
-        });
+void RepoContext::setManifest(const Manifest &manifest)
+{
+    // The old snapshot lives on with whoever still holds it
+    m_state->setManifest(ManifestPtr(new Manifest(manifest)));
 }
@@ -1,7 +1,11 @@
 #ifndef REPOCONTEXT_H
 #define REPOCONTEXT_H
 
+#include <QHash>
+#include <QMutex>
+#include <QObject>
 #include <QSettings>
+#include <QSharedPointer>
 #include <QString>
 
 struct Project
@@ -17,39 +21,84 @@ struct Project
     QString name;
     QString path;
     QString absPath;
+    // With the defaults of the manifest and of the remote applied
+    QString remote;
+    QString revision;    // Branch, tag or commit
+    QString upstream;    // Where a pinned revision comes from, may be empty
+    QString destBranch;  // Where changes are uploaded to, empty for the revision
 };
 
 struct Manifest
 {
-    QString filePath;
+    QString filePath;  // Empty when the manifest couldn't be read
+    QString error;     // Set when it couldn't be read in full, e.g. a broken local manifest
     QString remote;
     QString revision;
-    int syncJ;
-    QList<Project> projectList;
-    QMap<QString, Project> projectMap;  // key:path
+    int syncJ = 0;
+    QList<Project> projectList;        // Sorted by path
+    QHash<QString, int> projectIndex;  // key:path, value:index into projectList
+
+    // Null if the manifest has no project at path
+    const Project *findProject(const QString &path) const
+    {
+        auto it = projectIndex.constFind(path);
+        return it == projectIndex.cend() ? nullptr : &projectList[*it];
+    }
+};
+
+using ManifestPtr = QSharedPointer<const Manifest>;
+
+// Shared by all copies of a RepoContext, so that they see a new manifest at once
+class RepoState : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RepoState(const QString &repoPath);
+
+    QString repoPath() const
+    {
+        return m_repoPath;
+    }
+    ManifestPtr manifest() const;
+    void setManifest(const ManifestPtr &manifest);
+
+signals:
+    // On the thread calling setManifest, the UI thread in practice
+    void manifestChanged();
+
+private:
+    const QString m_repoPath;
+    mutable QMutex m_mutex;
+    ManifestPtr m_manifest;
 };
 
+// Cheap to copy, every copy of a context refers to the same state
 class RepoContext
 {
 public:
-    RepoContext(const QString &repoPath);
+    explicit RepoContext(const QString &repoPath = "");
     QSettings settings();
     bool isValid();
-    void loadManifest();
     QString repoPath() const
     {
-        return m_repoPath;
+        return m_state->repoPath();
     }
-    const Manifest &manifest() const
+    // The current snapshot, never null. Keep the pointer rather than calling again where the
+    // manifest may change in between, e.g. in a model or a worker.
+    ManifestPtr manifest() const
     {
-        return m_manifest;
+        return m_state->manifest();
+    }
+    // Swaps the snapshot of every copy and notifies them
+    void setManifest(const Manifest &manifest);
+    const RepoState *state() const
+    {
+        return m_state.data();
     }
 
 private:
-    QString m_repoPath;
-    Manifest m_manifest;
-
-    void parseManifest(const QString &manPath);
+    QSharedPointer<RepoState> m_state;
 };
 
 #endif  // REPOCONTEXT_H
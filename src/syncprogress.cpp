@@ -0,0 +1,452 @@
+#include "syncprogress.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <limits>
+
+static const quint32 historyMagic = 0x524d5354;  // "RMST"
+static const quint32 historyVersion = 1;
+static const int maxRuns = 20;
+
+static QDataStream &operator<<(QDataStream &out, const SyncRun::Phase &phase)
+{
+    return out << phase.wall << phase.busy << qint32(phase.tasks) << qint32(phase.jobs);
+}
+
+static QDataStream &operator>>(QDataStream &in, SyncRun::Phase &phase)
+{
+    qint32 tasks = 0;
+    qint32 jobs = 0;
+    in >> phase.wall >> phase.busy >> tasks >> jobs;
+    phase.tasks = tasks;
+    phase.jobs = jobs;
+    return in;
+}
+
+QString SyncHistory::filePath(const QString &repoPath)
+{
+    return QDir::cleanPath(repoPath + "/repoman.synctimes");
+}
+
+bool SyncHistory::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 runCount = 0;
+    in >> magic >> version >> runCount;
+    if (magic != historyMagic || version != historyVersion) {
+        return false;
+    }
+    QList<SyncRun> runs;
+    for (quint32 i = 0; i < runCount && in.status() == QDataStream::Ok; ++i) {
+        SyncRun run;
+        in >> run.time >> run.network >> run.checkout;
+        runs.append(run);
+    }
+    quint32 projectCount = 0;
+    in >> projectCount;
+    QHash<QString, SyncProjectTiming> projects;
+    for (quint32 i = 0; i < projectCount && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        SyncProjectTiming timing;
+        in >> path >> timing.fetch >> timing.checkout >> timing.failed;
+        projects.insert(path, timing);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    m_runs = runs;
+    m_projects = projects;
+    return true;
+}
+
+bool SyncHistory::save(const QString &filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << historyMagic << historyVersion << quint32(m_runs.size());
+    for (const SyncRun &run : m_runs) {
+        out << run.time << run.network << run.checkout;
+    }
+    out << quint32(m_projects.size());
+    for (auto it = m_projects.cbegin(); it != m_projects.cend(); ++it) {
+        out << it.key() << it->fetch << it->checkout << it->failed;
+    }
+    return file.commit();
+}
+
+void SyncHistory::add(const SyncRun &run, const QHash<QString, SyncProjectTiming> &projects)
+{
+    m_runs.append(run);
+    if (m_runs.size() > maxRuns) {
+        m_runs.remove(0, m_runs.size() - maxRuns);
+    }
+    for (auto it = projects.cbegin(); it != projects.cend(); ++it) {
+        if (it->fetch >= 0 || it->checkout >= 0) {
+            m_projects.insert(it.key(), *it);
+        }
+    }
+}
+
+// The jobs that moved the most projects per second. While the best one is also the most tried
+// and kept every job busy, the next sync tries more.
+int SyncHistory::suggestJobs(SyncRun::Phase SyncRun::*phase, int maxJobs) const
+{
+    QMap<int, SyncRun::Phase> best;  // By jobs
+    for (const SyncRun &run : m_runs) {
+        const SyncRun::Phase &p = run.*phase;
+        // A handful of projects says little about the jobs
+        if (p.jobs <= 0 || p.wall <= 0 || p.tasks < 2 * p.jobs) {
+            continue;
+        }
+        auto it = best.find(p.jobs);
+        if (it == best.end() || p.throughput() > it->throughput()) {
+            best.insert(p.jobs, p);
+        }
+    }
+    if (best.isEmpty()) {
+        return 0;
+    }
+    auto bestIt = best.cbegin();
+    for (auto it = best.cbegin(); it != best.cend(); ++it) {
+        if (it->throughput() > bestIt->throughput()) {
+            bestIt = it;
+        }
+    }
+    const int jobs = bestIt.key();
+    const double utilization = bestIt->busy / (bestIt->wall * jobs);
+    if (jobs == best.lastKey() && utilization > 0.8) {
+        return qMin(maxJobs, jobs + qMax(1, jobs / 2));
+    }
+    return jobs;
+}
+
+int SyncHistory::suggestNetworkJobs() const
+{
+    return suggestJobs(&SyncRun::network, 64);
+}
+
+int SyncHistory::suggestCheckoutJobs() const
+{
+    // Disk and CPU bound, unlike fetching
+    return suggestJobs(&SyncRun::checkout, QThread::idealThreadCount() * 2);
+}
+
+QList<QPair<QString, double>> SyncHistory::slowest(int count) const
+{
+    QList<QPair<QString, double>> projects;
+    projects.reserve(m_projects.size());
+    for (auto it = m_projects.cbegin(); it != m_projects.cend(); ++it) {
+        projects.append({it.key(), qMax(it->fetch, 0.0) + qMax(it->checkout, 0.0)});
+    }
+    const int n = qMin(count, int(projects.size()));
+    std::partial_sort(projects.begin(), projects.begin() + n, projects.end(),
+        [](const QPair<QString, double> &p1, const QPair<QString, double> &p2) {
+            return p1.second > p2.second;
+        });
+    projects.resize(n);
+    return projects;
+}
+
+SyncProgressModel::SyncProgressModel(QObject *parent, const ManifestPtr &manifest)
+    : QAbstractTableModel(parent), m_manifest(manifest)
+{
+    m_clock.start();
+    m_ticker.setInterval(1000);
+    connect(&m_ticker, &QTimer::timeout, this, [this]() {
+        if (!m_rows.isEmpty()) {
+            emit dataChanged(
+                index(0, FetchColumn), index(m_rows.size() - 1, CheckoutColumn), {Qt::DisplayRole});
+        }
+    });
+}
+
+int SyncProgressModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int SyncProgressModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QString SyncProgressModel::formatSeconds(double seconds)
+{
+    if (seconds < 60) {
+        return QString::number(seconds, 'f', 1) + " s";
+    }
+    const int total = qRound(seconds);
+    return QString("%1:%2").arg(total / 60).arg(total % 60, 2, 10, QChar('0'));
+}
+
+QVariant SyncProgressModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Row &row = m_rows.at(index.row());
+    const bool fetchColumn = index.column() == FetchColumn;
+    const double seconds = fetchColumn ? row.timing.fetch : row.timing.checkout;
+    const Phase columnPhase = fetchColumn ? NetworkPhase : CheckoutPhase;
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case PathColumn:
+                    return row.path;
+                case FetchColumn:
+                case CheckoutColumn:
+                    if (seconds >= 0) {
+                        return formatSeconds(seconds);
+                    }
+                    if (row.running == columnPhase) {
+                        return formatSeconds((m_clock.elapsed() - row.startedMs) / 1000.0) + "...";
+                    }
+                    return QVariant();
+                case StatusColumn:
+                    if (row.timing.failed) {
+                        return row.message.isEmpty() ? "Failed" : "Failed: " + row.message;
+                    }
+                    if (row.running == NetworkPhase) return "Fetching";
+                    if (row.running == CheckoutPhase) return "Checking out";
+                    return m_finished ? "Done" : QVariant();
+            }
+            break;
+        case Qt::ToolTipRole:
+            if (index.column() == StatusColumn && !row.message.isEmpty()) {
+                return row.message;
+            }
+            break;
+        case Qt::UserRole:
+            switch (index.column()) {
+                case PathColumn:
+                    return row.path;
+                case FetchColumn:
+                case CheckoutColumn:
+                    return seconds;
+                case StatusColumn:
+                    return row.timing.failed;
+            }
+            break;
+    }
+    return QVariant();
+}
+
+QVariant SyncProgressModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case PathColumn:
+            return "Project";
+        case FetchColumn:
+            return "Fetch";
+        case CheckoutColumn:
+            return "Checkout";
+        case StatusColumn:
+            return "Status";
+    }
+    return QVariant();
+}
+
+int SyncProgressModel::rowOf(const QString &path)
+{
+    auto it = m_rowIndex.constFind(path);
+    if (it != m_rowIndex.cend()) {
+        return *it;
+    }
+    const int row = m_rows.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.append({path});
+    m_rowIndex.insert(path, row);
+    endInsertRows();
+    return row;
+}
+
+void SyncProgressModel::feed(const char *buf, int len)
+{
+    // Progress lines are redrawn with a carriage return
+    m_line.append(buf, len);
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < m_line.size(); ++i) {
+        if (m_line[i] == '\r' || m_line[i] == '\n') {
+            if (i > start) {
+                parseLine(QString::fromUtf8(m_line.constData() + start, i - start));
+            }
+            start = i + 1;
+        }
+    }
+    m_line.remove(0, start);
+}
+
+void SyncProgressModel::setRunning(const QString &path, Phase phase)
+{
+    const int row = rowOf(path);
+    if (m_rows[row].running == phase) {
+        return;
+    }
+    m_rows[row].running = phase;
+    m_rows[row].startedMs = m_clock.elapsed();
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    if (!m_ticker.isActive()) {
+        m_ticker.start();
+    }
+}
+
+void SyncProgressModel::parseLine(const QString &rawLine)
+{
+    static const QRegularExpression escapeRegex("\x1b\\[[0-9;?]*[A-Za-z]");
+    // "Fetching:  45% (450/1000) 0:12 | 8 jobs | 0:03 platform/build @ build/make", older
+    // versions end after the counts
+    static const QRegularExpression progressRegex(
+        "^([A-Za-z][A-Za-z ]*):\\s+(\\d+)% \\((\\d+)/(\\d+)\\)(.*)$");
+    static const QRegularExpression activeRegex("\\S+ @ (\\S+)\\s*$");
+    static const QRegularExpression errorRegex(
+        "^error: (?:Cannot (?:fetch|checkout) )?(\\S+?)/?(?::|\\s|$)");
+
+    const QString line = QString(rawLine).remove(escapeRegex).trimmed();
+    const QRegularExpressionMatch progress = progressRegex.match(line);
+    if (progress.hasMatch()) {
+        const QString name = progress.captured(1);
+        const QString tail = progress.captured(5);
+        const Phase phase = name.startsWith("Syncing work tree") || name.startsWith("Checking out")
+                                ? CheckoutPhase
+                            : name.startsWith("Fetching") || name.startsWith("Syncing")
+                                ? NetworkPhase
+                                : NoPhase;
+        if (!m_phaseProgress.contains(name)) {
+            m_phaseNames.append(name);
+        }
+        const bool done = tail.contains("done");
+        m_phaseProgress.insert(name, QString("%1% (%2/%3)%4")
+                                         .arg(progress.captured(2), progress.captured(3),
+                                             progress.captured(4), done ? ", done" : ""));
+        emit phaseChanged();
+
+        const QRegularExpressionMatch active = activeRegex.match(tail);
+        if (phase != NoPhase && active.hasMatch()) {
+            setRunning(active.captured(1), phase);
+        }
+        if (phase != NoPhase && done) {
+            for (int row = 0; row < m_rows.size(); ++row) {
+                if (m_rows[row].running == phase) {
+                    m_rows[row].running = NoPhase;
+                    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+                }
+            }
+        }
+        return;
+    }
+
+    const QRegularExpressionMatch error = errorRegex.match(line);
+    if (error.hasMatch()) {
+        // Paths or names, depending on the message
+        QString path = error.captured(1);
+        if (!m_manifest->findProject(path)) {
+            path.clear();
+            for (const Project &project : m_manifest->projectList) {
+                if (project.name == error.captured(1)) {
+                    path = project.path;
+                    break;
+                }
+            }
+        }
+        if (!path.isEmpty()) {
+            const int row = rowOf(path);
+            m_rows[row].timing.failed = true;
+            m_rows[row].message = line.mid(7);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+        }
+    }
+}
+
+SyncRun SyncProgressModel::finish(const QString &eventLogPath, int networkJobs, int checkoutJobs)
+{
+    m_ticker.stop();
+    m_finished = true;
+    for (Row &row : m_rows) {
+        row.running = NoPhase;
+    }
+
+    SyncRun run;
+    run.time = QDateTime::currentSecsSinceEpoch();
+    run.network.jobs = networkJobs;
+    run.checkout.jobs = checkoutJobs;
+    double first[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    double last[2] = {0, 0};
+
+    // A JSON object per line, one for each try of each project and phase
+    QFile file(eventLogPath);
+    if (file.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : file.readAll().split('\n')) {
+            const QJsonObject event = QJsonDocument::fromJson(line).object();
+            const QString task = event.value("task_name").toString();
+            const Phase phase = task == "sync-network" ? NetworkPhase
+                                : task == "sync-local" ? CheckoutPhase
+                                                       : NoPhase;
+            const QString path = event.value("name").toString();
+            const double start = event.value("start_time").toDouble();
+            const double finish = event.value("finish_time").toDouble();
+            if (phase == NoPhase || path.isEmpty() || finish < start) {
+                continue;
+            }
+            Row &row = m_rows[rowOf(path)];
+            double &seconds = phase == NetworkPhase ? row.timing.fetch : row.timing.checkout;
+            seconds = qMax(seconds, 0.0) + (finish - start);
+            if (!event.value("success").toBool(true)) {
+                row.timing.failed = true;
+            }
+            SyncRun::Phase &runPhase = phase == NetworkPhase ? run.network : run.checkout;
+            runPhase.busy += finish - start;
+            ++runPhase.tasks;
+            first[phase] = qMin(first[phase], start);
+            last[phase] = qMax(last[phase], finish);
+        }
+    }
+    run.network.wall = run.network.tasks > 0 ? last[NetworkPhase] - first[NetworkPhase] : 0;
+    run.checkout.wall = run.checkout.tasks > 0 ? last[CheckoutPhase] - first[CheckoutPhase] : 0;
+
+    if (!m_rows.isEmpty()) {
+        emit dataChanged(index(0, 0), index(m_rows.size() - 1, ColumnCount - 1));
+    }
+    return run;
+}
+
+QHash<QString, SyncProjectTiming> SyncProgressModel::timings() const
+{
+    QHash<QString, SyncProjectTiming> timings;
+    timings.reserve(m_rows.size());
+    for (const Row &row : m_rows) {
+        timings.insert(row.path, row.timing);
+    }
+    return timings;
+}
+
+QString SyncProgressModel::phaseText() const
+{
+    QStringList parts;
+    for (const QString &name : m_phaseNames) {
+        parts << name + ": " + m_phaseProgress.value(name);
+    }
+    return parts.join("  |  ");
+}
@@ -0,0 +1,134 @@
+#ifndef SYNCPROGRESS_H
+#define SYNCPROGRESS_H
+
+#include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+
+#include "repocontext.h"
+
+// One `repo sync`, measured from repo's event log
+struct SyncRun
+{
+    struct Phase
+    {
+        double wall = 0;  // Seconds from the first task started to the last one finished
+        double busy = 0;  // Seconds of all tasks together
+        int tasks = 0;
+        int jobs = 0;
+
+        // Projects per second, what the jobs are tuned for
+        double throughput() const
+        {
+            return wall > 0 ? tasks / wall : 0;
+        }
+    };
+
+    qint64 time = 0;  // Seconds since epoch
+    Phase network;
+    Phase checkout;
+};
+
+struct SyncProjectTiming
+{
+    double fetch = -1;  // Seconds, -1 when the phase did not run
+    double checkout = -1;
+    bool failed = false;
+};
+
+// Timings of the last syncs of a repo, kept in a file next to .repo
+class SyncHistory
+{
+public:
+    bool load(const QString &filePath);
+    bool save(const QString &filePath) const;
+    void add(const SyncRun &run, const QHash<QString, SyncProjectTiming> &projects);
+
+    const QList<SyncRun> &runs() const
+    {
+        return m_runs;
+    }
+
+    // 0 when there is nothing measured to go on
+    int suggestNetworkJobs() const;
+    int suggestCheckoutJobs() const;
+    // By fetch and checkout time together, of the last sync each project was in
+    QList<QPair<QString, double>> slowest(int count) const;
+
+    static QString filePath(const QString &repoPath);
+
+private:
+    QList<SyncRun> m_runs;  // Oldest first
+    QHash<QString, SyncProjectTiming> m_projects;
+
+    int suggestJobs(SyncRun::Phase SyncRun::*phase, int maxJobs) const;
+};
+
+// Per project progress of a running `repo sync`, from its terminal output while it runs and from
+// its event log once it is done
+class SyncProgressModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        PathColumn,
+        FetchColumn,
+        CheckoutColumn,
+        StatusColumn,
+        ColumnCount,
+    };
+
+    explicit SyncProgressModel(QObject *parent, const ManifestPtr &manifest);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    void feed(const char *buf, int len);
+    // Replaces the live estimates with what repo measured
+    SyncRun finish(const QString &eventLogPath, int networkJobs, int checkoutJobs);
+    QHash<QString, SyncProjectTiming> timings() const;
+    // Progress of each phase, e.g. "Fetching: 45% (450/1000)"
+    QString phaseText() const;
+
+    static QString formatSeconds(double seconds);
+
+signals:
+    void phaseChanged();
+
+private:
+    enum Phase
+    {
+        NetworkPhase,
+        CheckoutPhase,
+        NoPhase,
+    };
+
+    struct Row
+    {
+        QString path;
+        Phase running = NoPhase;
+        qint64 startedMs = 0;  // Of the running phase, on m_clock
+        SyncProjectTiming timing;
+        QString message;
+    };
+
+    ManifestPtr m_manifest;
+    QList<Row> m_rows;
+    QHash<QString, int> m_rowIndex;  // By path
+    QByteArray m_line;
+    QStringList m_phaseNames;  // In the order they showed up
+    QHash<QString, QString> m_phaseProgress;
+    QElapsedTimer m_clock;
+    QTimer m_ticker;
+    bool m_finished = false;
+
+    int rowOf(const QString &path);
+    void parseLine(const QString &line);
+    void setRunning(const QString &path, Phase phase);
+};
+
+#endif  // SYNCPROGRESS_H
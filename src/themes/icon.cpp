@@ -126,6 +126,35 @@ namespace utils {
         return result;
     }
 
+    struct IconCache
+    {
+        QHash<QString, QIcon> icons;
+        QHash<QString, QPixmap> pixmaps;
+        int generation = 0;
+    };
+
+    // For the GUI thread, like QPixmap
+    static IconCache &iconCache()
+    {
+        static IconCache cache;
+        return cache;
+    }
+
+    // What an icon is rendered from, with the colors as the theme has them now
+    static QString cacheKey(
+        const QList<IconMaskAndColor> &sources, Icon::IconStyleOptions style, int dpr)
+    {
+        QString key = QString::number(int(style)) + ':' + QString::number(dpr);
+        if (style & Icon::DropShadow && creatorTheme()->flag(Theme::ToolBarIconShadow)) {
+            key += ":shadow";
+        }
+        for (const IconMaskAndColor &source : sources) {
+            key += '|' + source.first + '#' +
+                   QString::number(creatorTheme()->color(source.second).rgba(), 16);
+        }
+        return key;
+    }
+
     Icon::Icon() = default;
 
     Icon::Icon(const QList<IconMaskAndColor> &args, Icon::IconStyleOptions style)
@@ -144,19 +173,29 @@ namespace utils {
 
         if (m_style == None) return QIcon(m_iconSourceList.constFirst().first);
 
+        IconCache &cache = iconCache();
         const int maxDpr = qRound(qApp->devicePixelRatio());
-        if (maxDpr == m_lastDevicePixelRatio) return m_lastIcon;
-
-        m_lastDevicePixelRatio = maxDpr;
-        m_lastIcon = QIcon();
-        for (int dpr = 1; dpr <= maxDpr; dpr++) {
-            const MasksAndColors masks = masksAndColors(m_iconSourceList, dpr);
-            const QPixmap combinedMask = utils::combinedMask(masks, m_style);
-            m_lastIcon.addPixmap(masksToIcon(masks, combinedMask, m_style));
+        if (maxDpr == m_lastDevicePixelRatio && cache.generation == m_lastCacheGeneration) {
+            return m_lastIcon;
+        }
 
-            const QColor disabledColor = creatorTheme()->color(Theme::IconsDisabledColor);
-            m_lastIcon.addPixmap(maskToColorAndAlpha(combinedMask, disabledColor), QIcon::Disabled);
+        const QString key = cacheKey(m_iconSourceList, m_style, maxDpr);
+        auto it = cache.icons.constFind(key);
+        if (it == cache.icons.cend()) {
+            QIcon icon;
+            for (int dpr = 1; dpr <= maxDpr; dpr++) {
+                const MasksAndColors masks = masksAndColors(m_iconSourceList, dpr);
+                const QPixmap combinedMask = utils::combinedMask(masks, m_style);
+                icon.addPixmap(masksToIcon(masks, combinedMask, m_style));
+
+                const QColor disabledColor = creatorTheme()->color(Theme::IconsDisabledColor);
+                icon.addPixmap(maskToColorAndAlpha(combinedMask, disabledColor), QIcon::Disabled);
+            }
+            it = cache.icons.insert(key, icon);
         }
+        m_lastDevicePixelRatio = maxDpr;
+        m_lastCacheGeneration = cache.generation;
+        m_lastIcon = *it;
         return m_lastIcon;
     }
 
@@ -166,15 +205,23 @@ namespace utils {
             return QPixmap();
         } else if (m_style == None) {
             return QPixmap(m_iconSourceList.constFirst().first);
-        } else {
-            const MasksAndColors masks =
-                masksAndColors(m_iconSourceList, qRound(qApp->devicePixelRatio()));
+        }
+
+        IconCache &cache = iconCache();
+        const int dpr = qRound(qApp->devicePixelRatio());
+        const QString key = cacheKey(m_iconSourceList, m_style, dpr) +
+                            (iconMode == QIcon::Disabled ? ":disabled" : "");
+        auto it = cache.pixmaps.constFind(key);
+        if (it == cache.pixmaps.cend()) {
+            const MasksAndColors masks = masksAndColors(m_iconSourceList, dpr);
             const QPixmap combinedMask = utils::combinedMask(masks, m_style);
-            return iconMode == QIcon::Disabled
-                       ? maskToColorAndAlpha(
-                             combinedMask, creatorTheme()->color(Theme::IconsDisabledColor))
-                       : masksToIcon(masks, combinedMask, m_style);
+            it = cache.pixmaps.insert(key,
+                iconMode == QIcon::Disabled
+                    ? maskToColorAndAlpha(
+                          combinedMask, creatorTheme()->color(Theme::IconsDisabledColor))
+                    : masksToIcon(masks, combinedMask, m_style));
         }
+        return *it;
     }
 
     QString Icon::imageFilePath() const
@@ -202,6 +249,14 @@ namespace utils {
         return combinedIcon(qIcons);
     }
 
+    void Icon::clearCache()
+    {
+        IconCache &cache = iconCache();
+        cache.icons.clear();
+        cache.pixmaps.clear();
+        ++cache.generation;
+    }
+
     QIcon Icon::fromTheme(const QString &name)
     {
         static QHash<QString, QIcon> cache;
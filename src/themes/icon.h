@@ -55,10 +55,15 @@ namespace utils {
 
         static QIcon fromTheme(const QString &name);
 
+        // Icons and pixmaps are rendered once per process for the same masks, colors, style and
+        // device pixel ratio. Drops them, for when the theme changes the colors.
+        static void clearCache();
+
     private:
         QList<IconMaskAndColor> m_iconSourceList;
         IconStyleOptions m_style = None;
         mutable int m_lastDevicePixelRatio = -1;
+        mutable int m_lastCacheGeneration = -1;
         mutable QIcon m_lastIcon;
     };
 
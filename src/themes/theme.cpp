@@ -9,6 +9,7 @@
 #include <QPalette>
 #include <QSettings>
 
+#include "icon.h"
 #include "theme_p.h"
 
 namespace utils {
@@ -92,6 +93,8 @@ namespace utils {
 
         setMacAppearance(theme);
         setThemeApplicationPalette();
+        // Rendered with the colors of the old one
+        Icon::clearCache();
     }
 
     Theme::Theme(const QString &id, QObject *parent) : QObject(parent), d(new ThemePrivate)
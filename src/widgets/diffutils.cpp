@@ -2,113 +2,111 @@
 
 #include <QRegularExpression>
 
-QList<DiffHunk> parseDiffHunks(const QString &diffText)
+void DiffHunkBuilder::addLine(const QString &line)
 {
-    static QRegularExpression splitRE("\r?\n");
-    QStringList lines = diffText.trimmed().split(splitRE);
-
-    QList<DiffHunk> hunks;
-    std::optional<DiffHunk> hk;
+    if (line.startsWith("@@")) {
+        padSplitLines();
+        if (m_hunk) {
+            m_hunks.append(m_hunk.value());
+        }
+        m_hunk = DiffHunk();
+        QStringList nums = line.split(" ");
+        QStringList oldNums = nums[1].mid(1).split(",");
+        QStringList newNums = nums[2].mid(1).split(",");
+        m_hunk->oldStart = m_oldLN = oldNums[0].toInt();
+        m_hunk->oldTotal = oldNums.last().toInt();
+        m_hunk->newStart = m_newLN = newNums[0].toInt();
+        m_hunk->newTotal = newNums.last().toInt();
 
-    int n = 0;
-    while (n < lines.size() && !lines[n].startsWith("@@")) {
-        n++;
-    }
+        m_hunk->unifiedOldLNs.append(0);
+        m_hunk->unifiedNewLNs.append(0);
 
-    int oldLN = 0;
-    int newLN = 0;
-    int addCount = 0;
-    int deleteCount = 0;
-    for (int i = n; i < lines.size(); i++) {
-        QString line = lines[i];
-        if (line.startsWith("@@")) {
-            if (hk) {
-                hunks.append(hk.value());
-            }
-            hk = DiffHunk();
-            QStringList nums = line.split(" ");
-            QStringList oldNums = nums[1].mid(1).split(",");
-            QStringList newNums = nums[2].mid(1).split(",");
-            hk->oldStart = oldLN = oldNums[0].toInt();
-            hk->oldTotal = oldNums.last().toInt();
-            hk->newStart = newLN = newNums[0].toInt();
-            hk->newTotal = newNums.last().toInt();
+        m_hunk->splitOldLNs.append(0);
+        m_hunk->lines[SplitOld].append(line);
+        m_hunk->splitNewLNs.append(0);
+        m_hunk->lines[SplitNew].append(line);
+    } else if (!m_hunk) {
+        // Headers before the first hunk
+        return;
+    } else if (line.startsWith("+")) {
+        m_hunk->unifiedOldLNs.append(0);
+        m_hunk->unifiedNewLNs.append(m_newLN);
 
-            hk->unifiedOldLNs.append(0);
-            hk->unifiedNewLNs.append(0);
+        m_hunk->splitNewLNs.append(m_newLN++);
+        m_hunk->lines[SplitNew].append(line);
+        m_addCount++;
+    } else if (line.startsWith("-")) {
+        m_hunk->unifiedOldLNs.append(m_oldLN);
+        m_hunk->unifiedNewLNs.append(0);
 
-            hk->splitOldLNs.append(0);
-            hk->lines[SplitOld].append(line);
-            hk->splitNewLNs.append(0);
-            hk->lines[SplitNew].append(line);
-        } else if (line.startsWith("+")) {
-            hk->unifiedOldLNs.append(0);
-            hk->unifiedNewLNs.append(newLN);
+        m_hunk->splitOldLNs.append(m_oldLN++);
+        m_hunk->lines[SplitOld].append(line);
+        m_deleteCount++;
+    } else {
+        padSplitLines();
 
-            hk->splitNewLNs.append(newLN++);
-            hk->lines[SplitNew].append(line);
-            addCount++;
-        } else if (line.startsWith("-")) {
-            hk->unifiedOldLNs.append(oldLN);
-            hk->unifiedNewLNs.append(0);
-
-            hk->splitOldLNs.append(oldLN++);
-            hk->lines[SplitOld].append(line);
-            deleteCount++;
+        if (line.startsWith("\\")) {
+            m_hunk->unifiedOldLNs.append(0);
+            m_hunk->unifiedNewLNs.append(0);
+            m_hunk->splitOldLNs.append(0);
+            m_hunk->splitNewLNs.append(0);
         } else {
-            if (addCount || deleteCount) {
-                int delta = qAbs(addCount - deleteCount);
-                if (addCount > deleteCount) {
-                    for (int i = 0; i < delta; ++i) {
-                        hk->splitOldLNs.append(0);
-                        hk->lines[SplitOld].append("");
-                    }
-                } else {
-                    for (int i = 0; i < delta; ++i) {
-                        hk->splitNewLNs.append(0);
-                        hk->lines[SplitNew].append("");
-                    }
-                }
-                addCount = 0;
-                deleteCount = 0;
-            }
-
-            if (line.startsWith("\\")) {
-                hk->unifiedOldLNs.append(0);
-                hk->unifiedNewLNs.append(0);
-                hk->splitOldLNs.append(0);
-                hk->splitNewLNs.append(0);
-            } else {
-                hk->unifiedOldLNs.append(oldLN);
-                hk->unifiedNewLNs.append(newLN);
-                hk->splitOldLNs.append(oldLN++);
-                hk->splitNewLNs.append(newLN++);
-            }
-            hk->lines[SplitOld].append(line);
-            hk->lines[SplitNew].append(line);
+            m_hunk->unifiedOldLNs.append(m_oldLN);
+            m_hunk->unifiedNewLNs.append(m_newLN);
+            m_hunk->splitOldLNs.append(m_oldLN++);
+            m_hunk->splitNewLNs.append(m_newLN++);
         }
-        hk->lines[Unified].append(line);
+        m_hunk->lines[SplitOld].append(line);
+        m_hunk->lines[SplitNew].append(line);
     }
+    m_hunk->lines[Unified].append(line);
+}
 
+QList<DiffHunk> DiffHunkBuilder::hunks()
+{
     // When changes last to the end
-    if (addCount || deleteCount) {
-        if (addCount) {
-            for (int i = 0; i < addCount; ++i) {
-                hk->splitOldLNs.append(0);
-                hk->lines[SplitOld].append("");
+    padSplitLines();
+    if (m_hunk) {
+        m_hunks.append(m_hunk.value());
+        m_hunk.reset();
+    }
+    return m_hunks;
+}
+
+void DiffHunkBuilder::padSplitLines()
+{
+    // Keep both sides of the split view aligned after a block of changes
+    if (m_addCount || m_deleteCount) {
+        int delta = qAbs(m_addCount - m_deleteCount);
+        if (m_addCount > m_deleteCount) {
+            for (int i = 0; i < delta; ++i) {
+                m_hunk->splitOldLNs.append(0);
+                m_hunk->lines[SplitOld].append("");
             }
         } else {
-            for (int i = 0; i < deleteCount; ++i) {
-                hk->splitNewLNs.append(0);
-                hk->lines[SplitNew].append("");
+            for (int i = 0; i < delta; ++i) {
+                m_hunk->splitNewLNs.append(0);
+                m_hunk->lines[SplitNew].append("");
             }
         }
+        m_addCount = 0;
+        m_deleteCount = 0;
+    }
+}
+
+QList<DiffHunk> parseDiffHunks(const QString &diffText)
+{
+    static QRegularExpression splitRE("\r?\n");
+    QStringList lines = diffText.split(splitRE);
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
     }
 
-    if (hk) {
-        hunks.append(hk.value());
+    DiffHunkBuilder builder;
+    for (const QString &line : lines) {
+        builder.addLine(line);
     }
-    return hunks;
+    return builder.hunks();
 }
 
 void findTargetHunk(
@@ -2,6 +2,7 @@
 #define DIFFUTILS_H
 
 #include <QStringList>
+#include <optional>
 
 struct DiffHunk
 {
@@ -25,6 +26,24 @@ enum DiffMode
     SplitNew
 };
 
+// Builds hunks from unified diff lines, fed one by one without line breaks
+class DiffHunkBuilder
+{
+public:
+    void addLine(const QString &line);
+    QList<DiffHunk> hunks();
+
+private:
+    void padSplitLines();
+
+    QList<DiffHunk> m_hunks;
+    std::optional<DiffHunk> m_hunk;
+    int m_oldLN = 0;
+    int m_newLN = 0;
+    int m_addCount = 0;
+    int m_deleteCount = 0;
+};
+
 QList<DiffHunk> parseDiffHunks(const QString &diffText);
 
 void findTargetHunk(
@@ -0,0 +1,394 @@
+#include "outputview.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QDebug>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFontDatabase>
+#include <QMenu>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTemporaryFile>
+#include <QUrl>
+#include <algorithm>
+
+// About a frame at 60 Hz
+static const int frameInterval = 16;
+static const int tabWidth = 8;
+
+void OutputLines::setLimit(int lines)
+{
+    m_limit = qMax(lines, ChunkSize);
+}
+
+void OutputLines::append(const QString &line)
+{
+    if (m_size == m_chunkCount * ChunkSize) {
+        if (m_chunkCount == m_chunks.size()) {
+            // Grows until the limit is reached, after that dropped chunks are reused
+            std::rotate(m_chunks.begin(), m_chunks.begin() + m_first, m_chunks.end());
+            m_first = 0;
+            m_chunks.append(QStringList());
+            m_chunks.last().reserve(ChunkSize);
+        }
+        ++m_chunkCount;
+    }
+    m_chunks[(m_first + m_size / ChunkSize) % m_chunks.size()].append(line);
+    ++m_size;
+}
+
+void OutputLines::trim()
+{
+    while (overLimit()) {
+        m_chunks[m_first].clear();
+        m_first = (m_first + 1) % m_chunks.size();
+        --m_chunkCount;
+        m_size -= ChunkSize;
+        m_dropped += ChunkSize;
+    }
+}
+
+OutputView::OutputView(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    font.setPointSize(9);
+    setFont(font);
+    updateFontMetrics();
+    viewport()->setCursor(Qt::IBeamCursor);
+    viewport()->setBackgroundRole(QPalette::Base);
+    setFocusPolicy(Qt::StrongFocus);
+
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(frameInterval);
+    connect(&m_frameTimer, &QTimer::timeout, this, &OutputView::updateFrame);
+}
+
+OutputView::~OutputView()
+{
+    if (m_log && m_lines.size() > 0) {
+        m_log->write(m_lines.last().toUtf8());
+    }
+}
+
+void OutputView::setScrollback(int lines)
+{
+    m_lines.setLimit(lines);
+    trimLines();
+}
+
+void OutputView::appendText(const QString &text)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    if (m_lines.size() == 0) {
+        m_lines.append(QString());
+    }
+    for (qsizetype start = 0;;) {
+        const qsizetype newline = text.indexOf('\n', start);
+        const qsizetype end = newline < 0 ? text.size() : newline;
+        appendToLastLine(QStringView(text).sliced(start, end - start));
+        if (newline < 0) {
+            break;
+        }
+        if (m_log) {
+            m_log->write(m_lines.last().toUtf8() + '\n');
+        }
+        m_lines.append(QString());
+        start = newline + 1;
+    }
+    trimLines();
+}
+
+void OutputView::appendLine(const QString &text)
+{
+    if (m_lines.size() > 0 && !m_lines.last().isEmpty()) {
+        appendText("\n");
+    }
+    appendText(text + '\n');
+}
+
+void OutputView::setLastLine(const QString &text)
+{
+    if (m_lines.size() == 0) {
+        m_lines.append(QString());
+    }
+    m_lines.last().clear();
+    appendToLastLine(text);
+    trimLines();
+}
+
+void OutputView::appendToLastLine(QStringView text)
+{
+    QString &line = m_lines.last();
+    if (!text.contains('\t')) {
+        line += text;
+    } else {
+        for (const QChar c : text) {
+            if (c == '\t') {
+                line += QString(tabWidth - line.size() % tabWidth, ' ');
+            } else {
+                line += c;
+            }
+        }
+    }
+    m_maxColumns = qMax(m_maxColumns, int(line.size()));
+}
+
+void OutputView::trimLines()
+{
+    if (m_lines.overLimit()) {
+        if (!m_logTried) {
+            startLog();
+        }
+        m_lines.trim();
+    }
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void OutputView::startLog()
+{
+    // Everything so far is still in m_lines, from here on appendText writes lines as they finish
+    m_logTried = true;
+    auto log = new QTemporaryFile(QDir::tempPath() + "/repoman-XXXXXX.log", this);
+    log->setAutoRemove(false);
+    if (!log->open()) {
+        qWarning() << "OutputView: cannot create a log file:" << log->errorString();
+        delete log;
+        return;
+    }
+    for (int i = 0; i < m_lines.size() - 1; ++i) {
+        log->write(m_lines.at(i).toUtf8() + '\n');
+    }
+    m_log = log;
+    emit logStarted(m_log->fileName());
+}
+
+QString OutputView::logFilePath() const
+{
+    return m_log ? m_log->fileName() : QString();
+}
+
+void OutputView::updateFrame()
+{
+    updateScrollBars();
+    if (m_log) {
+        m_log->flush();
+    }
+    viewport()->update();
+}
+
+void OutputView::updateFontMetrics()
+{
+    const QFontMetrics metrics = fontMetrics();
+    m_charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
+    m_lineHeight = qMax(1, metrics.lineSpacing());
+    m_ascent = metrics.ascent();
+}
+
+void OutputView::updateScrollBars()
+{
+    // At the end, the view follows the output. Scrolled back, it stays on the same lines while
+    // older ones are dropped.
+    QScrollBar *bar = verticalScrollBar();
+    const bool following = bar->value() >= bar->maximum();
+    const int value = bar->value() - int(m_lines.dropped() - m_droppedShown);
+    m_droppedShown = m_lines.dropped();
+    const int rows = qMax(1, viewport()->height() / m_lineHeight);
+    bar->setRange(0, qMax(0, m_lines.size() - rows));
+    bar->setPageStep(rows);
+    bar->setValue(following ? bar->maximum() : qMax(0, value));
+
+    const int columns = qMax(1, viewport()->width() / m_charWidth);
+    horizontalScrollBar()->setRange(0, qMax(0, m_maxColumns + 1 - columns));
+    horizontalScrollBar()->setPageStep(columns);
+}
+
+void OutputView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    const int firstLine = verticalScrollBar()->value();
+    const int firstColumn = horizontalScrollBar()->value();
+    const int columns = viewport()->width() / m_charWidth + 2;
+    const QPalette &palette = this->palette();
+
+    const Position selectionStart = qMin(m_anchor, m_cursor);
+    const Position selectionEnd = qMax(m_anchor, m_cursor);
+    const bool selection = hasSelection();
+    painter.setPen(palette.color(QPalette::Text));
+
+    const int top = event->rect().top() / m_lineHeight;
+    const int bottom = event->rect().bottom() / m_lineHeight;
+    for (int row = top; row <= bottom && firstLine + row < m_lines.size(); ++row) {
+        const int index = firstLine + row;
+        const QString &line = m_lines.at(index);
+        const QString text = line.size() > firstColumn ? line.mid(firstColumn, columns) : QString();
+        const QPoint origin(0, row * m_lineHeight + m_ascent);
+        painter.drawText(origin, text);
+
+        const qint64 lineNumber = m_lines.dropped() + index;
+        if (!selection || lineNumber < selectionStart.line || lineNumber > selectionEnd.line) {
+            continue;
+        }
+        // Past the end of the line stands for its newline
+        const int from = lineNumber == selectionStart.line ? selectionStart.column : 0;
+        const int to =
+            lineNumber == selectionEnd.line ? selectionEnd.column : int(line.size()) + 1;
+        const QRect rect((from - firstColumn) * m_charWidth, row * m_lineHeight,
+            (to - from) * m_charWidth, m_lineHeight);
+        painter.fillRect(rect, palette.color(QPalette::Highlight));
+        painter.save();
+        painter.setClipRect(rect);
+        painter.setPen(palette.color(QPalette::HighlightedText));
+        painter.drawText(origin, text);
+        painter.restore();
+    }
+}
+
+void OutputView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void OutputView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+void OutputView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateFontMetrics();
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+OutputView::Position OutputView::positionAt(const QPoint &pos) const
+{
+    Position position;
+    if (m_lines.size() == 0) {
+        return position;
+    }
+    const int index = qBound(
+        0, verticalScrollBar()->value() + pos.y() / m_lineHeight, m_lines.size() - 1);
+    const int column = horizontalScrollBar()->value() + (pos.x() + m_charWidth / 2) / m_charWidth;
+    position.line = m_lines.dropped() + index;
+    position.column = qBound(0, column, int(m_lines.at(index).size()));
+    return position;
+}
+
+QString OutputView::selectedText() const
+{
+    if (!hasSelection()) {
+        return {};
+    }
+    const Position start = qMin(m_anchor, m_cursor);
+    const Position end = qMax(m_anchor, m_cursor);
+    QStringList lines;
+    // Dropped lines of the selection are gone
+    const qint64 first = qMax(start.line, m_lines.dropped());
+    for (qint64 line = first; line <= end.line && line - m_lines.dropped() < m_lines.size();
+         ++line) {
+        const QString &text = m_lines.at(int(line - m_lines.dropped()));
+        const int from = line == start.line ? start.column : 0;
+        const int to = line == end.line ? end.column : int(text.size());
+        lines << text.mid(from, to - from);
+    }
+    return lines.join('\n');
+}
+
+void OutputView::copy()
+{
+    if (hasSelection()) {
+        QApplication::clipboard()->setText(selectedText());
+    }
+}
+
+void OutputView::selectAll()
+{
+    if (m_lines.size() == 0) {
+        return;
+    }
+    m_anchor = {m_lines.dropped(), 0};
+    m_cursor = {m_lines.dropped() + m_lines.size() - 1, int(m_lines.last().size())};
+    viewport()->update();
+}
+
+void OutputView::keyPressEvent(QKeyEvent *event)
+{
+    if (event == QKeySequence::Copy) {
+        copy();
+    } else if (event == QKeySequence::SelectAll) {
+        selectAll();
+    } else {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void OutputView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        return;
+    }
+    m_cursor = positionAt(event->pos());
+    if (!(event->modifiers() & Qt::ShiftModifier)) {
+        m_anchor = m_cursor;
+    }
+    m_selecting = true;
+    viewport()->update();
+}
+
+void OutputView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_selecting) {
+        return;
+    }
+    // Dragging past the top or the bottom scrolls
+    QScrollBar *bar = verticalScrollBar();
+    if (event->pos().y() < 0) {
+        bar->setValue(bar->value() - 1);
+    } else if (event->pos().y() > viewport()->height()) {
+        bar->setValue(bar->value() + 1);
+    }
+    m_cursor = positionAt(event->pos());
+    viewport()->update();
+}
+
+void OutputView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !m_selecting) {
+        return;
+    }
+    m_selecting = false;
+    QClipboard *clipboard = QApplication::clipboard();
+    if (clipboard->supportsSelection() && hasSelection()) {
+        clipboard->setText(selectedText(), QClipboard::Selection);
+    }
+}
+
+void OutputView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *copyAction = menu.addAction("Copy", this, &OutputView::copy);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setEnabled(hasSelection());
+    QAction *selectAllAction = menu.addAction("Select All", this, &OutputView::selectAll);
+    selectAllAction->setShortcut(QKeySequence::SelectAll);
+    if (m_log) {
+        menu.addSeparator();
+        const QString path = m_log->fileName();
+        menu.addAction("Open Full Output", this, [path]() {
+            QDesktopServices::openUrl(QUrl::fromLocalFile(path));
+        });
+    }
+    menu.exec(event->globalPos());
+}
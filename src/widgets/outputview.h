@@ -0,0 +1,145 @@
+#ifndef OUTPUTVIEW_H
+#define OUTPUTVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <QTimer>
+
+// Lines kept in chunks of a fixed size, reused as a ring. Over the limit, the oldest chunk is
+// dropped as a whole, so appending never moves the lines kept.
+class OutputLines
+{
+public:
+    static constexpr int ChunkSize = 1024;
+
+    int limit() const
+    {
+        return m_limit;
+    }
+    void setLimit(int lines);
+
+    int size() const
+    {
+        return m_size;
+    }
+    // Lines dropped from the front so far, line i was line dropped() + i of the output
+    qint64 dropped() const
+    {
+        return m_dropped;
+    }
+    const QString &at(int i) const
+    {
+        return m_chunks.at((m_first + i / ChunkSize) % m_chunks.size()).at(i % ChunkSize);
+    }
+    QString &last()
+    {
+        const int i = m_size - 1;
+        return m_chunks[(m_first + i / ChunkSize) % m_chunks.size()][i % ChunkSize];
+    }
+
+    void append(const QString &line);
+    // Whether trim() would drop lines
+    bool overLimit() const
+    {
+        return m_size - ChunkSize >= m_limit;
+    }
+    void trim();
+
+private:
+    QList<QStringList> m_chunks;  // Ring, the oldest at m_first
+    int m_first = 0;
+    int m_chunkCount = 0;
+    int m_size = 0;
+    int m_limit = 10 * ChunkSize;
+    qint64 m_dropped = 0;
+};
+
+// Read-only view of command output. Only the lines in sight are painted, at most once a frame
+// however often text is appended. Lines past the scrollback are dropped; before the first ones
+// are, the finished lines start going to a log file.
+class OutputView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit OutputView(QWidget *parent = nullptr);
+    ~OutputView();
+
+    int scrollback() const
+    {
+        return m_lines.limit();
+    }
+    void setScrollback(int lines);
+
+    // Continues the last line, a '\n' in text starts a new one
+    void appendText(const QString &text);
+    // text on lines of its own
+    void appendLine(const QString &text);
+    // Replaces what the last line shows, e.g. a progress meter redrawn after \r. The last line
+    // is only logged once finished.
+    void setLastLine(const QString &text);
+
+    // Empty until the scrollback is full
+    QString logFilePath() const;
+
+    QString selectedText() const;
+    void copy();
+    void selectAll();
+
+signals:
+    void logStarted(const QString &path);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void changeEvent(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    struct Position
+    {
+        qint64 line = 0;  // Of the whole output, see OutputLines::dropped
+        int column = 0;
+
+        bool operator<(const Position &other) const
+        {
+            return line < other.line || (line == other.line && column < other.column);
+        }
+    };
+
+    OutputLines m_lines;
+    int m_maxColumns = 0;
+    qint64 m_droppedShown = 0;  // m_lines.dropped() the scroll bars were last updated for
+    QTimer m_frameTimer;
+    QFile *m_log = nullptr;
+    bool m_logTried = false;
+
+    int m_charWidth = 1;
+    int m_lineHeight = 1;
+    int m_ascent = 0;
+
+    Position m_anchor;
+    Position m_cursor;
+    bool m_selecting = false;
+
+    void appendToLastLine(QStringView text);
+    void trimLines();
+    void startLog();
+    void updateFrame();
+    void updateFontMetrics();
+    void updateScrollBars();
+    Position positionAt(const QPoint &pos) const;
+    bool hasSelection() const
+    {
+        return m_anchor.line != m_cursor.line || m_anchor.column != m_cursor.column;
+    }
+};
+
+#endif  // OUTPUTVIEW_H
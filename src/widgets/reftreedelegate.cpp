@@ -1,6 +1,8 @@
 #include "reftreedelegate.h"
 
+#include <QHelpEvent>
 #include <QPainter>
+#include <QToolTip>
 #include <QTreeView>
 
 #include "reftreemodel.h"
@@ -37,8 +39,22 @@ void RefTreeDelegate::paint(
     }
     QStyledItemDelegate::paint(painter, opt, index);
 
+    if (item->type == RefTreeItem::Branch) {
+        const QString text = divergenceText(item->data);
+        if (!text.isEmpty()) {
+            opt.font.setBold(false);
+            painter->save();
+            painter->setFont(opt.font);
+            painter->setPen(creatorTheme()->color(Theme::PaletteTextDisabled));
+            painter->drawText(
+                opt.rect.adjusted(0, 0, -8, 0), Qt::AlignVCenter | Qt::AlignRight, text);
+            painter->restore();
+        }
+    }
+
     if (item->type == RefTreeItem::Group) {
-        QIcon refreshIcon = Icon({{":/icons/refresh.png", Theme::IconsBaseColor}}).icon();
+        static const Icon loadingIcon({{":/icons/refresh.png", Theme::IconsBaseColor}});
+        QIcon refreshIcon = loadingIcon.icon();
         QRect iconRect = opt.rect.adjusted(0, 8, -5, -8);
         switch (item->row) {
             case RefTreeItem::Branch:
@@ -62,11 +78,74 @@ void RefTreeDelegate::paint(
     }
 }
 
+bool RefTreeDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view,
+    const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    RefTreeItem *item = static_cast<RefTreeItem *>(index.internalPointer());
+    if (!item || event->type() != QEvent::ToolTip || item->type != RefTreeItem::Branch) {
+        return QStyledItemDelegate::helpEvent(event, view, option, index);
+    }
+    auto it = m_divergences.constFind(item->data);
+    if (it == m_divergences.cend()) {
+        return QStyledItemDelegate::helpEvent(event, view, option, index);
+    }
+
+    auto describe = [](const ProjectData::Divergence &divergence, const QString &name) {
+        return divergence.isValid() ? QString("%1 ahead, %2 behind %3")
+                                          .arg(divergence.ahead)
+                                          .arg(divergence.behind)
+                                          .arg(name)
+                                    : QString("Not compared with %1 yet").arg(name);
+    };
+    QStringList lines = {item->data};
+    if (!it->upstream.isEmpty()) {
+        lines << describe(it->toUpstream, it->upstream);
+    }
+    if (!m_revision.isEmpty() && !it->atRevision) {
+        lines << describe(it->toRevision, m_revision + ", the manifest revision");
+    }
+    QToolTip::showText(event->globalPos(), lines.join('\n'), view);
+    return true;
+}
+
+QString RefTreeDelegate::divergenceText(const QString &branch) const
+{
+    auto it = m_divergences.constFind(branch);
+    if (it == m_divergences.cend()) {
+        return {};
+    }
+    auto counts = [](const ProjectData::Divergence &divergence) {
+        return QString("↑%1 ↓%2").arg(divergence.ahead).arg(divergence.behind);
+    };
+    // In sync is shown as nothing, the revision in brackets
+    QStringList parts;
+    if (it->toUpstream.isValid() && (it->toUpstream.ahead || it->toUpstream.behind)) {
+        parts << counts(it->toUpstream);
+    }
+    if (!it->atRevision && it->toRevision.isValid() &&
+        (it->toRevision.ahead || it->toRevision.behind)) {
+        parts << "(" + counts(it->toRevision) + ")";
+    }
+    return parts.join("  ");
+}
+
 void RefTreeDelegate::setCurrentBranch(const QString &branch)
 {
     m_currentBranch = branch;
 }
 
+void RefTreeDelegate::setRevision(const QString &revision)
+{
+    m_revision = revision;
+}
+
+void RefTreeDelegate::setDivergences(
+    const QHash<QString, ProjectData::BranchDivergence> &divergences)
+{
+    m_divergences = divergences;
+    m_treeView->viewport()->update();
+}
+
 void RefTreeDelegate::setBranchesLoading(bool loading)
 {
     if (loading) {
@@ -4,6 +4,8 @@
 #include <QStyledItemDelegate>
 #include <QTreeView>
 
+#include "git/projectdata.h"
+
 class RefTreeDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
@@ -12,15 +14,26 @@ public:
     void paint(QPainter *painter, const QStyleOptionViewItem &option,
         const QModelIndex &index) const override;
 
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+        const QModelIndex &index) override;
+
     void setCurrentBranch(const QString &branch);
+    // What the local branches are compared with besides their upstream
+    void setRevision(const QString &revision);
+    // key:local branch
+    void setDivergences(const QHash<QString, ProjectData::BranchDivergence> &divergences);
     void setBranchesLoading(bool loading);
     void setRemotesLoading(bool loading);
     void setTagsLoading(bool loading);
 
 private:
+    QString divergenceText(const QString &branch) const;
+
     QTreeView *m_treeView;
 
     QString m_currentBranch;
+    QString m_revision;
+    QHash<QString, ProjectData::BranchDivergence> m_divergences;
     int m_branchesLoading;
     int m_remotesLoading;
     int m_tagsLoading;
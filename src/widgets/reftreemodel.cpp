@@ -1,25 +1,64 @@
 #include "reftreemodel.h"
 
+#include <algorithm>
+
 #include <QBrush>
 #include <QFont>
 #include <QIcon>
+#include <QSet>
 
 #include "themes/icon.h"
 #include "themes/theme.h"
 
-RefTreeModel::RefTreeModel(QObject *parent)
-    : QAbstractItemModel(parent), m_rootItem(new RefTreeItem)
+namespace {
+    bool lessByName(const RefTreeItem *item, const QString &name)
+    {
+        return item->displayName < name;
+    }
+
+    void sortChildren(RefTreeItem *item)
+    {
+        std::sort(item->childrens.begin(), item->childrens.end(),
+            [](const RefTreeItem *i1, const RefTreeItem *i2) {
+                return i1->displayName < i2->displayName;
+            });
+        for (int i = 0; i < item->childrens.size(); ++i) {
+            item->childrens[i]->row = i;
+            sortChildren(item->childrens[i]);
+        }
+    }
+
+    void renumber(RefTreeItem *parent, int from)
+    {
+        for (int i = from; i < parent->childrens.size(); ++i) {
+            parent->childrens[i]->row = i;
+        }
+    }
+
+    QStringList filterNames(const QStringList &names, const QString &filter)
+    {
+        if (filter.isEmpty()) {
+            return names;
+        }
+        QStringList matches;
+        for (const QString &name : names) {
+            if (name.contains(filter, Qt::CaseInsensitive)) {
+                matches << name;
+            }
+        }
+        return matches;
+    }
+}  // namespace
+
+RefTreeModel::RefTreeModel(QObject *parent) : QAbstractItemModel(parent)
 {
-    auto branchesItem = m_rootItem->childrens.emplaceBack(new RefTreeItem(m_rootItem));
-    auto remotesItem = m_rootItem->childrens.emplaceBack(new RefTreeItem(m_rootItem));
-    auto tagsItem = m_rootItem->childrens.emplaceBack(new RefTreeItem(m_rootItem));
-    branchesItem->displayName = "Branches";
-    branchesItem->row = RefTreeItem::Branch;
-    remotesItem->displayName = "Remotes";
-    remotesItem->row = RefTreeItem::Remote;
-    tagsItem->displayName = "Tags";
-    tagsItem->row = RefTreeItem::Tag;
-    branchesItem->type = remotesItem->type = tagsItem->type = RefTreeItem::Group;
+    m_rootItem = newItem(nullptr, QString(), RefTreeItem::General);
+    const char *names[GroupCount] = {"Branches", "Remotes", "Tags"};
+    for (int type = RefTreeItem::Branch; type < GroupCount; ++type) {
+        RefTreeItem *item = newItem(m_rootItem, names[type], RefTreeItem::Group);
+        item->row = type;
+        m_rootItem->childrens << item;
+    }
 }
 
 QModelIndex RefTreeModel::index(int row, int column, const QModelIndex &parent) const
@@ -30,11 +69,11 @@ QModelIndex RefTreeModel::index(int row, int column, const QModelIndex &parent)
 
     RefTreeItem *parentItem;
     if (!parent.isValid()) {
-        parentItem = m_rootItem.data();
+        parentItem = m_rootItem;
     } else {
         parentItem = static_cast<RefTreeItem *>(parent.internalPointer());
     }
-    return createIndex(row, column, parentItem->childrens[row].data());
+    return createIndex(row, column, parentItem->childrens[row]);
 }
 
 QModelIndex RefTreeModel::parent(const QModelIndex &index) const
@@ -46,9 +85,8 @@ QModelIndex RefTreeModel::parent(const QModelIndex &index) const
     if (item->type == RefTreeItem::Group) {
         return QModelIndex();
     } else {
-        const QSharedPointer<RefTreeItem> parentItem = item->parent.toStrongRef();
-        Q_ASSERT(parentItem);
-        return createIndex(parentItem->row, 0, parentItem.data());
+        Q_ASSERT(item->parent);
+        return createIndex(item->parent->row, 0, item->parent);
     }
 }
 
@@ -56,7 +94,7 @@ int RefTreeModel::rowCount(const QModelIndex &parent) const
 {
     RefTreeItem *parentItem;
     if (!parent.isValid()) {
-        parentItem = m_rootItem.data();
+        parentItem = m_rootItem;
     } else {
         parentItem = static_cast<RefTreeItem *>(parent.internalPointer());
     }
@@ -93,19 +131,24 @@ QVariant RefTreeModel::data(const QModelIndex &index, int role) const
             break;
         case Qt::SizeHintRole:
             break;
-        case Qt::DecorationRole:
+        case Qt::DecorationRole: {
             using namespace utils;
+            // Kept, so that every row gets the rendered icon without looking it up
+            static const Icon branchIcon({{":/icons/branch.png", Theme::IconsBaseColor}});
+            static const Icon remoteIcon({{":/icons/cloud.png", Theme::IconsBaseColor}});
+            static const Icon tagIcon({{":/icons/tag.png", Theme::IconsBaseColor}});
             switch (item->type) {
                 case RefTreeItem::Branch:
-                    return Icon({{":/icons/branch.png", Theme::IconsBaseColor}}).icon();
+                    return branchIcon.icon();
                 case RefTreeItem::Remote:
-                    return Icon({{":/icons/cloud.png", Theme::IconsBaseColor}}).icon();
+                    return remoteIcon.icon();
                 case RefTreeItem::Tag:
-                    return Icon({{":/icons/tag.png", Theme::IconsBaseColor}}).icon();
+                    return tagIcon.icon();
                 default:
                     break;
             }
             break;
+        }
     }
     return QVariant();
 }
@@ -122,60 +165,207 @@ Qt::ItemFlags RefTreeModel::flags(const QModelIndex &index) const
     return flags;
 }
 
-void RefTreeModel::addRefData(const QStringList &refsData, RefTreeItem::Type type)
-{
-    QSharedPointer<RefTreeItem> rootItem = m_rootItem->childrens[type];
-    QModelIndex rootIndex = createIndex(rootItem->row, 0, rootItem.data());
-
-    for (int i = 0; i < refsData.size(); ++i) {
-        QSharedPointer<RefTreeItem> parent = rootItem;
-        const QStringList &chunks = refsData[i].split("/");
-        for (int j = 0; j < chunks.size(); ++j) {
-            const QString &chunk = chunks[j];
-            if (j == chunks.size() - 1) {
-                // Last chunk
-                auto item = parent->childrens.emplaceBack(new RefTreeItem(parent));
-                item->data = refsData[i];
-                item->displayName = chunk;
-                item->type = type;
-                item->row = parent->childrens.size() - 1;
-                break;
-            }
-            bool parentExists = false;
-            for (auto &child : parent->childrens) {
-                if (child->displayName == chunk) {
-                    parent = child;
-                    parentExists = true;
-                    break;
-                }
-            }
-            if (parentExists) {
-                continue;
-            }
-            auto item = parent->childrens.emplaceBack(new RefTreeItem(parent));
-            item->data = chunk;
-            item->displayName = chunk;
-            item->type = RefTreeItem::General;
-            item->row = parent->childrens.size() - 1;
-            parent = item;
+void RefTreeModel::setRefs(RefTreeItem::Type type, const QStringList &names)
+{
+    m_names[type] = names;
+    m_matches[type] = filterNames(names, m_filter);
+    showRefs(type, m_matches[type]);
+}
+
+void RefTreeModel::setFilter(const QString &text)
+{
+    if (text == m_filter) {
+        return;
+    }
+    // What a longer query matches is among what the shorter one did
+    bool narrow = !m_filter.isEmpty() && text.contains(m_filter, Qt::CaseInsensitive);
+    m_filter = text;
+    for (int type = RefTreeItem::Branch; type < GroupCount; ++type) {
+        m_matches[type] = filterNames(narrow ? m_matches[type] : m_names[type], text);
+        showRefs(RefTreeItem::Type(type), m_matches[type]);
+    }
+}
+
+int RefTreeModel::refCount() const
+{
+    int count = 0;
+    for (const auto &refs : m_refs) {
+        count += refs.size();
+    }
+    return count;
+}
+
+RefTreeItem *RefTreeModel::newItem(RefTreeItem *parent, const QString &name, RefTreeItem::Type type)
+{
+    RefTreeItem *item;
+    if (!m_freeItems.isEmpty()) {
+        item = m_freeItems.takeLast();
+    } else {
+        item = &m_items.emplace_back();
+    }
+    item->data = name;
+    item->displayName = name;
+    item->type = type;
+    item->row = 0;
+    item->parent = parent;
+    return item;
+}
+
+void RefTreeModel::freeItem(RefTreeItem *item)
+{
+    for (RefTreeItem *child : std::as_const(item->childrens)) {
+        freeItem(child);
+    }
+    item->childrens.clear();
+    item->childIndex.clear();
+    item->data.clear();
+    item->displayName.clear();
+    m_freeItems << item;
+}
+
+QModelIndex RefTreeModel::indexOf(RefTreeItem *item) const
+{
+    return item == m_rootItem ? QModelIndex() : createIndex(item->row, 0, item);
+}
+
+void RefTreeModel::showRefs(RefTreeItem::Type type, const QStringList &names)
+{
+    QHash<QString, RefTreeItem *> &refs = m_refs[type];
+    const QSet<QString> nameSet(names.cbegin(), names.cend());
+    QList<RefTreeItem *> removed;
+    QStringList added;
+    for (auto it = refs.cbegin(); it != refs.cend(); ++it) {
+        if (!nameSet.contains(it.key())) {
+            removed << it.value();
+        }
+    }
+    for (const QString &name : names) {
+        if (!refs.contains(name)) {
+            added << name;
         }
     }
+    if (removed.isEmpty() && added.isEmpty()) {
+        return;
+    }
 
-    beginInsertRows(rootIndex, 0, rootItem->childrens.size() - 1);
-    endInsertRows();
+    // Each row change renumbers the siblings after it, many changes are cheaper as one
+    if (removed.size() + added.size() > qMax(64, int(refs.size() / 8))) {
+        rebuildGroup(type, names);
+        return;
+    }
+    for (RefTreeItem *item : std::as_const(removed)) {
+        refs.remove(item->data);
+        removeRef(item);
+    }
+    for (const QString &name : std::as_const(added)) {
+        refs.insert(name, insertRef(type, name));
+    }
 }
 
-void RefTreeModel::reset()
+void RefTreeModel::rebuildGroup(RefTreeItem::Type type, const QStringList &names)
 {
-    for (auto &groupItem : m_rootItem->childrens) {
-        QModelIndex groupIndex = createIndex(groupItem->row, 0, groupItem.data());
-        if (groupItem->childrens.isEmpty()) continue;
+    RefTreeItem *groupItem = m_rootItem->childrens[type];
+    QModelIndex groupIndex = indexOf(groupItem);
+    QHash<QString, RefTreeItem *> &refs = m_refs[type];
+    if (!groupItem->childrens.isEmpty()) {
         beginRemoveRows(groupIndex, 0, groupItem->childrens.size() - 1);
+        for (RefTreeItem *child : std::as_const(groupItem->childrens)) {
+            freeItem(child);
+        }
         groupItem->childrens.clear();
+        groupItem->childIndex.clear();
+        refs.clear();
         endRemoveRows();
     }
+    if (names.isEmpty()) {
+        return;
+    }
+
+    // Built aside and sorted once, then inserted with a single signal
+    RefTreeItem *staging = newItem(nullptr, QString(), RefTreeItem::General);
+    refs.reserve(names.size());
+    for (const QString &name : names) {
+        RefTreeItem *parent = staging;
+        const QStringList chunks = name.split('/');
+        for (int i = 0; i < chunks.size() - 1; ++i) {
+            RefTreeItem *&child = parent->childIndex[chunks[i]];
+            if (!child) {
+                child = newItem(parent, chunks[i], RefTreeItem::General);
+                parent->childrens << child;
+            }
+            parent = child;
+        }
+        RefTreeItem *item = newItem(parent, chunks.last(), type);
+        item->data = name;
+        parent->childrens << item;
+        parent->childIndex.insert(item->displayName, item);
+        refs.insert(name, item);
+    }
+    sortChildren(staging);
+
+    beginInsertRows(groupIndex, 0, staging->childrens.size() - 1);
+    groupItem->childrens.swap(staging->childrens);
+    groupItem->childIndex.swap(staging->childIndex);
+    for (RefTreeItem *child : std::as_const(groupItem->childrens)) {
+        child->parent = groupItem;
+    }
+    endInsertRows();
+    freeItem(staging);
+}
+
+RefTreeItem *RefTreeModel::insertRef(RefTreeItem::Type type, const QString &name)
+{
+    const QStringList chunks = name.split('/');
+    RefTreeItem *parent = m_rootItem->childrens[type];
+    int depth = 0;
+    for (; depth < chunks.size() - 1; ++depth) {
+        RefTreeItem *child = parent->childIndex.value(chunks[depth]);
+        if (!child) {
+            break;
+        }
+        parent = child;
+    }
+
+    // The missing part of the path, inserted as one row
+    RefTreeItem *top = nullptr;
+    RefTreeItem *item = nullptr;
+    for (int i = depth; i < chunks.size(); ++i) {
+        bool last = i == chunks.size() - 1;
+        RefTreeItem *child = newItem(item, chunks[i], last ? type : RefTreeItem::General);
+        if (item) {
+            item->childrens << child;
+            item->childIndex.insert(child->displayName, child);
+        } else {
+            top = child;
+        }
+        item = child;
+    }
+    item->data = name;
+
+    int row = std::lower_bound(parent->childrens.cbegin(), parent->childrens.cend(),
+                  top->displayName, lessByName) -
+              parent->childrens.cbegin();
+    beginInsertRows(indexOf(parent), row, row);
+    top->parent = parent;
+    parent->childrens.insert(row, top);
+    parent->childIndex.insert(top->displayName, top);
+    renumber(parent, row);
+    endInsertRows();
+    return item;
 }
 
-RefTreeItem::RefTreeItem(QSharedPointer<RefTreeItem> parent) : parent(parent)
+void RefTreeModel::removeRef(RefTreeItem *item)
 {
+    // Along with the directories only it was in
+    while (item->parent->type == RefTreeItem::General && item->parent->childrens.size() == 1) {
+        item = item->parent;
+    }
+    RefTreeItem *parent = item->parent;
+    int row = item->row;
+    beginRemoveRows(indexOf(parent), row, row);
+    parent->childrens.removeAt(row);
+    parent->childIndex.remove(item->displayName);
+    renumber(parent, row);
+    endRemoveRows();
+    freeItem(item);
 }
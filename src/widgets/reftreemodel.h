@@ -2,7 +2,8 @@
 #define REVSTREEMODEL_H
 
 #include <QAbstractItemModel>
-#include <QSharedPointer>
+#include <QHash>
+#include <deque>
 
 class RefTreeItem
 {
@@ -16,15 +17,17 @@ public:
         Remote,
         Tag,
     };
-    explicit RefTreeItem(QSharedPointer<RefTreeItem> parent = nullptr);
     QString data;
     QString displayName;
-    Type type;
-    int row;
-    QWeakPointer<RefTreeItem> parent;
-    QList<QSharedPointer<RefTreeItem>> childrens;
+    Type type = General;
+    int row = 0;
+    RefTreeItem *parent = nullptr;
+    QList<RefTreeItem *> childrens;            // Sorted by displayName
+    QHash<QString, RefTreeItem *> childIndex;  // key:displayName
 };
 
+// The refs of each group as a tree of their path components. Updates only insert and remove the
+// rows of the refs that changed, so what is expanded and the scroll position are kept.
 class RefTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -44,11 +47,36 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
-    void addRefData(const QStringList &refsData, RefTreeItem::Type type);
-    void reset();
+    // names are the full ref names of the group, e.g. origin/main
+    void setRefs(RefTreeItem::Type type, const QStringList &names);
+    // Shows only the refs containing text, ignoring case
+    void setFilter(const QString &text);
+    const QString &filter() const
+    {
+        return m_filter;
+    }
+    // Refs shown in all groups
+    int refCount() const;
 
 private:
-    QSharedPointer<RefTreeItem> m_rootItem;
+    static constexpr int GroupCount = RefTreeItem::Tag + 1;
+
+    std::deque<RefTreeItem> m_items;  // Every item, the removed ones are reused
+    QList<RefTreeItem *> m_freeItems;
+    RefTreeItem *m_rootItem;
+    QStringList m_names[GroupCount];
+    QStringList m_matches[GroupCount];               // Of m_names, by the filter
+    QHash<QString, RefTreeItem *> m_refs[GroupCount];  // key:name, shown ones
+    QString m_filter;
+
+    RefTreeItem *newItem(RefTreeItem *parent, const QString &name, RefTreeItem::Type type);
+    void freeItem(RefTreeItem *item);
+    QModelIndex indexOf(RefTreeItem *item) const;
+
+    void showRefs(RefTreeItem::Type type, const QStringList &names);
+    void rebuildGroup(RefTreeItem::Type type, const QStringList &names);
+    RefTreeItem *insertRef(RefTreeItem::Type type, const QString &name);
+    void removeRef(RefTreeItem *item);
 };
 
 #endif  // REVSTREEMODEL_H
@@ -3,7 +3,6 @@
 #include <QClipboard>
 #include <QGuiApplication>
 #include <QMenu>
-#include <QtConcurrent>
 
 #include "dialogs/branchdialog.h"
 #include "dialogs/cmddialog.h"
@@ -11,8 +10,7 @@
 #include "global.h"
 #include "themes/theme.h"
 
-RefTreeView::RefTreeView(QWidget *parent)
-    : QTreeView(parent), m_remotesLoaded(false), m_tagsLoaded(false)
+RefTreeView::RefTreeView(QWidget *parent) : QTreeView(parent)
 {
     setStyleSheet(QString("QTreeView {background-color: transparent;}"
                           "QTreeView::item {height: 28px;}"
@@ -27,7 +25,6 @@ RefTreeView::RefTreeView(QWidget *parent)
     setItemDelegate(m_delegate);
     setIconSize(QSize(22, 22));
 
-    connect(this, &QTreeView::expanded, this, &RefTreeView::onExpanded);
     connect(this, &QTreeView::doubleClicked, this, &RefTreeView::onDoubleClicked);
     connect(this, &QTreeView::customContextMenuRequested, this, &RefTreeView::onMenuRequested);
 
@@ -36,56 +33,58 @@ RefTreeView::RefTreeView(QWidget *parent)
 
 RefTreeView::~RefTreeView()
 {
-    m_branchesFetcher.cancel();
-    m_remotesFetcher.cancel();
-    m_tagsFetcher.cancel();
 }
 
-void RefTreeView::setProjectPath(const QString &path)
+void RefTreeView::setProjectData(const QSharedPointer<ProjectData> &data, const QString &revision)
 {
-    m_projectPath = path;
-    m_remotesLoaded = false;
-    m_tagsLoaded = false;
+    if (m_data) {
+        disconnect(m_data.get(), nullptr, this, nullptr);
+    }
+    m_data = data;
+    m_projectPath = data->projectPath();
 
     collapse(m_model->index(RefTreeItem::Remote, 0));
     collapse(m_model->index(RefTreeItem::Tag, 0));
-    m_model->reset();
-
-    m_branchesFetcher.cancel();
-    m_remotesFetcher.cancel();
-    m_tagsFetcher.cancel();
-
-    getBranchesAsync(m_projectPath);
+    connect(data.get(), &ProjectData::refsLoading, this, &RefTreeView::setLoading);
+    connect(data.get(), &ProjectData::refsChanged, this, &RefTreeView::onRefsChanged);
+    connect(data.get(), &ProjectData::divergencesChanged, this, [this]() {
+        m_delegate->setDivergences(m_data->divergences());
+    });
+    setLoading(data->isRefsLoading());
+    onRefsChanged();
+    m_delegate->setRevision(revision);
+    m_delegate->setDivergences(data->divergences());
+    data->ensureRefs();
+    data->ensureDivergences(revision);
 }
 
-void RefTreeView::refresh()
+void RefTreeView::setLoading(bool loading)
 {
-    m_model->reset();
-    m_branchesFetcher.cancel();
-    m_remotesFetcher.cancel();
-    m_tagsFetcher.cancel();
-
-    m_remotesLoaded = false;
-    m_tagsLoaded = false;
-
-    getBranchesAsync(m_projectPath);
-    if (isExpanded(m_model->index(RefTreeItem::Remote, 0))) {
-        getRemotesAsync(m_projectPath);
-    }
-    if (isExpanded(m_model->index(RefTreeItem::Tag, 0))) {
-        getTagsAsync(m_projectPath);
+    // The delegate counts, all groups come from one load
+    if (m_loading == loading) {
+        return;
     }
+    m_loading = loading;
+    m_delegate->setBranchesLoading(loading);
+    m_delegate->setRemotesLoading(loading);
+    m_delegate->setTagsLoading(loading);
 }
 
-void RefTreeView::onExpanded(const QModelIndex &index)
+void RefTreeView::onRefsChanged()
 {
-    RefTreeItem *item = static_cast<RefTreeItem *>(index.internalPointer());
-    if (item->type == RefTreeItem::Group) {
-        if (item->row == RefTreeItem::Remote && !m_remotesLoaded) {
-            getRemotesAsync(m_projectPath);
-        } else if (item->row == RefTreeItem::Tag && !m_tagsLoaded) {
-            getTagsAsync(m_projectPath);
-        }
+    const RefSnapshot &refs = m_data->refs();
+    m_delegate->setCurrentBranch(refs.head);
+    m_model->setRefs(RefTreeItem::Branch, refs.names(RefSnapshot::Branch));
+    m_model->setRefs(RefTreeItem::Remote, refs.names(RefSnapshot::Remote));
+    m_model->setRefs(RefTreeItem::Tag, refs.names(RefSnapshot::Tag));
+}
+
+void RefTreeView::setFilter(const QString &text)
+{
+    m_model->setFilter(text.trimmed());
+    // Few enough matches to show them all
+    if (!m_model->filter().isEmpty() && m_model->refCount() <= 500) {
+        expandAll();
     }
 }
 
@@ -134,122 +133,25 @@ void RefTreeView::onMenuRequested(const QPoint &pos)
     menu.exec(mapToGlobal(pos));
 }
 
-void RefTreeView::getBranchesAsync(const QString &projectPath)
-{
-    m_delegate->setBranchesLoading(true);
-    m_branchesFetcher = QtConcurrent::run([projectPath](QPromise<QStringList> &promise) {
-        QStringList result;
-        QString currentBranch;
-        QStringList lines = global::getCmdResult("git branch", projectPath).split('\n');
-        if (promise.isCanceled()) {
-            return;
-        }
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.size() > 0 && !trLine.startsWith("* (HEAD detached")) {
-                if (trLine.startsWith("*")) {
-                    trLine = trLine.mid(2);
-                    currentBranch = trLine;
-                }
-                result << trLine;
-            }
-        }
-        result << currentBranch;
-        promise.addResult(result);
-    });
-    QPointer thisPtr(this);
-    m_branchesFetcher
-        .then(qApp,
-            [this](const QStringList &result) {
-                m_delegate->setBranchesLoading(false);
-                m_delegate->setCurrentBranch(result.last());
-                m_model->addRefData(result.mid(0, result.size() - 1), RefTreeItem::Branch);
-            })
-        .onCanceled(qApp, [thisPtr] {
-            if (thisPtr.isNull()) return;
-            thisPtr->m_delegate->setBranchesLoading(false);
-        });
-}
-
-void RefTreeView::getRemotesAsync(const QString &projectPath)
-{
-    m_delegate->setRemotesLoading(true);
-    m_remotesFetcher = QtConcurrent::run([projectPath](QPromise<QStringList> &promise) {
-        QStringList result;
-        QStringList lines = global::getCmdResult("git branch -r", projectPath).split('\n');
-        if (promise.isCanceled()) {
-            return;
-        }
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.contains(" -> ")) {
-                trLine = trLine.split(" -> ").last();
-            }
-            if (trLine.size() > 0) {
-                result << trLine;
-            }
-        }
-        promise.addResult(result);
-    });
-    QPointer thisPtr(this);
-    m_remotesFetcher
-        .then(qApp,
-            [this](const QStringList &result) {
-                m_remotesLoaded = true;
-                m_delegate->setRemotesLoading(false);
-                m_model->addRefData(result, RefTreeItem::Remote);
-            })
-        .onCanceled(qApp, [thisPtr] {
-            if (thisPtr.isNull()) return;
-            thisPtr->m_delegate->setBranchesLoading(false);
-        });
-}
-
-void RefTreeView::getTagsAsync(const QString &projectPath)
-{
-    m_delegate->setTagsLoading(true);
-    m_tagsFetcher = QtConcurrent::run([projectPath](QPromise<QStringList> &promise) {
-        QStringList result;
-        QStringList lines = global::getCmdResult("git tag", projectPath).split('\n');
-        if (promise.isCanceled()) {
-            return;
-        }
-        for (const QString &line : lines) {
-            QString trLine = line.trimmed();
-            if (trLine.size() > 0) {
-                result << trLine;
-            }
-        }
-        promise.addResult(result);
-    });
-    QPointer thisPtr(this);
-    m_tagsFetcher
-        .then(qApp,
-            [this](const QStringList &result) {
-                m_tagsLoaded = true;
-                m_delegate->setTagsLoading(false);
-                m_model->addRefData(result, RefTreeItem::Tag);
-            })
-        .onCanceled(qApp, [thisPtr] {
-            if (thisPtr.isNull()) return;
-            thisPtr->m_delegate->setBranchesLoading(false);
-        });
-}
-
 void RefTreeView::deleteRef(RefTreeItem *item)
 {
+    const RefSnapshot &refs = m_data->refs();
+    const RefSnapshot::Ref *ref = refs.find(RefSnapshot::Kind(item->type), item->data);
+    if (!ref) {
+        return;
+    }
     if (item->type == RefTreeItem::Branch) {
-        DeleteLocalBranchDialog dialog(this, m_projectPath, item->data);
+        DeleteLocalBranchDialog dialog(this, m_projectPath, *ref, ref->name == refs.head);
         if (dialog.exec()) {
             emit requestRefreshEvent();
         }
     } else if (item->type == RefTreeItem::Remote) {
-        DeleteRemoteBranchDialog dialog(this, m_projectPath, item->data);
+        DeleteRemoteBranchDialog dialog(this, m_projectPath, *ref);
         if (dialog.exec()) {
             emit requestRefreshEvent();
         }
     } else if (item->type == RefTreeItem::Tag) {
-        DeleteTagDialog dialog(this, m_projectPath, item->data);
+        DeleteTagDialog dialog(this, m_projectPath, *ref);
         if (dialog.exec()) {
             emit requestRefreshEvent();
         }
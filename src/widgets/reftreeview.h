@@ -4,6 +4,7 @@
 #include <QFuture>
 #include <QTreeView>
 
+#include "git/projectdata.h"
 #include "pages/historytablemodel.h"
 #include "reftreedelegate.h"
 #include "reftreemodel.h"
@@ -14,11 +15,13 @@ class RefTreeView : public QTreeView
 public:
     RefTreeView(QWidget *parent);
     ~RefTreeView();
-    void setProjectPath(const QString &path);
-    void refresh();
+    // Shows the refs of the project data, kept up to date by it. The local branches show how far
+    // they are from their upstream and from revision, e.g. origin/main.
+    void setProjectData(const QSharedPointer<ProjectData> &data, const QString &revision);
+    // Shows only the refs containing text
+    void setFilter(const QString &text);
 
 private slots:
-    void onExpanded(const QModelIndex &index);
     void onDoubleClicked(const QModelIndex &index);
     void onMenuRequested(const QPoint &pos);
 
@@ -30,16 +33,11 @@ private:
     RefTreeDelegate *m_delegate;
 
     QString m_projectPath;
+    QSharedPointer<ProjectData> m_data;
+    bool m_loading = false;
 
-    QFuture<QStringList> m_branchesFetcher;
-    QFuture<QStringList> m_remotesFetcher;
-    QFuture<QStringList> m_tagsFetcher;
-    bool m_remotesLoaded;
-    bool m_tagsLoaded;
-
-    void getBranchesAsync(const QString &projectPath);
-    void getRemotesAsync(const QString &projectPath);
-    void getTagsAsync(const QString &projectPath);
+    void setLoading(bool loading);
+    void onRefsChanged();
     void deleteRef(RefTreeItem *item);
 };
 